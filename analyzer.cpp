@@ -0,0 +1,193 @@
+/*!
+  * @file analyzer.cpp
+  * This file contains the definition of the class Analyzer.
+  */
+
+#include <algorithm>
+#include "analyzer.hpp"
+
+//!
+Analyzer::Analyzer()
+    : m_moves(Board::MaxMoves),
+    m_moveCount(0),
+    m_parents(size_t(Board::MaxCells) * Board::MaxCells, (unsigned short)NoParent),
+    m_hasPaths(Board::MaxCells, false),
+    m_stop(false),
+    m_stage(None)
+{
+    // the analysis runs while the player thinks: the search may take longer than the hint advisor
+    m_search.setTimeBudget(3000);
+    m_search.setStopFlag(&m_stop);
+}
+
+//!
+Analyzer::~Analyzer()
+{
+    cancel();
+}
+
+//!
+void Analyzer::start(const Board &board)
+{
+    clear();
+
+    m_board = board;
+    m_stop = false;
+    m_worker = std::thread(&Analyzer::run, this);
+}
+
+//!
+void Analyzer::cancel()
+{
+    m_stop = true;
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+//!
+void Analyzer::clear()
+{
+    cancel();
+    publish(None);
+}
+
+//!
+const std::vector<Board::Move> &Analyzer::rankedMoves() const
+{
+    static const std::vector<Board::Move> empty;
+    return (stage() >= Ranked) ? m_ranked : empty;
+}
+
+//!
+bool Analyzer::suggestedMove(Board::Move &move) const
+{
+    switch (stage()) {
+    case Searched:
+        move = m_searched;
+        return true;
+    case Greedy:
+        move = m_greedy;
+        return true;
+    case Ranked:
+        if (m_ranked.empty()) {
+            return false;
+        }
+        move = m_ranked.front();
+        return true;
+    default:
+        return false;
+    }
+}
+
+//!
+bool Analyzer::path(int from, int to, std::vector<int> &cells) const
+{
+    cells.clear();
+
+    if ((stage() < Paths) || !m_hasPaths[from] || (from == to)) {
+        return false;
+    }
+
+    const unsigned short *parents = &m_parents[size_t(from) * Board::MaxCells];
+    if (parents[to] == NoParent) {
+        return false;
+    }
+
+    for (int p = to; p != from; p = parents[p]) {
+        cells.push_back(p);
+    }
+    cells.push_back(from);
+
+    std::reverse(cells.begin(), cells.end());
+
+    return true;
+}
+
+/*!
+  * The stop flag is checked between the stages and inside the long ones (the search checks
+  * it every few hundred positions).
+  */
+void Analyzer::run()
+{
+    m_moveCount = m_board.isGameOver() ? 0 : m_board.legalMoves(&m_moves[0]);
+
+    std::fill(m_hasPaths.begin(), m_hasPaths.end(), false);
+    for (int i = 0; i < m_moveCount; ++i) {
+        int from = m_moves[i].m_from;
+        if (!m_hasPaths[from]) {
+            if (stopped()) {
+                return;
+            }
+
+            buildPaths(from);
+            m_hasPaths[from] = true;
+        }
+    }
+
+    publish(Paths);
+
+    // the moves forming the longest lines first
+    m_ranked.assign(m_moves.begin(), m_moves.begin() + m_moveCount);
+    std::stable_sort(m_ranked.begin(), m_ranked.end(), [this](const Board::Move &a, const Board::Move &b) {
+        return m_board.moveRank(a) > m_board.moveRank(b);
+    });
+
+    if (stopped()) {
+        return;
+    }
+
+    publish(Ranked);
+
+    if ((0 == m_moveCount) || !m_evaluator.suggestMove(m_board, m_greedy) || stopped()) {
+        return;
+    }
+
+    publish(Greedy);
+
+    if (m_search.bestMove(m_board, m_searched) && !stopped()) {
+        publish(Searched);
+    }
+}
+
+/*!
+  * A breadth-first search over the empty cells (the 'hint' balls do not block the paths); the
+  * neighbours are visited in the order of PathFinder (left, up, right, down).
+  */
+void Analyzer::buildPaths(int from)
+{
+    static const int s_steps[4][2] = { { 0, -1 }, { -1, 0 }, { 0, 1 }, { 1, 0 } };
+
+    unsigned short *parents = &m_parents[size_t(from) * Board::MaxCells];
+    std::fill(parents, parents + Board::MaxCells, (unsigned short)NoParent);
+
+    int queue[Board::MaxCells];
+    int head = 0;
+    int tail = 0;
+
+    parents[from] = (unsigned short)from;
+    queue[tail++] = from;
+
+    while (head < tail) {
+        int p = queue[head++];
+        int r = Board::row(p);
+        int c = Board::column(p);
+
+        for (int d = 0; d < 4; ++d) {
+            int rr = r + s_steps[d][0];
+            int cc = c + s_steps[d][1];
+            if (!m_board.isValidPosition(rr, cc)) {
+                continue;
+            }
+
+            int q = Board::index(rr, cc);
+            if ((parents[q] != NoParent) || (m_board.cell(q) != Board::Empty)) {
+                continue;
+            }
+
+            parents[q] = (unsigned short)p;
+            queue[tail++] = q;
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*!
+  * @file analyzer.hpp
+  * This file contains the declaration of the class Analyzer.
+  */
+#ifndef ANALYZER_HPP
+#define ANALYZER_HPP
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "board.hpp"
+#include "evaluator.hpp"
+#include "expectimax.hpp"
+
+/*! This class analyses a position in the background while the player thinks.
+  *
+  * The analysis starts as soon as the position is fixed (the spawned balls are placed and their
+  * lines removed) and runs on a worker thread in stages of growing cost; every stage publishes its
+  * results when it completes:
+  * - Paths: the legal moves and, for every ball that can move, the shortest paths to all the cells
+  *   it can reach (a breadth-first search tree),
+  * - Ranked: the legal moves ranked by Board::moveRank(),
+  * - Greedy: the move of Evaluator::suggestMove(),
+  * - Searched: the move of an Expectimax search.
+  *
+  * The results of the completed stages are read without waiting: they are never written again until
+  * the next start(). The analysis is stopped at once by cancel() (the completed stages are kept) or
+  * by clear() (the results are dropped, e.g. when the position changes).
+  */
+class Analyzer
+{
+public:
+    /*! \brief The stages of the analysis.
+      */
+    enum Stage
+    {
+        None = 0,  // no result
+        Paths,     // the legal moves and the paths are known
+        Ranked,    // the moves are ranked
+        Greedy,    // the greedy move is known
+        Searched   // the searched move is known
+    };
+
+    /*! The constructor.
+      */
+    Analyzer();
+
+    /*! The destructor; stops the analysis.
+      */
+    ~Analyzer();
+
+    /*!
+      * @return the search of the last stage (its settings may be changed while no analysis runs)
+      */
+    inline Expectimax &search()
+    {
+        return m_search;
+    }
+
+    /*! Stops the running analysis and starts the analysis of a new position.
+      * @param[in] board the position
+      */
+    void start(const Board &board);
+
+    /*! Stops the analysis; the results of the completed stages are kept.
+      */
+    void cancel();
+
+    /*! Stops the analysis and drops its results.
+      */
+    void clear();
+
+    /*!
+      * @return true if an analysis was started and neither cancelled nor cleared since (it may be over)
+      */
+    inline bool isRunning() const
+    {
+        return m_worker.joinable() && !stopped();
+    }
+
+    /*!
+      * @return the last completed stage
+      */
+    inline Stage stage() const
+    {
+        return Stage(m_stage.load(std::memory_order_acquire));
+    }
+
+    /*!
+      * @return the ranked legal moves (empty before the stage Ranked)
+      */
+    const std::vector<Board::Move> &rankedMoves() const;
+
+    /*! Gets the best move known so far: the searched move, else the greedy move, else the
+      * first ranked move.
+      *
+      * @param[out] move receives the move
+      * @return false if no such stage is completed or if there is no legal move
+      */
+    bool suggestedMove(Board::Move &move) const;
+
+    /*! Gets the shortest path of a ball.
+      *
+      * @param[in] from the cell of the ball
+      * @param[in] to the target cell
+      * @param[out] cells receives the cells of the path, from the ball to the target
+      * @return false if the target cannot be reached or if the stage Paths is not completed
+      */
+    bool path(int from, int to, std::vector<int> &cells) const;
+
+private:
+    enum
+    {
+        NoParent = 0xFFFF // the parent of a cell that is not reached
+    };
+
+    /*! The loop of the worker thread.
+      */
+    void run();
+
+    /*! Builds the search tree of the paths of the ball at the given cell.
+      */
+    void buildPaths(int from);
+
+    inline bool stopped() const
+    {
+        return m_stop.load(std::memory_order_relaxed);
+    }
+
+    inline void publish(Stage stage)
+    {
+        m_stage.store(stage, std::memory_order_release);
+    }
+
+private:
+    Board m_board; /*!< the analysed position */
+
+    std::vector<Board::Move> m_moves; /*!< the legal moves */
+    int m_moveCount; /*!< the number of the legal moves */
+    std::vector<Board::Move> m_ranked; /*!< the ranked legal moves */
+
+    /*! the path trees: m_parents[from * MaxCells + cell] is the previous cell of the path
+      * from the ball at 'from' to 'cell' (or NoParent) */
+    std::vector<unsigned short> m_parents;
+    std::vector<bool> m_hasPaths; /*!< does the cell hold a ball that can move ? */
+
+    Board::Move m_greedy; /*!< the greedy move */
+    Board::Move m_searched; /*!< the searched move */
+
+    Evaluator m_evaluator; /*!< the evaluator of the greedy stage */
+    Expectimax m_search; /*!< the search of the last stage */
+
+    std::thread m_worker; /*!< the worker thread */
+    std::atomic<bool> m_stop; /*!< is the analysis stopped ? */
+    std::atomic<int> m_stage; /*!< the last completed stage */
+};
+
+#endif // ANALYZER_HPP
@@ -0,0 +1,182 @@
+/*!
+  * @file animationscheduler.cpp
+  * This file contains the definition of the class AnimationScheduler.
+  */
+
+#include <cstddef>
+#include "animationscheduler.hpp"
+
+//!
+AnimationScheduler::AnimationScheduler()
+    : m_startedAt(0),
+    m_resumeAt(0),
+    m_waiting(false),
+    m_turbo(false)
+{
+    m_current.m_delay = 0;
+}
+
+//!
+void AnimationScheduler::append(const Step &step, int delay)
+{
+    Entry entry;
+    entry.m_step = step;
+    entry.m_delay = delay;
+
+    m_steps.push_back(entry);
+}
+
+//!
+void AnimationScheduler::appendTween(const Tween &tween, int duration)
+{
+    Entry entry;
+    entry.m_tween = tween;
+    entry.m_delay = duration;
+
+    m_steps.push_back(entry);
+}
+
+//!
+void AnimationScheduler::play(const Tween &tween, int duration)
+{
+    if (m_turbo) {
+        tween(1.0);
+        return;
+    }
+
+    Playing playing;
+    playing.m_tween = tween;
+    playing.m_duration = duration;
+    playing.m_startedAt = -1;
+
+    m_playing.push_back(playing);
+}
+
+//!
+void AnimationScheduler::clear()
+{
+    m_steps.clear();
+    m_current.m_tween = Tween();
+    m_waiting = false;
+    m_playing.clear();
+}
+
+/*!
+  * The tweens played out of the sequence are finished first: a step of the sequence may remove the
+  * ball one of them animates.
+  */
+void AnimationScheduler::finish()
+{
+    while (!m_playing.empty() || m_waiting || !m_steps.empty()) {
+        std::vector<Playing> playing;
+        playing.swap(m_playing);
+        for (size_t i = 0; i < playing.size(); ++i) {
+            playing[i].m_tween(1.0);
+        }
+
+        if (m_waiting) {
+            m_waiting = false;
+
+            Tween tween = m_current.m_tween;
+            m_current.m_tween = Tween();
+            if (tween) {
+                tween(1.0);
+            }
+        }
+
+        while (!m_steps.empty()) {
+            Entry entry = m_steps.front();
+            m_steps.pop_front();
+
+            if (entry.m_tween) {
+                entry.m_tween(1.0);
+            } else {
+                entry.m_step();
+            }
+        }
+    }
+}
+
+/*!
+  * An entry is removed from the sequence before it is run, so it may clear the sequence itself.
+  * The delays are counted from the time the step is run: a late frame delays the rest of the
+  * sequence. A tween is called with the progress 0 at the frame it starts and with the progress 1
+  * once its duration has elapsed; the next entry runs at the same frame.
+  */
+bool AnimationScheduler::advance(long long now)
+{
+    if (m_turbo) {
+        finish();
+        return false;
+    }
+
+    size_t i = 0;
+    while (i < m_playing.size()) {
+        if (m_playing[i].m_startedAt < 0) {
+            m_playing[i].m_startedAt = now;
+        }
+
+        double p = progress(m_playing[i].m_startedAt, m_playing[i].m_duration, now);
+        if (p < 1.0) {
+            m_playing[i].m_tween(p);
+            ++i;
+        } else {
+            Tween tween = m_playing[i].m_tween;
+            m_playing.erase(m_playing.begin() + i);
+            tween(1.0);
+        }
+    }
+
+    if (m_waiting) {
+        if (m_current.m_tween) {
+            double p = progress(m_startedAt, m_current.m_delay, now);
+            if (p < 1.0) {
+                m_current.m_tween(p);
+                return true;
+            }
+
+            Tween tween = m_current.m_tween;
+            m_current.m_tween = Tween();
+            m_waiting = false;
+            tween(1.0);
+        } else {
+            if (now < m_resumeAt) {
+                return true;
+            }
+            m_waiting = false;
+        }
+    }
+
+    while (!m_steps.empty()) {
+        Entry entry = m_steps.front();
+        m_steps.pop_front();
+
+        if (entry.m_tween) {
+            m_current = entry;
+            m_startedAt = now;
+            m_waiting = true;
+            m_current.m_tween(0.0);
+            return true;
+        }
+
+        entry.m_step();
+
+        if (entry.m_delay > 0) {
+            m_resumeAt = now + entry.m_delay;
+            m_waiting = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//!
+double AnimationScheduler::progress(long long startedAt, int duration, long long now)
+{
+    if ((duration <= 0) || (now - startedAt >= duration)) {
+        return 1.0;
+    }
+
+    return (now > startedAt) ? double(now - startedAt) / duration : 0.0;
+}
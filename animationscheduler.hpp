@@ -0,0 +1,133 @@
+/*!
+  * @file animationscheduler.hpp
+  * This file contains the declaration of the class AnimationScheduler.
+  */
+#ifndef ANIMATIONSCHEDULER_HPP
+#define ANIMATIONSCHEDULER_HPP
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+/*! This class is the clock of the animations of the grid; it is advanced by the frame timer.
+  *
+  * It plays a sequence of steps and tweens in order: a step is a function that changes the scene
+  * (toggles the selection of the blinking balls, removes them, ...) followed by a delay, a tween is
+  * a function called at every frame with the progress of an animation of a given duration (a ball
+  * that walks along a path). It also plays tweens out of the sequence, side by side (the pop-in of
+  * the new balls).
+  *
+  * advance() is called once per frame from the main loop: the progress of every tween is computed
+  * from the time elapsed since it started, so a late frame skips ahead instead of slowing the
+  * animation down. Nothing spins and nothing reenters the event loop while an animation is played.
+  * finish() (and the turbo mode, which finishes everything at every call of advance()) plays every
+  * pending animation to its end at once.
+  */
+class AnimationScheduler
+{
+public:
+    typedef std::function<void()> Step;
+    typedef std::function<void(double)> Tween;
+
+    /*! The constructor.
+      */
+    AnimationScheduler();
+
+    /*! Appends a step to the sequence.
+      * @param[in] step the function to be run
+      * @param[in] delay the time to wait after the step before the next one is run (ms)
+      */
+    void append(const Step &step, int delay = 0);
+
+    /*! Appends a tween to the sequence; the next entry runs once it is called with the progress 1.
+      * @param[in] tween the function to be called with the progress of the animation (from 0 to 1)
+      * @param[in] duration the duration of the animation (ms)
+      */
+    void appendTween(const Tween &tween, int duration);
+
+    /*! Plays a tween out of the sequence; it starts at the next call of advance().
+      * @param[in] tween the function to be called with the progress of the animation (from 0 to 1)
+      * @param[in] duration the duration of the animation (ms)
+      */
+    void play(const Tween &tween, int duration);
+
+    /*! Drops the pending steps and tweens and the current delay.
+      */
+    void clear();
+
+    /*! Plays every pending animation to its end at once: the tweens are called with the progress 1
+      * and the steps are run without their delays.
+      */
+    void finish();
+
+    /*! Runs the steps that are due and updates the tweens.
+      * @param[in] now the current time (ms)
+      * @return true if the sequence is not finished (a delay or a tween runs or entries are pending)
+      */
+    bool advance(long long now);
+
+    /*!
+      * @return true if the sequence or a tween played out of it is not finished as of the last call
+      * of advance()
+      */
+    inline bool isBusy() const
+    {
+        return m_waiting || !m_steps.empty() || !m_playing.empty();
+    }
+
+    /*! In turbo mode the animations are finished as soon as they are scheduled.
+      * @param[in] flag the turbo flag
+      * \sa isTurbo()
+      */
+    inline void setTurbo(bool flag)
+    {
+        m_turbo = flag;
+    }
+
+    /*!
+      * @return true in turbo mode
+      * \sa setTurbo()
+      */
+    inline bool isTurbo() const
+    {
+        return m_turbo;
+    }
+
+private:
+    AnimationScheduler(const AnimationScheduler &);
+    AnimationScheduler &operator =(const AnimationScheduler &);
+
+    /*! \brief An entry of the sequence: a step and the delay that follows it, or a tween and its duration.
+      */
+    struct Entry
+    {
+        Step m_step;
+        Tween m_tween;
+        int m_delay;
+    };
+
+    /*! \brief A tween played out of the sequence.
+      */
+    struct Playing
+    {
+        Tween m_tween;
+        int m_duration;
+        long long m_startedAt; /*!< -1 until the first call of advance() */
+    };
+
+    /*!
+      * @return the progress (from 0 to 1) of an animation at a given time
+      */
+    static double progress(long long startedAt, int duration, long long now);
+
+private:
+    std::deque<Entry> m_steps; /*!< the pending entries of the sequence */
+    Entry m_current; /*!< the entry of the sequence that is played (its tween, if any) */
+    long long m_startedAt; /*!< the time the current tween started at */
+    long long m_resumeAt; /*!< the time the next entry is due at */
+    bool m_waiting; /*!< does a delay or a tween of the sequence run ? */
+    std::vector<Playing> m_playing; /*!< the tweens played out of the sequence */
+    bool m_turbo; /*!< are the animations finished as soon as they are scheduled ? */
+};
+
+#endif // ANIMATIONSCHEDULER_HPP
@@ -5,42 +5,48 @@
 
 #include <QtGui>
 #include "ballitem.hpp"
-#include "mainwidget.hpp"
-#include "utils.hpp"
+#include "ballitemsprovider.hpp"
+#include "paintprofile.hpp"
 
 //!
 BallItem::BallItem(QGraphicsItem *parent)
-    : QGraphicsEllipseItem(parent),
+    : QGraphicsItem(parent),
+    m_colorIndex(0),
     m_hintFlag(false),
     m_selectedFlag(false)
 {
-    setPen(Qt::NoPen);
-
-    m_radius = isRunningOnDesktop() ? 16.0 : 6.4;
-
-    qreal radius = m_radius * 1.2;
+    qreal radius = BallItemsProvider::instance()->sprites().maxRadius();
     qreal diameter = 2.0 * radius;
-    setRect(-radius, -radius, diameter, diameter);
+    m_boundingRect = QRectF(-radius, -radius, diameter, diameter);
 }
 
 //!
+QRectF BallItem::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+/*!
+  * The sprite is centered on the position of the item whatever its look.
+  */
 void BallItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *options, QWidget *widget)
 {
     Q_UNUSED(options);
     Q_UNUSED(widget);
 
-    qreal radius = m_radius;
+#if defined(LINES_PAINT_PROFILE)
+    PaintTimer timer(PaintProfile::BallPaint);
+#endif
 
+    BallSpriteCache::State state = BallSpriteCache::Normal;
     if (m_hintFlag)
-        radius /= 3;
+        state = BallSpriteCache::Hint;
     else if (m_selectedFlag)
-        radius *= 1.2;
-
-    qreal diameter = 2 * radius;
-    setRect(-radius, -radius, diameter, diameter);
+        state = BallSpriteCache::Selected;
 
-    m_paintCntx->gradient().setRadius(radius);
-    setBrush(m_paintCntx->gradient());
+    const QPixmap &sprite = BallItemsProvider::instance()->sprites().sprite(m_colorIndex, state,
+                                                                             painter->device()->devicePixelRatioF());
 
-    QGraphicsEllipseItem::paint(painter, options, widget);
+    qreal half = sprite.width() / sprite.devicePixelRatio() / 2;
+    painter->drawPixmap(QPointF(-half, -half), sprite);
 }
@@ -8,15 +8,16 @@
 #define BALLITEM_HPP
 
 #include <QGraphicsItem>
-#include <QGraphicsEllipseItem>
-#include <QRadialGradient>
 #include <QtCore/QSharedDataPointer>
 #include "gridpos.hpp"
 #include "ballpaintinfo.hpp"
 
 /*! This class implements a ball item.
+  *
+  * The ball is painted as a blit of its sprite (see BallSpriteCache); its geometry is the one of
+  * the largest look, so selecting a ball or turning a 'hint' ball into a normal one only repaints it.
   */
-class BallItem : public QGraphicsEllipseItem
+class BallItem : public QGraphicsItem
 {
 public:
     /*! The constructor.
@@ -26,6 +27,11 @@ public:
 
     //! overrided methods
 
+    /*! Returns the bounding rectangle of this item.
+      * @return the bounding rectangle of the selected ball (the largest look)
+      */
+    QRectF boundingRect() const;
+
     /*! Renders the ball item.
       * @param[in] painter the painter
       * @param[in] options the parameters used to paint this graphic item
@@ -60,6 +66,24 @@ public:
         return m_paintCntx->color();
     }
 
+    /*!
+      * @return the index of the color of the ball item (see BallItemsProvider::init())
+      * \sa setColorIndex()
+      */
+    inline int colorIndex() const
+    {
+        return m_colorIndex;
+    }
+
+    /*!
+      * @param[in] index the index of the color of the ball item
+      * \sa colorIndex()
+      */
+    inline void setColorIndex(int index)
+    {
+        m_colorIndex = index;
+    }
+
     /*!
       * @return the grid coordinates of a ball item
       * \sa row(), column(), setCoordinates()
@@ -149,8 +173,9 @@ public:
     }
 
 private:
-    qreal m_radius; /*!< the radius of the ball */
+    QRectF m_boundingRect; /*!< the bounding rectangle */
     QSharedDataPointer<BallItemPaintCntx> m_paintCntx; /*!< the painting context (color and brush) */
+    int m_colorIndex; /*!< the index of the color */
 
     GridPos m_coord; /*!< the position of the ball in the grid's coordinates */
     bool   m_hintFlag; /*!< is the ball a hint one ? */
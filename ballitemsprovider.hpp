@@ -10,17 +10,20 @@
 #include <QtCore/QVector>
 #include <QtGui/QColor>
 #include <QtCore/QSharedDataPointer>
-#include <QtCore/QList>
 #include "griditem.hpp"
 #include "singleton.hpp"
 #include "ballpaintinfo.hpp"
+#include "ballspritecache.hpp"
 
 // forward declarations
 class BallItem;
 
-/*! This class handles the creation of the new ball items.
+/*! This class handles the ball items (the rules that place them run in GameEngine).
+  *
+  * The ball items are recycled: a pool of hidden items parented to the grid is built once, a new ball
+  * takes an item from the pool and gets the look of its color, a removed ball is hidden and returned
+  * to the pool. The scene never inserts nor removes an item during a game.
   *
-  * It also manages the lists that store the available and the occupied positions in the grid.
   * This class implements the singleton pattern.
   */
 class BallItemsProvider : public Singleton<BallItemsProvider>
@@ -44,95 +47,54 @@ public:
         return m_grid;
     }
 
-    /*! Gets and displays the set of the next three balls.
-      * @param[in] enforceHints if true it forces the producing of the 'hint' balls
-      */
-    const QList<BallItem*>& nextBalls(bool enforceHints = false);
-
-    /*!
-      * @return the list of the hint balls.
-      */
-    inline QList<BallItem*>& hintBalls()
-    {
-        return m_hintBalls;
-    }
-
-    /*! Resets all the lists: the hints and current balls as well as the used and available positions.
-      */
-    void reset();
-
-    /*! Initializes the lists of the ball items and the textures used to render the balls.
-      * @param[in] grid the grid item
+    /*! Initializes the painting contexts of the ball items, the textures used to render the balls and the pool
+      * of the ball items (one per square of the grid).
+      * @param[in] grid the grid item (it has to be in its scene already)
       */
     void init(GridItem *);
 
-    /*! Creates a new ball and selects randomly the painting context (\sa m_colors).
-      */
-    BallItem *createBall();
-
-    /*! Remove a ball item from the list of the hint ball items.
-      * @param[in] ball the ball item to be removed from the list of the hint ball items.
-      */
-    void removeHint(BallItem *);
-
     /*!
-      * @return the reference to the list of the available indexes
-      * \sa usedIndexes()
+      * @return the sprites of the balls
       */
-    inline QList<int>& availableIndexes()
+    inline BallSpriteCache &sprites()
     {
-        return m_availableIdxs;
+        return m_sprites;
     }
 
-    /*!
-      * @return the reference to the list of the used indexes
-      * \sa availableIndexes()
+    /*! Takes a ball item from the pool (or creates one if the pool is empty) and gives it the look
+      * of a normal ball of a given color. The item is hidden; GridItem::showBall() shows it.
+      * @param[in] index the index of the color (\sa m_colors)
+      * \sa releaseBall()
       */
-    inline QList<int>& usedIndexes()
-    {
-        return m_usedIdxs;
-    }
+    BallItem *acquireBall(int index);
 
-    /*! Transfer a index from the list of the available indexes into the list of the used ones.
-      * @param[in] pos the coordinate of the cell that is to be occupied
-      * \sa fromUsedToAvailable()
+    /*! Hides a ball item and returns it to the pool.
+      * @param[in] ball the ball item
+      * \sa acquireBall()
       */
-    void fromAvailableToUsed(const GridPos &pos);
+    void releaseBall(BallItem *ball);
 
-    /*! Transfer a index from the list of the used indexes into the list of the available ones.
-      * @param[in] pos the coordinate of the cell that is to be freed
-      * \sa fromAvailableToUsed
-      */
-    void fromUsedToAvailable(const GridPos &pos);
-
-    /*! Transfer a index from the list of the used indexes into the list of the available ones.
-      * @param[in] pos the coordinate of the cell that is to become available
-      * \sa toUnidimensionalIndex(int roe, int col)
+    /*!
+      * @return the number of the ball items created so far (the pool and the balls in use)
       */
-    inline int toUnidimensionalIndex(const GridPos &pos)
+    inline int createdCount() const
     {
-        return pos.row() * m_grid->dim() + pos.column();
+        return m_createdCount;
     }
 
-    /*! Convert a bi-dimensional index in a matrix to a uni-dimensional index.
-      * @param[in] row the row
-      * @param[in] col the column
-      * \sa toUnidimensionalIndex(const GridPos &pos)
+private:
+    /*! Creates a new hidden ball item parented to the grid.
       */
-    inline int toUnidimensionalIndex(int row, int col)
-    {
-        return row * m_grid->dim() + col;
-    }
+    BallItem *createBall();
 
 private:
     QVector<QSharedDataPointer<BallItemPaintCntx> > m_colors; /*!< the painting contexts for rendering the ball items */
+    BallSpriteCache m_sprites; /*!< the pre-rendered balls */
 
     GridItem *m_grid; /*!< the grid */
-    QList<BallItem*> m_hintBalls; /*!< the set of the 'hint' ball items */
-    QList<BallItem*> m_currentBalls; /*! the set of the current ball items */
 
-    QList<int> m_availableIdxs; /*!< the available indexes */
-    QList<int> m_usedIdxs; /*!< the used indexes */
+    QVector<BallItem*> m_pool; /*!< the hidden ball items ready to be reused */
+    int m_createdCount; /*!< the number of the ball items created so far */
 };
 
 #endif // BALLITEMSPROVIDER_HPP
@@ -0,0 +1,67 @@
+/*!
+  * @file ballspritecache.cpp
+  * This file contains the definition of the class BallSpriteCache.
+  */
+
+#include <QtCore/QtMath>
+#include <QtGui/QPainter>
+#include <QtGui/QRadialGradient>
+#include "ballspritecache.hpp"
+
+//!
+BallSpriteCache::BallSpriteCache()
+    : m_radius(16.0)
+{
+}
+
+//!
+void BallSpriteCache::init(const QVector<QColor> &colors, qreal radius)
+{
+    m_colors = colors;
+    m_radius = radius;
+    m_sprites.clear();
+}
+
+/*!
+  * The device pixel ratio is part of the key (in hundredths), so a window moved onto a screen of
+  * another density gets sharp sprites of its own.
+  */
+const QPixmap &BallSpriteCache::sprite(int colorIndex, State state, qreal dpr)
+{
+    quint32 key = (quint32(qRound(dpr * 100)) << 16) | (quint32(state) << 8) | quint32(colorIndex);
+
+    QHash<quint32, QPixmap>::iterator it = m_sprites.find(key);
+    if (it == m_sprites.end()) {
+        it = m_sprites.insert(key, render(colorIndex, state, dpr));
+    }
+
+    return it.value();
+}
+
+/*!
+  * The gradient is the one the balls used to be painted with (see BallItemsProvider::init()):
+  * lighter at the center, the plain color at the border.
+  */
+QPixmap BallSpriteCache::render(int colorIndex, State state, qreal dpr) const
+{
+    qreal r = radius(state);
+    int size = qCeil(2 * r * dpr);
+
+    QPixmap pixmap(size, size);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QColor color = m_colors.value(colorIndex, Qt::black);
+    QRadialGradient gradient(QPointF(0, 0), r);
+    gradient.setColorAt(0.02, color.lighter());
+    gradient.setColorAt(0.98, color);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(size / dpr / 2, size / dpr / 2);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(gradient);
+    painter.drawEllipse(QPointF(0, 0), r, r);
+
+    return pixmap;
+}
@@ -0,0 +1,107 @@
+/*!
+  * @file ballspritecache.hpp
+  * This file contains the declaration of the class BallSpriteCache.
+  */
+#ifndef BALLSPRITECACHE_HPP
+#define BALLSPRITECACHE_HPP
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QtGui/QColor>
+#include <QtGui/QPixmap>
+
+/*! This class keeps the pre-rendered images (sprites) of the balls.
+  *
+  * A look of a ball is given by its color, its state (normal, selected or 'hint') and the device
+  * pixel ratio of the painted device. Every look is rasterized once, the first time it is asked for,
+  * with the antialiased radial gradient of the ball; painting a ball is then a single blit of its
+  * sprite. The cache is cleared when the colors or the radius change.
+  */
+class BallSpriteCache
+{
+public:
+    /*! \brief The states of a ball that have their own sprite.
+      */
+    enum State
+    {
+        Normal = 0,
+        Selected,
+        Hint,
+        StateCount
+    };
+
+    /*! The constructor.
+      */
+    BallSpriteCache();
+
+    /*! Sets the colors and the radius of the balls and drops the sprites.
+      * @param[in] colors the colors of the balls
+      * @param[in] radius the radius of a normal ball (in logical pixels)
+      */
+    void init(const QVector<QColor> &colors, qreal radius);
+
+    /*!
+      * @param[in] state the state of the ball
+      * @return the radius of a ball in the given state (in logical pixels)
+      */
+    inline qreal radius(State state) const
+    {
+        return m_radius * scale(state);
+    }
+
+    /*!
+      * @return the radius of the largest ball (the selected one)
+      */
+    inline qreal maxRadius() const
+    {
+        return radius(Selected);
+    }
+
+    /*!
+      * @param[in] colorIndex the index of the color
+      * @return the plain color of the balls of the given index
+      */
+    inline QColor color(int colorIndex) const
+    {
+        return m_colors.value(colorIndex, Qt::black);
+    }
+
+    /*! Gets the sprite of a look, rendering it on the first use.
+      * @param[in] colorIndex the index of the color
+      * @param[in] state the state of the ball
+      * @param[in] dpr the device pixel ratio of the painted device
+      * @return the sprite; its device pixel ratio is set, so it is drawn at its logical size
+      */
+    const QPixmap &sprite(int colorIndex, State state, qreal dpr);
+
+    /*!
+      * @return the number of the rendered sprites
+      */
+    inline int count() const
+    {
+        return m_sprites.count();
+    }
+
+    /*!
+      * @return the ratio between the radius of a ball in the given state and the normal radius
+      */
+    static inline qreal scale(State state)
+    {
+        return (state == Selected) ? 1.2 : ((state == Hint) ? 1.0 / 3.0 : 1.0);
+    }
+
+private:
+    BallSpriteCache(const BallSpriteCache &);
+    BallSpriteCache &operator =(const BallSpriteCache &);
+
+    /*! Rasterizes a look.
+      */
+    QPixmap render(int colorIndex, State state, qreal dpr) const;
+
+private:
+    QVector<QColor> m_colors; /*!< the colors of the balls */
+    qreal m_radius; /*!< the radius of a normal ball */
+    QHash<quint32, QPixmap> m_sprites; /*!< the sprites keyed by the look */
+};
+
+#endif // BALLSPRITECACHE_HPP
@@ -0,0 +1,478 @@
+/*!
+  * @file batchevaluator.cpp
+  * This file contains the definition of the class BatchEvaluator.
+  */
+
+#include <string.h>
+#include "batchevaluator.hpp"
+
+#if !defined(LINES_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__))
+#define LINES_EVAL_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define LINES_EVAL_AVX2
+#define LINES_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define LINES_EVAL_AVX2
+#define LINES_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+namespace
+{
+    // the first and the last (exclusive) rows and columns of the starts of the windows:
+    // W-E, N-S, NW-SE and SW-NE
+    inline void windowStarts(int direction, int dimension, int &firstRow, int &lastRow, int &lastColumn)
+    {
+        int span = dimension - Board::LineLength + 1;
+
+        firstRow = (direction == 3) ? Board::LineLength - 1 : 0;
+        lastRow = (direction == 0) || (direction == 3) ? dimension : span;
+        lastColumn = (direction == 1) ? dimension : span;
+    }
+}
+
+//!
+BatchEvaluator::BatchEvaluator(Evaluator::Kernel kernel)
+    : m_kernel(Evaluator::ScalarKernel),
+    m_evaluator(Evaluator::ScalarKernel),
+    m_dimension(0),
+    m_lanes(0)
+{
+    memset(m_counts, 0, sizeof(m_counts));
+    memset(m_points, 0, sizeof(m_points));
+
+    setKernel(kernel);
+}
+
+//!
+void BatchEvaluator::setKernel(Evaluator::Kernel kernel)
+{
+    m_kernel = Evaluator::isSupported(kernel) ? kernel : Evaluator::ScalarKernel;
+}
+
+//!
+int BatchEvaluator::lanes() const
+{
+    switch (m_kernel) {
+    case Evaluator::Avx2Kernel:
+        return 32;
+    case Evaluator::Sse2Kernel:
+        return 16;
+    default:
+        return 1;
+    }
+}
+
+/*!
+  * A pass takes the next boards of the same dimension, up to lanes(); the lanes left over
+  * by the last pass keep the boards of the previous one and their counts are not used.
+  */
+void BatchEvaluator::evaluate(const Board *boards, int count, int *scores)
+{
+    int lanes = this->lanes();
+
+    int i = 0;
+    while (i < count) {
+        if (1 == lanes) {
+            scores[i] = m_evaluator.evaluate(boards[i], Evaluator::ScalarKernel);
+            ++i;
+            continue;
+        }
+
+        int dimension = boards[i].dim();
+        int n = 1;
+        while ((n < lanes) && (i + n < count) && (boards[i + n].dim() == dimension)) {
+            ++n;
+        }
+
+        load(boards + i, n, lanes);
+
+        if (m_kernel == Evaluator::Avx2Kernel) {
+            runAvx2(dimension);
+        } else {
+            runSse2(dimension);
+        }
+
+        finish(boards + i, n, scores + i);
+        i += n;
+    }
+}
+
+//!
+void BatchEvaluator::evaluateMoves(const Board &board, const Board::Move *moves, int count, int *values)
+{
+    for (int i = 0; i < count; i += MaxLanes) {
+        int n = (count - i < MaxLanes) ? count - i : MaxLanes;
+
+        for (int j = 0; j < n; ++j) {
+            m_next[j] = board;
+            m_points[j] = m_next[j].applyMove(moves[i + j]);
+        }
+
+        evaluate(m_next, n, values + i);
+
+        for (int j = 0; j < n; ++j) {
+            values[i + j] += m_points[j];
+        }
+    }
+}
+
+/*!
+  * The arrays are cleared when the layout changes, so that the cells around the board always
+  * read as a border of occupied cells without color (neither empty nor reached).
+  */
+void BatchEvaluator::load(const Board *boards, int count, int lanes)
+{
+    int dimension = boards[0].dim();
+
+    if ((m_dimension != dimension) || (m_lanes != lanes)) {
+        memset(m_cells, 0, sizeof(m_cells));
+        memset(m_empty, 0, sizeof(m_empty));
+        memset(m_bits, 0, sizeof(m_bits));
+        memset(m_reach, 0, sizeof(m_reach));
+
+        m_dimension = dimension;
+        m_lanes = lanes;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        for (int r = 0; r < dimension; ++r) {
+            const Board::Cell *row = boards[i].cells() + Board::index(r, 0);
+            unsigned char *cells = m_cells + cell(r, 0) * lanes + i;
+            for (int c = 0; c < dimension; ++c) {
+                cells[c * lanes] = row[c];
+            }
+        }
+    }
+}
+
+/*!
+  * The sum of the scalar kernel, regrouped by the weights: every open window that holds n balls
+  * scores m_line[n], every empty window scores m_line[0] for every color and every reachable cell
+  * of an open window that holds balls scores m_reach.
+  */
+void BatchEvaluator::finish(const Board *boards, int count, int *scores) const
+{
+    const EvalWeights &weights = m_evaluator.weights();
+
+    for (int i = 0; i < count; ++i) {
+        int score = weights.m_free * boards[i].freeCount();
+        for (int n = 1; n <= Board::LineLength; ++n) {
+            score += weights.m_line[n] * m_counts[n - 1][i];
+        }
+
+        score += Board::Colors * weights.m_line[0] * m_counts[Board::LineLength][i];
+        score += weights.m_reach * m_counts[Board::LineLength + 1][i];
+
+        scores[i] = score;
+    }
+}
+
+#ifdef LINES_EVAL_SSE2
+/*!
+  * The bits of the colors reaching the empty cells start from the balls next to them and are spread
+  * over the regions by forward and backward sweeps until no lane changes. The windows are then counted
+  * in 8 bits lanes, which are added up into 16 bits lanes after every row of window starts (at most 16
+  * windows, that is 80 reachable cells).
+  */
+void BatchEvaluator::runSse2(int dimension)
+{
+    const int lanes = 16;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i length = _mm_set1_epi8(Board::LineLength);
+
+    // the empty cells, the bits of the balls and the bits of the colors next to the empty cells
+    for (int r = 0; r < dimension; ++r) {
+        for (int c = 0; c < dimension; ++c) {
+            int p = cell(r, c) * lanes;
+            __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_cells + p));
+
+            __m128i bits = zero;
+            for (int k = 1; k <= Board::Colors; ++k) {
+                bits = _mm_or_si128(bits, _mm_and_si128(_mm_cmpeq_epi8(cells, _mm_set1_epi8(char(k))), _mm_set1_epi8(char(1 << (k - 1)))));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(m_bits + p), bits);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(m_empty + p), _mm_cmpeq_epi8(cells, zero));
+        }
+    }
+
+    const int neighbours[4] = { -lanes, lanes, -Pitch * lanes, Pitch * lanes };
+
+    for (int r = 0; r < dimension; ++r) {
+        for (int c = 0; c < dimension; ++c) {
+            int p = cell(r, c) * lanes;
+            __m128i next = zero;
+            for (int i = 0; i < 4; ++i) {
+                next = _mm_or_si128(next, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_bits + p + neighbours[i])));
+            }
+
+            __m128i empty = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_empty + p));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(m_reach + p), _mm_and_si128(next, empty));
+        }
+    }
+
+    int first = cell(0, 0);
+    int last = cell(dimension - 1, dimension - 1);
+
+    __m128i changed;
+    do {
+        changed = zero;
+        for (int sweep = 0; sweep < 2; ++sweep) {
+            int step = sweep ? -1 : 1;
+            for (int q = sweep ? last : first; q != (sweep ? first - 1 : last + 1); q += step) {
+                int p = q * lanes;
+                __m128i empty = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_empty + p));
+                __m128i reach = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_reach + p));
+
+                __m128i next = reach;
+                for (int i = 0; i < 4; ++i) {
+                    next = _mm_or_si128(next, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_reach + p + neighbours[i])));
+                }
+                next = _mm_and_si128(next, empty);
+
+                changed = _mm_or_si128(changed, _mm_xor_si128(next, reach));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(m_reach + p), next);
+            }
+        }
+    } while (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(changed, zero)));
+
+    // the windows
+    const int deltas[4] = { lanes, Pitch * lanes, (Pitch + 1) * lanes, (1 - Pitch) * lanes };
+
+    __m128i lineCounts[Board::LineLength];
+    for (int n = 1; n <= Board::LineLength; ++n) {
+        lineCounts[n - 1] = _mm_set1_epi8(char(n));
+    }
+
+    __m128i totals[Board::LineLength + 2][2];
+    for (int j = 0; j < Board::LineLength + 2; ++j) {
+        totals[j][0] = zero;
+        totals[j][1] = zero;
+    }
+
+    for (int d = 0; d < 4; ++d) {
+        int delta = deltas[d];
+        int firstRow, lastRow, lastColumn;
+        windowStarts(d, dimension, firstRow, lastRow, lastColumn);
+
+        for (int r = firstRow; r < lastRow; ++r) {
+            __m128i counts[Board::LineLength + 2];
+            for (int j = 0; j < Board::LineLength + 2; ++j) {
+                counts[j] = zero;
+            }
+
+            for (int c = 0; c < lastColumn; ++c) {
+                int p = cell(r, c) * lanes;
+
+                __m128i cells[Board::LineLength];
+                __m128i empties = zero;
+                __m128i top = zero;
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    cells[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_cells + p + i * delta));
+                    empties = _mm_sub_epi8(empties, _mm_cmpeq_epi8(cells[i], zero));
+                    top = _mm_max_epu8(top, cells[i]);
+                }
+
+                __m128i same = zero;
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    same = _mm_sub_epi8(same, _mm_cmpeq_epi8(cells[i], top));
+                }
+
+                __m128i allEmpty = _mm_cmpeq_epi8(empties, length);
+                __m128i balls = _mm_andnot_si128(allEmpty, _mm_cmpeq_epi8(_mm_add_epi8(same, empties), length));
+                counts[Board::LineLength] = _mm_sub_epi8(counts[Board::LineLength], allEmpty);
+
+                if (0 == _mm_movemask_epi8(balls)) {
+                    continue;
+                }
+
+                __m128i own = _mm_sub_epi8(length, empties);
+                for (int n = 0; n < Board::LineLength; ++n) {
+                    counts[n] = _mm_sub_epi8(counts[n], _mm_and_si128(_mm_cmpeq_epi8(own, lineCounts[n]), balls));
+                }
+
+                // the balls of an open window have one color, the union of their bits is that color
+                __m128i bits = zero;
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    bits = _mm_or_si128(bits, _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_bits + p + i * delta)));
+                }
+
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    __m128i reach = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(m_reach + p + i * delta)), bits);
+                    counts[Board::LineLength + 1] = _mm_sub_epi8(counts[Board::LineLength + 1], _mm_andnot_si128(_mm_cmpeq_epi8(reach, zero), balls));
+                }
+            }
+
+            for (int j = 0; j < Board::LineLength + 2; ++j) {
+                totals[j][0] = _mm_add_epi16(totals[j][0], _mm_unpacklo_epi8(counts[j], zero));
+                totals[j][1] = _mm_add_epi16(totals[j][1], _mm_unpackhi_epi8(counts[j], zero));
+            }
+        }
+    }
+
+    for (int j = 0; j < Board::LineLength + 2; ++j) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(m_counts[j]), totals[j][0]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(m_counts[j] + 8), totals[j][1]);
+    }
+}
+#else
+//!
+void BatchEvaluator::runSse2(int)
+{
+}
+#endif
+
+#ifdef LINES_EVAL_AVX2
+/*!
+  * The same as runSse2() with 32 boards per pass; the 8 bits counts are widened half by half
+  * (_mm256_cvtepu8_epi16), which keeps the order of the boards.
+  */
+LINES_TARGET_AVX2 void BatchEvaluator::runAvx2(int dimension)
+{
+    const int lanes = 32;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i length = _mm256_set1_epi8(Board::LineLength);
+
+    for (int r = 0; r < dimension; ++r) {
+        for (int c = 0; c < dimension; ++c) {
+            int p = cell(r, c) * lanes;
+            __m256i cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_cells + p));
+
+            __m256i bits = zero;
+            for (int k = 1; k <= Board::Colors; ++k) {
+                bits = _mm256_or_si256(bits, _mm256_and_si256(_mm256_cmpeq_epi8(cells, _mm256_set1_epi8(char(k))), _mm256_set1_epi8(char(1 << (k - 1)))));
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(m_bits + p), bits);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(m_empty + p), _mm256_cmpeq_epi8(cells, zero));
+        }
+    }
+
+    const int neighbours[4] = { -lanes, lanes, -Pitch * lanes, Pitch * lanes };
+
+    for (int r = 0; r < dimension; ++r) {
+        for (int c = 0; c < dimension; ++c) {
+            int p = cell(r, c) * lanes;
+            __m256i next = zero;
+            for (int i = 0; i < 4; ++i) {
+                next = _mm256_or_si256(next, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_bits + p + neighbours[i])));
+            }
+
+            __m256i empty = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_empty + p));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(m_reach + p), _mm256_and_si256(next, empty));
+        }
+    }
+
+    int first = cell(0, 0);
+    int last = cell(dimension - 1, dimension - 1);
+
+    __m256i changed;
+    do {
+        changed = zero;
+        for (int sweep = 0; sweep < 2; ++sweep) {
+            int step = sweep ? -1 : 1;
+            for (int q = sweep ? last : first; q != (sweep ? first - 1 : last + 1); q += step) {
+                int p = q * lanes;
+                __m256i empty = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_empty + p));
+                __m256i reach = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_reach + p));
+
+                __m256i next = reach;
+                for (int i = 0; i < 4; ++i) {
+                    next = _mm256_or_si256(next, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_reach + p + neighbours[i])));
+                }
+                next = _mm256_and_si256(next, empty);
+
+                changed = _mm256_or_si256(changed, _mm256_xor_si256(next, reach));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(m_reach + p), next);
+            }
+        }
+    } while (-1 != _mm256_movemask_epi8(_mm256_cmpeq_epi8(changed, zero)));
+
+    const int deltas[4] = { lanes, Pitch * lanes, (Pitch + 1) * lanes, (1 - Pitch) * lanes };
+
+    __m256i lineCounts[Board::LineLength];
+    for (int n = 1; n <= Board::LineLength; ++n) {
+        lineCounts[n - 1] = _mm256_set1_epi8(char(n));
+    }
+
+    __m256i totals[Board::LineLength + 2][2];
+    for (int j = 0; j < Board::LineLength + 2; ++j) {
+        totals[j][0] = zero;
+        totals[j][1] = zero;
+    }
+
+    for (int d = 0; d < 4; ++d) {
+        int delta = deltas[d];
+        int firstRow, lastRow, lastColumn;
+        windowStarts(d, dimension, firstRow, lastRow, lastColumn);
+
+        for (int r = firstRow; r < lastRow; ++r) {
+            __m256i counts[Board::LineLength + 2];
+            for (int j = 0; j < Board::LineLength + 2; ++j) {
+                counts[j] = zero;
+            }
+
+            for (int c = 0; c < lastColumn; ++c) {
+                int p = cell(r, c) * lanes;
+
+                __m256i cells[Board::LineLength];
+                __m256i empties = zero;
+                __m256i top = zero;
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    cells[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_cells + p + i * delta));
+                    empties = _mm256_sub_epi8(empties, _mm256_cmpeq_epi8(cells[i], zero));
+                    top = _mm256_max_epu8(top, cells[i]);
+                }
+
+                __m256i same = zero;
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    same = _mm256_sub_epi8(same, _mm256_cmpeq_epi8(cells[i], top));
+                }
+
+                __m256i allEmpty = _mm256_cmpeq_epi8(empties, length);
+                __m256i balls = _mm256_andnot_si256(allEmpty, _mm256_cmpeq_epi8(_mm256_add_epi8(same, empties), length));
+                counts[Board::LineLength] = _mm256_sub_epi8(counts[Board::LineLength], allEmpty);
+
+                if (0 == _mm256_movemask_epi8(balls)) {
+                    continue;
+                }
+
+                __m256i own = _mm256_sub_epi8(length, empties);
+                for (int n = 0; n < Board::LineLength; ++n) {
+                    counts[n] = _mm256_sub_epi8(counts[n], _mm256_and_si256(_mm256_cmpeq_epi8(own, lineCounts[n]), balls));
+                }
+
+                __m256i bits = zero;
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    bits = _mm256_or_si256(bits, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_bits + p + i * delta)));
+                }
+
+                for (int i = 0; i < Board::LineLength; ++i) {
+                    __m256i reach = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_reach + p + i * delta)), bits);
+                    counts[Board::LineLength + 1] = _mm256_sub_epi8(counts[Board::LineLength + 1], _mm256_andnot_si256(_mm256_cmpeq_epi8(reach, zero), balls));
+                }
+            }
+
+            for (int j = 0; j < Board::LineLength + 2; ++j) {
+                totals[j][0] = _mm256_add_epi16(totals[j][0], _mm256_cvtepu8_epi16(_mm256_castsi256_si128(counts[j])));
+                totals[j][1] = _mm256_add_epi16(totals[j][1], _mm256_cvtepu8_epi16(_mm256_extracti128_si256(counts[j], 1)));
+            }
+        }
+    }
+
+    for (int j = 0; j < Board::LineLength + 2; ++j) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(m_counts[j]), totals[j][0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(m_counts[j] + 16), totals[j][1]);
+    }
+}
+#else
+//!
+void BatchEvaluator::runAvx2(int dimension)
+{
+    runSse2(dimension);
+}
+#endif
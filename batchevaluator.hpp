@@ -0,0 +1,129 @@
+/*!
+  * @file batchevaluator.hpp
+  * This file contains the declaration of the class BatchEvaluator.
+  */
+#ifndef BATCHEVALUATOR_HPP
+#define BATCHEVALUATOR_HPP
+
+#include "board.hpp"
+#include "evaluator.hpp"
+
+/*! This class evaluates many boards of the same dimension at once, e.g. all the positions
+  * reached by the legal moves of a position.
+  *
+  * The boards are laid out lane by lane: the array of a cell holds the value of that cell on
+  * 16 (SSE2) or 32 (AVX2) boards, so that every step of the evaluation (the flood fill of the
+  * regions of the empty cells reached by every color and the scan of the windows of the lines)
+  * runs on all the boards of a pass with the same instructions. The score of a board is exactly
+  * the one of Evaluator::evaluate(); the scalar kernel evaluates the boards one by one.
+  */
+class BatchEvaluator
+{
+public:
+    enum
+    {
+        MaxLanes = 32 // the greatest number of boards evaluated by one pass
+    };
+
+    /*! The constructor.
+      * @param[in] kernel the kernel used by evaluate()
+      */
+    explicit BatchEvaluator(Evaluator::Kernel kernel = Evaluator::bestKernel());
+
+    /*!
+      * @return the kernel used by evaluate()
+      */
+    inline Evaluator::Kernel kernel() const
+    {
+        return m_kernel;
+    }
+
+    /*! Sets the kernel used by evaluate(); falls back to the scalar kernel if the given one is not supported.
+      */
+    void setKernel(Evaluator::Kernel kernel);
+
+    /*!
+      * @return the number of the boards evaluated by one pass of the kernel
+      */
+    int lanes() const;
+
+    /*!
+      * @return the weights of the heuristic
+      */
+    inline const EvalWeights& weights() const
+    {
+        return m_evaluator.weights();
+    }
+
+    /*! Sets the weights of the heuristic (clamped as by Evaluator::setWeights()).
+      */
+    inline void setWeights(const EvalWeights &weights)
+    {
+        m_evaluator.setWeights(weights);
+    }
+
+    /*! Evaluates candidate boards.
+      *
+      * @param[in] boards the boards
+      * @param[in] count the number of the boards
+      * @param[out] scores receives the scores of the boards (as returned by Evaluator::evaluate())
+      */
+    void evaluate(const Board *boards, int count, int *scores);
+
+    /*! Plays moves (without the spawning of the next balls) and evaluates the positions reached,
+      * as Evaluator::suggestMove() does.
+      *
+      * @param[in] board the position
+      * @param[in] moves the moves
+      * @param[in] count the number of the moves
+      * @param[out] values receives the points scored by the moves plus the scores of the positions
+      */
+    void evaluateMoves(const Board &board, const Board::Move *moves, int count, int *values);
+
+private:
+    enum
+    {
+        Pitch = Board::MaxDimension + 2,  // the distance between two rows of the lane arrays
+        Cells = Pitch * Pitch             // the cells of the lane arrays (with a border of empty cells)
+    };
+
+    /*!
+      * @return the index of a cell in the lane arrays
+      */
+    static inline int cell(int r, int c)
+    {
+        return (r + 1) * Pitch + c + 1;
+    }
+
+    /*! Copies the cells of the boards into the lane arrays.
+      */
+    void load(const Board *boards, int count, int lanes);
+
+    /*! Computes the scores of the boards from the counts of their windows.
+      */
+    void finish(const Board *boards, int count, int *scores) const;
+
+    void runSse2(int dimension);
+    void runAvx2(int dimension);
+
+private:
+    Evaluator::Kernel m_kernel; /*!< the kernel used by evaluate() */
+    Evaluator m_evaluator; /*!< the weights and the scalar kernel */
+    int m_dimension; /*!< the dimension the lane arrays were laid out for */
+    int m_lanes; /*!< the number of the lanes the arrays were laid out for */
+
+    unsigned char m_cells[Cells * MaxLanes]; /*!< the cells of the boards, lane by lane */
+    unsigned char m_empty[Cells * MaxLanes]; /*!< 0xFF if the cell is empty (0 on the border) */
+    unsigned char m_bits[Cells * MaxLanes]; /*!< the bit of the color of the ball of the cell */
+    unsigned char m_reach[Cells * MaxLanes]; /*!< the bits of the colors that can reach the empty cell */
+
+    /*! the counts of the windows, per board: the open windows by the number of their balls
+      * (m_counts[n - 1]), the empty windows (m_counts[LineLength]) and the reachable cells of
+      * the open windows that hold balls (m_counts[LineLength + 1]) */
+    unsigned short m_counts[Board::LineLength + 2][MaxLanes];
+
+    Board m_next[MaxLanes]; /*!< the positions reached by the moves (used by evaluateMoves()) */
+    int m_points[MaxLanes]; /*!< the points scored by the moves (used by evaluateMoves()) */
+};
+
+#endif // BATCHEVALUATOR_HPP
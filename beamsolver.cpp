@@ -0,0 +1,294 @@
+/*!
+  * @file beamsolver.cpp
+  * This file contains the definition of the class BeamSolver.
+  */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include "beamsolver.hpp"
+
+const unsigned int BeamSolver::NoStep;
+
+//!
+BeamSolver::BeamSolver()
+    : m_width(1000),
+    m_branching(4),
+    m_maxTurns(1000),
+    m_threads(1),
+    m_beamSize(0),
+    m_nextChunk(0),
+    m_expanded(0),
+    m_elapsed(0),
+    m_bestStep(NoStep),
+    m_bestScore(0),
+    m_score(0)
+{
+    setThreads(0);
+}
+
+//!
+void BeamSolver::setThreads(int threads)
+{
+    if (threads <= 0) {
+        threads = int(std::thread::hardware_concurrency());
+    }
+
+    m_threads = (threads > 0) ? threads : 1;
+}
+
+//!
+bool BeamSolver::solve(const Board &board, const Random &rng)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    m_moves.clear();
+    m_score = board.score();
+    m_expanded = 0;
+    m_elapsed = 0;
+
+    std::vector<Board::Move> moves(Board::MaxMoves);
+    if (board.isGameOver() || (0 == board.legalMoves(&moves[0]))) {
+        return false;
+    }
+
+    // the arenas are allocated once per search
+    m_beam.resize(m_width);
+    m_children.resize(size_t(m_width) * m_branching);
+    m_order.reserve(m_children.size());
+    m_history.clear();
+    m_history.reserve(size_t(m_width) * 4);
+
+    State &root = m_beam[0];
+    root.m_board = board;
+    root.m_rng = rng;
+    root.m_hash = board.hash();
+    root.m_value = 0;
+    root.m_history = NoStep;
+    root.m_valid = true;
+    m_beamSize = 1;
+
+    m_bestStep = NoStep;
+    m_bestScore = board.score();
+
+    for (int turn = 0; (turn < m_maxTurns) && (m_beamSize > 0); ++turn) {
+        m_nextChunk = 0;
+
+        std::vector<std::thread> workers;
+        int threads = std::min(m_threads, (m_beamSize + Chunk - 1) / Chunk);
+        for (int i = 1; i < threads; ++i) {
+            workers.push_back(std::thread(&BeamSolver::work, this));
+        }
+
+        work();
+
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+
+        select();
+
+        if (0 == (turn + 1) % CompactPeriod) {
+            compactHistory();
+        }
+    }
+
+    // the best run is either a finished one or one of the beam
+    unsigned int best = m_bestStep;
+    m_score = m_bestScore;
+    for (int i = 0; i < m_beamSize; ++i) {
+        if (m_beam[i].m_board.score() > m_score) {
+            m_score = m_beam[i].m_board.score();
+            best = m_beam[i].m_history;
+        }
+    }
+
+    trace(best, m_moves);
+
+    m_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return true;
+}
+
+//!
+void BeamSolver::work()
+{
+    Evaluator evaluator;
+    std::vector<Board::Move> moves(Board::MaxMoves);
+    std::vector<uint64_t> keys(Board::MaxMoves);
+
+    while (true) {
+        int first = m_nextChunk.fetch_add(1) * Chunk;
+        if (first >= m_beamSize) {
+            break;
+        }
+
+        expand(first, std::min(first + Chunk, m_beamSize), evaluator, &moves[0], &keys[0]);
+    }
+}
+
+/*!
+  * The moves are ranked by Board::moveRank(); the ties are broken by a hash of the move, so
+  * the moves of the same rank are not always taken in the order of Board::legalMoves().
+  */
+void BeamSolver::expand(int first, int last, Evaluator &evaluator, Board::Move *moves, uint64_t *keys)
+{
+    long long played = 0;
+
+    for (int i = first; i < last; ++i) {
+        const State &parent = m_beam[i];
+        State *children = &m_children[size_t(i) * m_branching];
+
+        int count = parent.m_board.legalMoves(moves);
+        for (int k = 0; k < count; ++k) {
+            uint64_t rank = uint64_t(parent.m_board.moveRank(moves[k]));
+            uint64_t tie = Random::mix(parent.m_hash + uint64_t(k)) & 0xFFFFFFFFULL;
+
+            keys[k] = (rank << 48) | (tie << 16) | uint64_t(k);
+        }
+
+        int n = std::min(count, m_branching);
+        std::partial_sort(keys, keys + n, keys + count, std::greater<uint64_t>());
+
+        for (int j = 0; j < m_branching; ++j) {
+            State &child = children[j];
+            child.m_valid = (j < n);
+            if (!child.m_valid) {
+                continue;
+            }
+
+            child.m_board = parent.m_board;
+            child.m_rng = parent.m_rng;
+            child.m_move = moves[keys[j] & 0xFFFF];
+            child.m_history = parent.m_history;
+
+            child.m_board.play(child.m_move, child.m_rng);
+            child.m_hash = child.m_board.hash() ^ Random::mix(child.m_rng.state());
+            child.m_value = child.m_board.isGameOver() ? 0 :
+                (long long)child.m_board.score() + evaluator.evaluate(child.m_board);
+        }
+
+        played += n;
+    }
+
+    m_expanded += played;
+}
+
+/*!
+  * Among the children having the same hash only the best one is kept, then the \a m_width
+  * best children are moved into the beam. The lost runs end here: only their score is kept.
+  */
+void BeamSolver::select()
+{
+    m_order.clear();
+
+    for (size_t i = 0; i < size_t(m_beamSize) * m_branching; ++i) {
+        const State &child = m_children[i];
+        if (!child.m_valid) {
+            continue;
+        }
+
+        if (child.m_board.isGameOver()) {
+            if (child.m_board.score() > m_bestScore) {
+                m_bestScore = child.m_board.score();
+                m_bestStep = unsigned(m_history.size());
+                Step step = { child.m_history, child.m_move };
+                m_history.push_back(step);
+            }
+            continue;
+        }
+
+        m_order.push_back(int(i));
+    }
+
+    // groups the duplicates, the best one first
+    std::sort(m_order.begin(), m_order.end(), [this](int a, int b) {
+        const State &x = m_children[a];
+        const State &y = m_children[b];
+        return (x.m_hash != y.m_hash) ? (x.m_hash < y.m_hash) : (x.m_value > y.m_value);
+    });
+
+    std::vector<int>::iterator end = std::unique(m_order.begin(), m_order.end(), [this](int a, int b) {
+        return m_children[a].m_hash == m_children[b].m_hash;
+    });
+    m_order.erase(end, m_order.end());
+
+    int kept = std::min(int(m_order.size()), m_width);
+    std::nth_element(m_order.begin(), m_order.begin() + kept, m_order.end(), [this](int a, int b) {
+        return m_children[a].m_value > m_children[b].m_value;
+    });
+
+    for (int k = 0; k < kept; ++k) {
+        const State &child = m_children[m_order[k]];
+        Step step = { child.m_history, child.m_move };
+
+        m_beam[k] = child;
+        m_beam[k].m_history = unsigned(m_history.size());
+        m_history.push_back(step);
+    }
+
+    m_beamSize = kept;
+}
+
+/*!
+  * The parent of an entry is always older than the entry, so a single backward pass marks
+  * all the entries reachable from the beam and a forward pass packs them.
+  */
+void BeamSolver::compactHistory()
+{
+    size_t size = m_history.size();
+    m_remap.assign(size, 0);
+
+    for (int i = 0; i < m_beamSize; ++i) {
+        m_remap[m_beam[i].m_history] = 1;
+    }
+
+    if (m_bestStep != NoStep) {
+        m_remap[m_bestStep] = 1;
+    }
+
+    for (size_t i = size; i-- > 0; ) {
+        if (m_remap[i] && (m_history[i].m_parent != NoStep)) {
+            m_remap[m_history[i].m_parent] = 1;
+        }
+    }
+
+    unsigned int packed = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (!m_remap[i]) {
+            continue;
+        }
+
+        Step step = m_history[i];
+        if (step.m_parent != NoStep) {
+            step.m_parent = m_remap[step.m_parent];
+        }
+
+        m_history[packed] = step;
+        m_remap[i] = packed++;
+    }
+
+    m_history.resize(packed);
+
+    for (int i = 0; i < m_beamSize; ++i) {
+        m_beam[i].m_history = m_remap[m_beam[i].m_history];
+    }
+
+    if (m_bestStep != NoStep) {
+        m_bestStep = m_remap[m_bestStep];
+    }
+}
+
+//!
+void BeamSolver::trace(unsigned int step, std::vector<Board::Move> &moves) const
+{
+    moves.clear();
+
+    while (step != NoStep) {
+        moves.push_back(m_history[step].m_move);
+        step = m_history[step].m_parent;
+    }
+
+    std::reverse(moves.begin(), moves.end());
+}
@@ -0,0 +1,189 @@
+/*!
+  * @file beamsolver.hpp
+  * This file contains the declaration of the class BeamSolver.
+  */
+#ifndef BEAMSOLVER_HPP
+#define BEAMSOLVER_HPP
+
+#include <atomic>
+#include <vector>
+#include "board.hpp"
+#include "evaluator.hpp"
+
+/*! This class implements a beam search for the highest score of a seeded run.
+  *
+  * When the game is played with a given seed the whole sequence of the spawned balls follows
+  * from the moves, so a position together with the state of its random numbers generator
+  * determines the rest of the game. The solver keeps the \a width() best positions of every
+  * turn: every position of the beam is continued by its \a branching() most promising moves
+  * (ranked by the lines they make), the children are played, the positions reached several
+  * times are merged (by the hash of the board and of the generator) and the best children
+  * (by score plus evaluation) become the next beam.
+  *
+  * The positions of a beam live in two arenas allocated once per search (the beam and its
+  * children), the moves leading to them are appended to a history that is compacted from time
+  * to time; nothing is allocated per position. The children are computed by several threads.
+  */
+class BeamSolver
+{
+public:
+    /*! The constructor.
+      */
+    BeamSolver();
+
+    /*! Sets the number of the positions kept per turn.
+      */
+    inline void setWidth(int width)
+    {
+        m_width = (width > 0) ? width : 1;
+    }
+
+    /*!
+      * @return the number of the positions kept per turn
+      */
+    inline int width() const
+    {
+        return m_width;
+    }
+
+    /*! Sets the number of the moves played from every position of the beam.
+      */
+    inline void setBranching(int branching)
+    {
+        m_branching = (branching > 0) ? branching : 1;
+    }
+
+    /*!
+      * @return the number of the moves played from every position of the beam
+      */
+    inline int branching() const
+    {
+        return m_branching;
+    }
+
+    /*! Sets the maximum number of the turns of the run (a run that is never lost has no end).
+      */
+    inline void setMaxTurns(int turns)
+    {
+        m_maxTurns = (turns > 0) ? turns : 1;
+    }
+
+    /*! Sets the number of the threads computing the children (0 means one thread per core).
+      */
+    void setThreads(int threads);
+
+    /*! Searches the best sequence of moves.
+      *
+      * @param[in] board the starting position
+      * @param[in] rng the random numbers generator of the run, in its state at the starting position
+      * @return false if there is no legal move in the starting position
+      */
+    bool solve(const Board &board, const Random &rng);
+
+    /*!
+      * @return the best sequence of moves found by the last search
+      */
+    inline const std::vector<Board::Move> &moves() const
+    {
+        return m_moves;
+    }
+
+    /*!
+      * @return the score reached by the best sequence of moves
+      */
+    inline int score() const
+    {
+        return m_score;
+    }
+
+    /*!
+      * @return the number of the positions played during the last search
+      */
+    inline long long expanded() const
+    {
+        return m_expanded;
+    }
+
+    /*!
+      * @return the duration of the last search in seconds
+      */
+    inline double elapsed() const
+    {
+        return m_elapsed;
+    }
+
+private:
+    /*! \brief A position of the beam.
+      */
+    struct State
+    {
+        Board m_board; /*!< the position */
+        Random m_rng; /*!< the generator of the spawned balls */
+        uint64_t m_hash; /*!< the hash of the position and of the generator */
+        long long m_value; /*!< the score plus the evaluation of the position */
+        unsigned int m_history; /*!< the last entry of the history of the position */
+        Board::Move m_move; /*!< the move leading to the position */
+        bool m_valid; /*!< false for the unused slots of the children */
+    };
+
+    /*! \brief An entry of the history: a move and the entry of the previous move.
+      */
+    struct Step
+    {
+        unsigned int m_parent; /*!< the previous entry (NoStep for the first move) */
+        Board::Move m_move; /*!< the move */
+    };
+
+    static const unsigned int NoStep = 0xFFFFFFFFu; /*!< the parent of the first move */
+
+    enum
+    {
+        Chunk = 64,        // the number of the positions of the beam expanded at once by a thread
+        CompactPeriod = 64 // the number of the turns between two compactions of the history
+    };
+
+    /*! Computes the children of the positions [first, last) of the beam.
+      */
+    void expand(int first, int last, Evaluator &evaluator, Board::Move *moves, uint64_t *keys);
+
+    /*! The loop of a thread: takes chunks of the beam until all of them were expanded.
+      */
+    void work();
+
+    /*! Merges the duplicated children and moves the best ones into the beam.
+      */
+    void select();
+
+    /*! Drops the entries of the history no position of the beam leads to.
+      */
+    void compactHistory();
+
+    /*! Rebuilds the moves leading to an entry of the history.
+      */
+    void trace(unsigned int step, std::vector<Board::Move> &moves) const;
+
+private:
+    int m_width; /*!< the number of the positions kept per turn */
+    int m_branching; /*!< the number of the moves played per position */
+    int m_maxTurns; /*!< the maximum number of turns */
+    int m_threads; /*!< the number of the threads */
+
+    std::vector<State> m_beam; /*!< the arena of the positions of the current turn */
+    int m_beamSize; /*!< the number of the positions of the current turn */
+    std::vector<State> m_children; /*!< the arena of the children (m_branching slots per position) */
+    std::vector<int> m_order; /*!< the indexes of the children, sorted by the selection */
+    std::vector<Step> m_history; /*!< the moves of all the positions kept so far */
+    std::vector<unsigned int> m_remap; /*!< scratch buffer of the compaction of the history */
+
+    std::atomic<int> m_nextChunk; /*!< the next chunk of the beam to be expanded (shared by the threads) */
+    std::atomic<long long> m_expanded; /*!< the number of the positions played */
+    double m_elapsed; /*!< the duration of the search */
+
+    unsigned int m_bestStep; /*!< the last entry of the history of the best finished run */
+    int m_bestScore; /*!< the score of the best finished run */
+
+    std::vector<Board::Move> m_moves; /*!< the best sequence of moves */
+    int m_score; /*!< the score of the best sequence */
+};
+
+#endif // BEAMSOLVER_HPP
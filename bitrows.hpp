@@ -0,0 +1,147 @@
+/*!
+  * @file bitrows.hpp
+  * This file contains the declaration and the implementation of the class BitRows.
+  */
+#ifndef BITROWS_HPP
+#define BITROWS_HPP
+
+#include <stdint.h>
+#include "board.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*! This class holds the empty cells and the balls of a board as bit rows: the bit c of a row is
+  * the column c. The regions of empty cells are grown a whole row at a time (see flood()), which
+  * is much cheaper than labelling them cell by cell (Board::labelRegions()).
+  */
+class BitRows
+{
+public:
+    /*! Loads the cells of a board.
+      * @param[in] board the board
+      */
+    inline explicit BitRows(const Board &board)
+    {
+        int n = board.dim();
+        uint16_t width = uint16_t((1u << n) - 1);
+
+        m_dimension = n;
+        for (int r = 0; r < n; ++r) {
+            uint16_t empty = uint16_t(rowOf(board, r, Board::Empty) & width);
+            m_empty[r] = empty;
+            m_balls[r] = uint16_t(~empty & width);
+        }
+    }
+
+    /*!
+      * @param[in] board the board
+      * @param[in] r the row
+      * @param[in] cell the content looked for
+      * @return the bits of the columns of the row that hold the given content (beyond the dimension
+      * of the board included: the caller masks them)
+      */
+    static inline uint16_t rowOf(const Board &board, int r, Board::Cell cell)
+    {
+        const Board::Cell *row = board.cells() + Board::index(r, 0);
+#if defined(__SSE2__)
+        __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+        return uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(cells, _mm_set1_epi8(char(cell)))));
+#else
+        uint16_t bits = 0;
+        for (int c = 0; c < Board::Stride; ++c) {
+            bits |= uint16_t((row[c] == cell) << c);
+        }
+        return bits;
+#endif
+    }
+
+    /*!
+      * @param[in] set the rows of a set of cells
+      * @param[in] r the row
+      * @param[in] n the dimension of the board
+      * @return the cells of the row next to the cells of the set (the set itself is not excluded)
+      */
+    static inline uint16_t neighbours(const uint16_t *set, int r, int n)
+    {
+        uint16_t result = uint16_t((set[r] << 1) | (set[r] >> 1));
+        if (r > 0) {
+            result |= set[r - 1];
+        }
+        if (r < n - 1) {
+            result |= set[r + 1];
+        }
+        return result;
+    }
+
+    /*!
+      * @param[in] run the cells the bits may spread over
+      * @param[in] bits the bits to be spread (a subset of run)
+      * @return the runs of consecutive cells of run that hold a bit
+      */
+    static inline uint16_t spread(uint16_t run, uint16_t bits)
+    {
+        // an occluded fill: the bits move by 1, 2, 4 then 8 columns over the runs of as many cells
+        uint16_t left = run;
+        uint16_t right = run;
+        uint16_t up = bits;
+        uint16_t down = bits;
+        for (int shift = 1; shift < 16; shift <<= 1) {
+            up = uint16_t(up | (left & (up << shift)));
+            down = uint16_t(down | (right & (down >> shift)));
+            left = uint16_t(left & (left << shift));
+            right = uint16_t(right & (right >> shift));
+        }
+        return uint16_t(up | down);
+    }
+
+    /*! Grows a set of empty cells to the whole regions of empty cells that contain it.
+      * A pass spreads the set over the runs of the rows, downward then upward, so it takes
+      * one pass per turn of a region back up or down.
+      * @param[in,out] set the rows of the set
+      */
+    inline void flood(uint16_t *set) const
+    {
+        int n = m_dimension;
+        bool changed = true;
+
+        while (changed) {
+            changed = false;
+            for (int r = 0; r < n; ++r) {
+                changed = grow(set, r) || changed;
+            }
+            for (int r = n - 2; r >= 0; --r) {
+                changed = grow(set, r) || changed;
+            }
+        }
+    }
+
+    uint16_t m_empty[Board::MaxDimension]; /*!< the empty cells */
+    uint16_t m_balls[Board::MaxDimension]; /*!< the cells that hold a ball */
+    int m_dimension; /*!< the dimension of the board */
+
+private:
+    // Grows a row of the set from the rows next to it; returns true if it changed.
+    inline bool grow(uint16_t *set, int r) const
+    {
+        int n = m_dimension;
+        uint16_t seeds = set[r];
+        if (r > 0) {
+            seeds |= set[r - 1];
+        }
+        if (r < n - 1) {
+            seeds |= set[r + 1];
+        }
+
+        uint16_t grown = spread(m_empty[r], uint16_t(seeds & m_empty[r]));
+        if (grown == set[r]) {
+            return false;
+        }
+
+        set[r] = grown;
+        return true;
+    }
+};
+
+#endif // BITROWS_HPP
@@ -0,0 +1,488 @@
+/*!
+  * @file board.cpp
+  * This file contains the definition of the class Board.
+  */
+
+#include <string.h>
+#include "board.hpp"
+
+namespace
+{
+    // the directions the lines are searched on: W-E, N-S, NW-SE, SW-NE
+    const int s_lineDirs[4][2] = { {0, 1}, {1, 0}, {1, 1}, {-1, 1} };
+
+    // finds the root of a label (with path halving)
+    inline int findRoot(unsigned char *parent, int label)
+    {
+        while (parent[label] != label) {
+            parent[label] = parent[parent[label]];
+            label = parent[label];
+        }
+
+        return label;
+    }
+}
+
+/*!
+  */
+Board::Board(int dimension)
+    : m_dimension(dimension)
+{
+    if ((m_dimension < LineLength) || (m_dimension > MaxDimension)) {
+        m_dimension = 9;
+    }
+
+    reset();
+}
+
+/*!
+  */
+void Board::reset()
+{
+    memset(m_cells, Empty, sizeof(m_cells));
+    m_hintCount = 0;
+    m_freeCount = size();
+    m_score = 0;
+}
+
+/*!
+  */
+void Board::addHint(int index, Cell color)
+{
+    if (m_hintCount < HintCount) {
+        m_hintCells[m_hintCount] = (unsigned char)index;
+        m_hintColors[m_hintCount] = color;
+        ++m_hintCount;
+    }
+}
+
+/*!
+  */
+bool Board::isHintCell(int index) const
+{
+    for (int i = 0; i < m_hintCount; ++i) {
+        if (m_hintCells[i] == index) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+  * Two passes labelling: the first pass gives every empty cell the label of its left or upper
+  * neighbour and merges (union-find) the labels that meet, the second one numbers the regions
+  * in the order of their first cell.
+  */
+int Board::labelRegions(unsigned char *labels) const
+{
+    memset(labels, NoRegion, MaxCells);
+
+    unsigned char parent[MaxCells];
+    int provisional = 0;
+
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            int p = index(r, c);
+            if (m_cells[p] != Empty) {
+                continue;
+            }
+
+            int left = (c > 0) ? labels[p - 1] : int(NoRegion);
+            int up = (r > 0) ? labels[p - Stride] : int(NoRegion);
+
+            if ((left == NoRegion) && (up == NoRegion)) {
+                parent[provisional] = (unsigned char)provisional;
+                labels[p] = (unsigned char)provisional++;
+            } else if (up == NoRegion) {
+                labels[p] = (unsigned char)left;
+            } else if (left == NoRegion) {
+                labels[p] = (unsigned char)up;
+            } else {
+                int a = findRoot(parent, left);
+                int b = findRoot(parent, up);
+                if (a < b) {
+                    parent[b] = (unsigned char)a;
+                } else {
+                    parent[a] = (unsigned char)b;
+                }
+                labels[p] = (unsigned char)((a < b) ? a : b);
+            }
+        }
+    }
+
+    unsigned char numbers[MaxCells];
+    int regions = 0;
+    for (int i = 0; i < provisional; ++i) {
+        int root = findRoot(parent, i);
+        numbers[i] = (root == i) ? (unsigned char)regions++ : numbers[root];
+    }
+
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            int p = index(r, c);
+            if (labels[p] != NoRegion) {
+                labels[p] = numbers[labels[p]];
+            }
+        }
+    }
+
+    return regions;
+}
+
+/*!
+  */
+int Board::legalMoves(Move *moves) const
+{
+    unsigned char labels[MaxCells];
+    int regions = labelRegions(labels);
+    if (0 == regions) {
+        return 0;
+    }
+
+    // groups the empty cells by region (counting sort)
+    int first[MaxCells / 2 + 2];
+    unsigned char members[MaxCells];
+
+    memset(first, 0, sizeof(int) * (regions + 1));
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            unsigned char label = labels[index(r, c)];
+            if (label != NoRegion) {
+                ++first[label + 1];
+            }
+        }
+    }
+
+    for (int i = 0; i < regions; ++i) {
+        first[i + 1] += first[i];
+    }
+
+    int fill[MaxCells / 2 + 1];
+    memcpy(fill, first, sizeof(int) * regions);
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            int p = index(r, c);
+            if (labels[p] != NoRegion) {
+                members[fill[labels[p]]++] = (unsigned char)p;
+            }
+        }
+    }
+
+    // every ball may go anywhere inside the regions it touches
+    int count = 0;
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            int p = index(r, c);
+            if (m_cells[p] == Empty) {
+                continue;
+            }
+
+            int touched[4];
+            int n = 0;
+
+            int neighbours[4];
+            int nn = 0;
+            if (c > 0) neighbours[nn++] = p - 1;
+            if (c < m_dimension - 1) neighbours[nn++] = p + 1;
+            if (r > 0) neighbours[nn++] = p - Stride;
+            if (r < m_dimension - 1) neighbours[nn++] = p + Stride;
+
+            for (int i = 0; i < nn; ++i) {
+                int label = labels[neighbours[i]];
+                if (label == NoRegion) {
+                    continue;
+                }
+
+                bool seen = false;
+                for (int j = 0; j < n; ++j) {
+                    seen = seen || (touched[j] == label);
+                }
+
+                if (!seen) {
+                    touched[n++] = label;
+                }
+            }
+
+            for (int i = 0; i < n; ++i) {
+                for (int k = first[touched[i]]; k < first[touched[i] + 1]; ++k) {
+                    moves[count++] = Move(p, members[k]);
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+/*!
+  */
+bool Board::canMove(const Move &move) const
+{
+    int from = move.m_from;
+    int to = move.m_to;
+
+    if (!isValidPosition(row(from), column(from)) || !isValidPosition(row(to), column(to)) ||
+        (m_cells[from] == Empty) || (m_cells[to] != Empty)) {
+        return false;
+    }
+
+    unsigned char labels[MaxCells];
+    labelRegions(labels);
+
+    int r = row(from);
+    int c = column(from);
+
+    return ((c > 0) && (labels[from - 1] == labels[to])) ||
+           ((c < m_dimension - 1) && (labels[from + 1] == labels[to])) ||
+           ((r > 0) && (labels[from - Stride] == labels[to])) ||
+           ((r < m_dimension - 1) && (labels[from + Stride] == labels[to]));
+}
+
+/*!
+  */
+int Board::lineLengths(const Move &move, int *lengths) const
+{
+    Cell color = m_cells[move.m_from];
+    int r0 = row(move.m_to);
+    int c0 = column(move.m_to);
+    int best = 0;
+
+    for (int d = 0; d < 4; ++d) {
+        int length = 1;
+        for (int sign = -1; sign <= 1; sign += 2) {
+            int dr = sign * s_lineDirs[d][0];
+            int dc = sign * s_lineDirs[d][1];
+            int r = r0 + dr;
+            int c = c0 + dc;
+            while (isValidPosition(r, c) && (index(r, c) != move.m_from) && (cell(r, c) == color)) {
+                ++length;
+                r += dr;
+                c += dc;
+            }
+        }
+
+        if (lengths) {
+            lengths[d] = length;
+        }
+
+        if (length > best) {
+            best = length;
+        }
+    }
+
+    return best;
+}
+
+/*!
+  */
+int Board::applyMove(const Move &move)
+{
+    Cell color = m_cells[move.m_from];
+
+    setCell(move.m_from, Empty);
+    setCell(move.m_to, color);
+
+    // the ball was moved onto a 'hint' ball (see GridItem::moveBall()): the hint is dropped
+    for (int i = 0; i < m_hintCount; ++i) {
+        if (m_hintCells[i] == move.m_to) {
+            --m_hintCount;
+            m_hintCells[i] = m_hintCells[m_hintCount];
+            m_hintColors[i] = m_hintColors[m_hintCount];
+            break;
+        }
+    }
+
+    int to = move.m_to;
+    return removeLines(&to, 1);
+}
+
+/*!
+  */
+int Board::spawn(Random &rng, bool enforceHints)
+{
+    if (isGameOver()) {
+        return 0;
+    }
+
+    int spawned[HintCount];
+    int n = placeSpawn(rng, enforceHints, spawned);
+
+    drawHints(rng);
+
+    return removeLines(spawned, n);
+}
+
+/*!
+  */
+int Board::placeSpawn(Random &rng, bool enforceHints, int *spawned)
+{
+    if (enforceHints) {
+        m_hintCount = 0;
+    }
+
+    int n = 0;
+
+    if (0 == m_hintCount) {
+        // there is no 'hint' ball: a new set of balls is generated
+        for (int i = 0; (i < HintCount) && !isGameOver(); ++i) {
+            int p = randomFreeCell(rng);
+            setCell(p, Cell(1 + rng.below(Colors)));
+            spawned[n++] = p;
+        }
+    } else {
+        // the 'hint' balls become normal balls
+        for (int i = 0; i < m_hintCount; ++i) {
+            int p = m_hintCells[i];
+            if (m_cells[p] == Empty) {
+                setCell(p, m_hintColors[i]);
+                spawned[n++] = p;
+            }
+        }
+        m_hintCount = 0;
+    }
+
+    return n;
+}
+
+/*!
+  */
+void Board::drawHints(Random &rng)
+{
+    m_hintCount = 0;
+
+    for (int i = 0; i < HintCount; ++i) {
+        int p = randomFreeCell(rng);
+        if (p < 0) {
+            break;
+        }
+
+        addHint(p, Cell(1 + rng.below(Colors)));
+    }
+}
+
+/*!
+  */
+int Board::play(const Move &move, Random &rng)
+{
+    bool enforceHints = isHintCell(move.m_to);
+
+    int points = applyMove(move);
+    if (!isGameOver()) {
+        points += spawn(rng, enforceHints);
+    }
+
+    return points;
+}
+
+/*!
+  */
+int Board::removeLines(const int *indexes, int count)
+{
+    bool marked[MaxCells];
+    int positions[MaxCells];
+    int n = 0;
+
+    memset(marked, 0, sizeof(marked));
+
+    for (int i = 0; i < count; ++i) {
+        int p = indexes[i];
+        Cell color = m_cells[p];
+        if (color == Empty) {
+            continue;
+        }
+
+        for (int d = 0; d < 4; ++d) {
+            int dr = s_lineDirs[d][0];
+            int dc = s_lineDirs[d][1];
+
+            // walks backward to the first ball of the line
+            int r = row(p);
+            int c = column(p);
+            while (isValidPosition(r - dr, c - dc) && (cell(r - dr, c - dc) == color)) {
+                r -= dr;
+                c -= dc;
+            }
+
+            int length = 0;
+            int rr = r;
+            int cc = c;
+            while (isValidPosition(rr, cc) && (cell(rr, cc) == color)) {
+                ++length;
+                rr += dr;
+                cc += dc;
+            }
+
+            if (length < LineLength) {
+                continue;
+            }
+
+            for (int k = 0; k < length; ++k) {
+                int q = index(r + k * dr, c + k * dc);
+                if (!marked[q]) {
+                    marked[q] = true;
+                    positions[n++] = q;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        setCell(positions[i], Empty);
+    }
+
+    int points = lineScore(n);
+    m_score += points;
+
+    return points;
+}
+
+/*!
+  * The rows are hashed eight cells at a time; the cells beyond the dimension are always empty.
+  */
+uint64_t Board::hash() const
+{
+    uint64_t h = uint64_t(m_dimension);
+
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; c += 8) {
+            uint64_t word;
+            memcpy(&word, m_cells + index(r, c), sizeof(word));
+            h = Random::mix(h ^ word);
+        }
+    }
+
+    for (int i = 0; i < m_hintCount; ++i) {
+        h = Random::mix(h ^ (uint64_t(m_hintCells[i]) << 8) ^ uint64_t(m_hintColors[i]) ^ 0x10000ULL);
+    }
+
+    return h;
+}
+
+/*!
+  */
+int Board::randomFreeCell(Random &rng) const
+{
+    int candidates = m_freeCount;
+    for (int i = 0; i < m_hintCount; ++i) {
+        if (m_cells[m_hintCells[i]] == Empty) {
+            --candidates;
+        }
+    }
+
+    if (candidates <= 0) {
+        return -1;
+    }
+
+    int k = rng.below(candidates);
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            int p = index(r, c);
+            if ((m_cells[p] == Empty) && !isHintCell(p) && (k-- == 0)) {
+                return p;
+            }
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,370 @@
+/*!
+  * @file board.hpp
+  * This file contains the declaration of the class Board.
+  */
+#ifndef BOARD_HPP
+#define BOARD_HPP
+
+#include "random.hpp"
+
+/*! This class implements a headless board: a compact byte-per-cell copy of the game state
+  * together with the rules of the game (moving a ball, removing the lines and spawning
+  * the next balls). It does not depend on Qt, so it can be copied, evaluated and played
+  * by the bots on any thread.
+  *
+  * The cells are laid out row by row with a fixed stride of \a Stride bytes, that is one
+  * row of the board fits into a SSE2 register; the cells beyond the dimension of the board
+  * are always empty. A cell stores 0 if it is empty or the index of the color + 1 otherwise.
+  * The 'hint' balls do not occupy their cells (as in GridItem::isFreePos()), they are
+  * kept aside in a separate list.
+  */
+class Board
+{
+public:
+    typedef unsigned char Cell;
+
+    enum
+    {
+        MaxDimension = 16, // the maximum dimension of a board
+        Stride = 16,       // the distance between two rows in the array of the cells
+        MaxCells = MaxDimension * Stride,
+        Colors = 5,        // the number of colors of the balls
+        LineLength = 5,    // the minimum length of a line to be removed
+        HintCount = 3,     // the number of balls spawned after each move
+        Empty = 0,         // the value of an empty cell
+        NoRegion = 0xFF,   // the region label of an occupied cell
+        MaxMoves = (MaxCells / 2) * (MaxCells / 2) // upper bound of the number of the legal moves
+    };
+
+    /*! \brief A move of a ball between two cells; the cells are given as indexes in the array of the cells.
+      */
+    struct Move
+    {
+        Move() : m_from(0), m_to(0)
+        {
+        }
+
+        Move(int from, int to) : m_from((unsigned char)from), m_to((unsigned char)to)
+        {
+        }
+
+        inline bool operator ==(const Move &move) const
+        {
+            return (m_from == move.m_from) && (m_to == move.m_to);
+        }
+
+        inline bool operator !=(const Move &move) const
+        {
+            return !(*this == move);
+        }
+
+        unsigned char m_from; /*!< the index of the cell the ball is moved from */
+        unsigned char m_to; /*!< the index of the cell the ball is moved to */
+    };
+
+    /*! The constructor. Builds an empty board.
+      * @param[in] dimension the dimension of the board (rows x columns)
+      */
+    explicit Board(int dimension = 9);
+
+    /*! Removes all the balls and the hints and resets the score.
+      */
+    void reset();
+
+    /*!
+      * @return the dimension of the board
+      */
+    inline int dim() const
+    {
+        return m_dimension;
+    }
+
+    /*!
+      * @return the total number of the cells: dim() * dim()
+      */
+    inline int size() const
+    {
+        return m_dimension * m_dimension;
+    }
+
+    /*! Converts a (row, column) coordinate into an index in the array of the cells.
+      * \sa row(), column()
+      */
+    static inline int index(int row, int col)
+    {
+        return row * Stride + col;
+    }
+
+    /*! \sa index(), column()
+      */
+    static inline int row(int index)
+    {
+        return index / Stride;
+    }
+
+    /*! \sa index(), row()
+      */
+    static inline int column(int index)
+    {
+        return index % Stride;
+    }
+
+    /*!
+      * @return true if the coordinates are inside the board
+      */
+    inline bool isValidPosition(int row, int col) const
+    {
+        return (row >= 0) && (row < m_dimension) && (col >= 0) && (col < m_dimension);
+    }
+
+    /*!
+      * @param[in] index the index of the cell
+      * @return the content of the cell: 0 if it is empty, the index of the color + 1 otherwise
+      */
+    inline Cell cell(int index) const
+    {
+        return m_cells[index];
+    }
+
+    /*! \sa cell(int)
+      */
+    inline Cell cell(int row, int col) const
+    {
+        return m_cells[index(row, col)];
+    }
+
+    /*! Puts a ball into a cell or empties a cell and keeps the count of the free cells up to date.
+      * @param[in] index the index of the cell
+      * @param[in] value 0 to empty the cell, the index of the color + 1 to put a ball
+      */
+    inline void setCell(int index, Cell value)
+    {
+        m_freeCount += (m_cells[index] != Empty) - (value != Empty);
+        m_cells[index] = value;
+    }
+
+    /*!
+      * @return the array of the cells (MaxCells bytes, row by row with the stride \a Stride)
+      */
+    inline const Cell *cells() const
+    {
+        return m_cells;
+    }
+
+    /*!
+      * @return the number of the empty cells
+      */
+    inline int freeCount() const
+    {
+        return m_freeCount;
+    }
+
+    /*!
+      * @return true if there is no more empty cell on the board
+      */
+    inline bool isGameOver() const
+    {
+        return m_freeCount == 0;
+    }
+
+    /*!
+      * @return the score accumulated by the moves played on this board
+      */
+    inline int score() const
+    {
+        return m_score;
+    }
+
+    /*! Sets the score (used when the board is copied from the GUI).
+      */
+    inline void setScore(int score)
+    {
+        m_score = score;
+    }
+
+    /*!
+      * @return the number of the 'hint' balls
+      */
+    inline int hintCount() const
+    {
+        return m_hintCount;
+    }
+
+    /*!
+      * @param[in] i the index of the hint (0 <= i < hintCount())
+      * @return the index of the cell of the hint
+      */
+    inline int hintCell(int i) const
+    {
+        return m_hintCells[i];
+    }
+
+    /*!
+      * @param[in] i the index of the hint (0 <= i < hintCount())
+      * @return the color of the hint (the index of the color + 1)
+      */
+    inline Cell hintColor(int i) const
+    {
+        return m_hintColors[i];
+    }
+
+    /*!
+      * @return the array of the cells of the 'hint' balls (hintCount() bytes)
+      */
+    inline const unsigned char *hintCells() const
+    {
+        return m_hintCells;
+    }
+
+    /*!
+      * @return the array of the colors of the 'hint' balls (hintCount() bytes)
+      */
+    inline const Cell *hintColors() const
+    {
+        return m_hintColors;
+    }
+
+    /*! Appends a 'hint' ball.
+      * @param[in] index the index of the cell
+      * @param[in] color the index of the color + 1
+      */
+    void addHint(int index, Cell color);
+
+    /*! Removes all the 'hint' balls.
+      */
+    inline void clearHints()
+    {
+        m_hintCount = 0;
+    }
+
+    /*!
+      * @return true if a 'hint' ball is shown in the given cell
+      */
+    bool isHintCell(int index) const;
+
+    /*! Labels the connected regions (4-neighbourhood) of the empty cells.
+      *
+      * @param[out] labels an array of MaxCells bytes; receives the label of the region of every
+      * empty cell and NoRegion for the occupied cells
+      * @return the number of the regions
+      */
+    int labelRegions(unsigned char *labels) const;
+
+    /*! Enumerates all the legal moves: every ball may be moved onto every empty cell of the regions
+      * that touch it.
+      *
+      * @param[out] moves an array of at least MaxMoves elements
+      * @return the number of the legal moves
+      */
+    int legalMoves(Move *moves) const;
+
+    /*!
+      * @return true if the ball from the cell 'from' can be moved onto the cell 'to'
+      */
+    bool canMove(const Move &move) const;
+
+    /*! Measures the lines of the color of a ball that would pass through its target if the ball was moved.
+      * The board is not changed.
+      *
+      * @param[in] move the move
+      * @param[out] lengths if not null, receives the lengths of the lines in the four directions
+      * (W-E, N-S, NW-SE, SW-NE)
+      * @return the length of the longest line
+      */
+    int lineLengths(const Move &move, int *lengths = 0) const;
+
+    /*! A cheap rank of a move used to pick the promising moves before they are played: the longest
+      * line the move makes first, then the sum of the lines in the four directions.
+      *
+      * @param[in] move the move
+      * @return the rank of the move (the greater, the more promising)
+      */
+    inline int moveRank(const Move &move) const
+    {
+        int lengths[4];
+        int longest = lineLengths(move, lengths);
+        return longest * 64 + lengths[0] + lengths[1] + lengths[2] + lengths[3];
+    }
+
+    /*! Moves a ball and removes the lines formed by it.
+      * The move has to be a legal one; the next balls are not spawned.
+      *
+      * @param[in] move the move
+      * @return the points scored by the move
+      */
+    int applyMove(const Move &move);
+
+    /*! Spawns the next balls after a move (see GameEngine): the 'hint' balls
+      * become normal balls (or, if enforceHints is true, they are dropped and replaced by
+      * three random balls), then a new set of 'hint' balls is drawn and finally the lines formed
+      * by the spawned balls are removed.
+      *
+      * @param[in] rng the random numbers generator
+      * @param[in] enforceHints true if a ball was moved onto a 'hint' ball
+      * @return the points scored by the spawned balls
+      */
+    int spawn(Random &rng, bool enforceHints = false);
+
+    /*! The first step of spawn(): puts the 'hint' balls on the board or, if there is no hint
+      * (or enforceHints is true), three random balls. The lines are not removed.
+      * If there are 'hint' balls and enforceHints is false the step is deterministic.
+      *
+      * @param[in] rng the random numbers generator
+      * @param[in] enforceHints true if a ball was moved onto a 'hint' ball
+      * @param[out] spawned receives the cells of the spawned balls (at least HintCount elements)
+      * @return the number of the spawned balls
+      */
+    int placeSpawn(Random &rng, bool enforceHints, int *spawned);
+
+    /*! The second step of spawn(): draws a new set of 'hint' balls onto random empty cells.
+      * @param[in] rng the random numbers generator
+      */
+    void drawHints(Random &rng);
+
+    /*! Plays a whole turn as the GameEngine does: moves the ball,
+      * removes its lines and spawns the next balls if there is still room on the board.
+      *
+      * @param[in] move the move
+      * @param[in] rng the random numbers generator
+      * @return the points scored during the turn
+      */
+    int play(const Move &move, Random &rng);
+
+    /*! Removes the lines of the balls having the same color that pass through the given cells.
+      * The score is (n - 1) * 150 for n removed balls (see lineScore()).
+      *
+      * @param[in] indexes the cells to be checked
+      * @param[in] count the number of the cells
+      * @return the points scored
+      */
+    int removeLines(const int *indexes, int count);
+
+    /*!
+      * @return the points scored for removing n balls at once
+      */
+    static inline int lineScore(int n)
+    {
+        return (n > 0) ? (n - 1) * 150 : 0;
+    }
+
+    /*!
+      * @return a 64 bits hash of the cells and of the 'hint' balls (the score is not hashed)
+      */
+    uint64_t hash() const;
+
+    /*! Picks a random empty cell.
+      * @return the index of the cell or -1 if the board is full
+      */
+    int randomFreeCell(Random &rng) const;
+
+private:
+    Cell m_cells[MaxCells]; /*!< the cells of the board */
+    unsigned char m_hintCells[HintCount]; /*!< the cells of the 'hint' balls */
+    Cell m_hintColors[HintCount]; /*!< the colors of the 'hint' balls */
+    int m_hintCount; /*!< the number of the 'hint' balls */
+    int m_dimension; /*!< the dimension of the board */
+    int m_freeCount; /*!< the number of the empty cells */
+    int m_score; /*!< the score */
+};
+
+#endif // BOARD_HPP
@@ -4,6 +4,7 @@
   */
 
 #include <QGraphicsScene>
+#include <QtCore/QTimer>
 #include "boardview.hpp"
 #include "ballitem.hpp"
 #include "ballitemsprovider.hpp"
@@ -20,21 +21,20 @@ BoardView::BoardView(QWidget *parent)
 
     setMouseTracking(true);
     setRenderHint(QPainter::Antialiasing);
-    setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
+    // the repaints are limited to the squares that changed (see GridItem::flushDirtyRegion())
+    setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
 
     setBackgroundBrush(QColor(230, 200, 167));
 
-    if (isRunningOnDesktop()) {
-        // run on PC desktop.
-        m_scene = new QGraphicsScene(-225, -225, 450, 450);
-    } else {
-        // run on a phone/mobile device.
-        m_scene = new QGraphicsScene(-90, -90, 180, 180);
-    }
+    // the squares are larger on a PC desktop than on a phone/mobile device (see GridItem::squareSize())
+    m_grid = new GridItem(boardDimension());
+    int side = m_grid->dim() * m_grid->squareSize();
+
+    m_scene = new QGraphicsScene(-side/2, -side/2, side, side);
     setScene(m_scene);
 
-    m_grid = new GridItem(9);
     m_scene->addItem(m_grid);
+    connect(m_scene, SIGNAL(sceneRectChanged(QRectF)), this, SLOT(sceneRectChanged()));
 
     //
     PathFinder::instance()->init(m_grid->dim());
@@ -43,7 +43,22 @@ BoardView::BoardView(QWidget *parent)
     BallItemsProvider::instance()->init(m_grid);
     //
 
-    BallItemsProvider::instance()->nextBalls(true);
+    if (useBatchedRendering()) {
+        // the grid paints the balls itself: the scene keeps a handful of visible items and
+        // needs no index
+        m_scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+        m_grid->setRenderMode(GridItem::BatchedRendering);
+    }
+
+    m_grid->newGame();
+
+    // the events of the game engine are rendered once per frame; the timer runs only while there
+    // is something to render and is restarted by the player's actions
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(FrameInterval);
+    connect(m_frameTimer, SIGNAL(timeout()), this, SLOT(frame()));
+    requestFrame();
 }
 
 /*!
@@ -59,9 +74,81 @@ void BoardView::reset()
 {
     Q_ASSERT(m_grid != 0);
 
-    m_grid->reset();
+    m_grid->newGame();
     MainWidget::instance()->resetScore();
+    requestFrame();
+}
+
+/*!
+  */
+void BoardView::hint()
+{
+    Q_ASSERT(m_grid != 0);
+
+    m_grid->showSuggestedMove();
+    requestFrame();
+}
 
-    BallItemsProvider::instance()->reset();
-    BallItemsProvider::instance()->nextBalls(true);
+/*!
+  */
+void BoardView::setTurbo(bool flag)
+{
+    Q_ASSERT(m_grid != 0);
+
+    m_grid->setTurbo(flag);
+}
+
+/*!
+  */
+void BoardView::frame()
+{
+    m_grid->processEngineEvents();
+    m_grid->processHint();
+    m_grid->processHover();
+    m_grid->flushDirtyRegion();
+
+    // the CPU idles until the player acts again
+    if (m_grid->isIdle()) {
+        m_frameTimer->stop();
+    }
+}
+
+/*!
+  */
+void BoardView::requestFrame()
+{
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+}
+
+/*!
+  */
+void BoardView::mousePressEvent(QMouseEvent *event)
+{
+    QGraphicsView::mousePressEvent(event);
+    requestFrame();
+}
+
+/*!
+  */
+void BoardView::mouseReleaseEvent(QMouseEvent *event)
+{
+    QGraphicsView::mouseReleaseEvent(event);
+    requestFrame();
+}
+
+/*!
+  */
+void BoardView::mouseMoveEvent(QMouseEvent *event)
+{
+    QGraphicsView::mouseMoveEvent(event);
+    requestFrame();
+}
+
+/*!
+  */
+void BoardView::sceneRectChanged()
+{
+    m_grid->updateGeometry();
 }
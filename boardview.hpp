@@ -12,6 +12,8 @@
 
 // forward declarations
 class QGraphicsScene;
+class QTimer;
+class QMouseEvent;
 
 /*! This class implements view that owns the grid item where the ball items are to be rendered on.
   */
@@ -28,14 +30,65 @@ public:
       */
     ~BoardView();
 
+    /*!
+      * @return the grid item
+      */
+    inline GridItem *grid()
+    {
+        return m_grid;
+    }
+
 public Q_SLOTS:
     /*! Reinitializes the board : remove all the ball items and reset the internal structure.
       */
     void reset();
 
+    /*! Shows the move suggested by the background analysis (see GridItem::showSuggestedMove()).
+      */
+    void hint();
+
+    /*! Turns the turbo mode on or off (see GridItem::setTurbo()).
+      * @param[in] flag the turbo flag
+      */
+    void setTurbo(bool flag);
+
+private Q_SLOTS:
+    /*! Renders the events reported by the game engine since the last frame.
+      */
+    void frame();
+
+    /*! Updates the geometry of the grid after a change of the scene rect.
+      */
+    void sceneRectChanged();
+
 protected:
+    /*! Starts the frame timer if it is stopped.
+      */
+    void requestFrame();
+
+    /*! Forwards the mouse event to the scene and starts the frame timer.
+      * @param[in] event the mouse event
+      */
+    void mousePressEvent(QMouseEvent *event);
+
+    /*! Forwards the mouse event to the scene and starts the frame timer.
+      * @param[in] event the mouse event
+      */
+    void mouseReleaseEvent(QMouseEvent *event);
+
+    /*! Forwards the mouse event to the scene and starts the frame timer.
+      * @param[in] event the mouse event
+      */
+    void mouseMoveEvent(QMouseEvent *event);
+
+    enum
+    {
+        FrameInterval = 16 // the interval between two frames (ms)
+    };
+
     GridItem *m_grid; /*!< the grid item */
     QGraphicsScene *m_scene; /*!< the graphics scene */
+    QTimer *m_frameTimer; /*!< drains the events of the game engine; it is stopped while the grid is idle */
 };
 
 #endif // BOARDVIEW_HPP
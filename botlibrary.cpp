@@ -0,0 +1,135 @@
+/*!
+  * @file botlibrary.cpp
+  * This file contains the definition of the class BotLibrary.
+  */
+
+#include "botlibrary.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+//!
+BotLibrary::BotLibrary()
+    : m_handle(0),
+    m_create(0),
+    m_choose(0),
+    m_destroy(0)
+{
+}
+
+//!
+BotLibrary::~BotLibrary()
+{
+    unload();
+}
+
+//!
+bool BotLibrary::load(const std::string &path)
+{
+    unload();
+
+#if defined(_WIN32)
+    m_handle = reinterpret_cast<void*>(LoadLibraryA(path.c_str()));
+    if (!m_handle) {
+        m_error = "cannot load " + path;
+        return false;
+    }
+#else
+    m_handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!m_handle) {
+        const char *error = dlerror();
+        m_error = error ? error : "cannot load " + path;
+        return false;
+    }
+#endif
+
+    VersionFunction version = reinterpret_cast<VersionFunction>(symbol("lines_bot_abi_version"));
+    NameFunction name = reinterpret_cast<NameFunction>(symbol("lines_bot_name"));
+    m_create = reinterpret_cast<CreateFunction>(symbol("lines_bot_create"));
+    m_choose = reinterpret_cast<ChooseFunction>(symbol("lines_bot_choose"));
+    m_destroy = reinterpret_cast<DestroyFunction>(symbol("lines_bot_destroy"));
+
+    if (!version || !name || !m_create || !m_choose || !m_destroy) {
+        m_error = path + " is not a bot plugin";
+        unload();
+        return false;
+    }
+
+    if (version() != LINES_BOT_ABI_VERSION) {
+        m_error = path + " implements another version of the interface";
+        unload();
+        return false;
+    }
+
+    const char *botName = name();
+    m_name = botName ? botName : path;
+    m_error.clear();
+
+    return true;
+}
+
+//!
+void BotLibrary::unload()
+{
+    if (m_handle) {
+#if defined(_WIN32)
+        FreeLibrary(reinterpret_cast<HMODULE>(m_handle));
+#else
+        dlclose(m_handle);
+#endif
+    }
+
+    m_handle = 0;
+    m_create = 0;
+    m_choose = 0;
+    m_destroy = 0;
+    m_name.clear();
+}
+
+//!
+void *BotLibrary::symbol(const char *name) const
+{
+#if defined(_WIN32)
+    return reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(m_handle), name));
+#else
+    return dlsym(m_handle, name);
+#endif
+}
+
+/*!
+  * The move is checked against the rules, so that a faulty plugin cannot corrupt the game.
+  */
+bool BotLibrary::chooseMove(void *bot, const Board &board, Board::Move &move) const
+{
+    LinesBoardView boardView;
+    view(board, boardView);
+
+    LinesMove choice = { 0, 0 };
+    if (0 == m_choose(bot, &boardView, &choice)) {
+        return false;
+    }
+
+    if ((choice.from < 0) || (choice.from >= Board::MaxCells) || (choice.to < 0) || (choice.to >= Board::MaxCells)) {
+        return false;
+    }
+
+    move = Board::Move(choice.from, choice.to);
+    return board.canMove(move);
+}
+
+//!
+void BotLibrary::view(const Board &board, LinesBoardView &view)
+{
+    view.dimension = board.dim();
+    view.stride = Board::Stride;
+    view.colors = Board::Colors;
+    view.lineLength = Board::LineLength;
+    view.cells = board.cells();
+    view.hintCount = board.hintCount();
+    view.hintCells = board.hintCells();
+    view.hintColors = board.hintColors();
+    view.score = board.score();
+}
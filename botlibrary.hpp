@@ -0,0 +1,108 @@
+/*!
+  * @file botlibrary.hpp
+  * This file contains the declaration of the class BotLibrary.
+  */
+#ifndef BOTLIBRARY_HPP
+#define BOTLIBRARY_HPP
+
+#include <string>
+#include "board.hpp"
+#include "botplugin.h"
+
+/*! This class loads a bot plugin (a shared library implementing the interface of botplugin.h)
+  * and calls it on the positions of a Board.
+  *
+  * The board is handed to the plugin as a LinesBoardView pointing into the arrays of the Board,
+  * so a call costs an indirect call and nothing else.
+  */
+class BotLibrary
+{
+public:
+    /*! The constructor.
+      */
+    BotLibrary();
+
+    /*! The destructor; unloads the library.
+      */
+    ~BotLibrary();
+
+    /*! Loads a plugin.
+      * @param[in] path the path of the shared library
+      * @return false if the library cannot be loaded, misses a function or has another version of the interface
+      */
+    bool load(const std::string &path);
+
+    /*! Unloads the library (the instances of the bot must have been destroyed).
+      */
+    void unload();
+
+    /*!
+      * @return the last error of load()
+      */
+    inline const std::string &error() const
+    {
+        return m_error;
+    }
+
+    /*!
+      * @return the name of the bot
+      */
+    inline const std::string &name() const
+    {
+        return m_name;
+    }
+
+    /*! Creates an instance of the bot.
+      * @param[in] seed the seed of the instance
+      */
+    inline void *create(unsigned long long seed) const
+    {
+        return m_create(seed);
+    }
+
+    /*! Destroys an instance of the bot.
+      */
+    inline void destroy(void *bot) const
+    {
+        m_destroy(bot);
+    }
+
+    /*! Asks an instance of the bot for a move.
+      *
+      * @param[in] bot the instance
+      * @param[in] board the position
+      * @param[out] move receives the move
+      * @return false if the bot resigns or returns a move that is not legal
+      */
+    bool chooseMove(void *bot, const Board &board, Board::Move &move) const;
+
+    /*! Fills a view of a board (valid as long as the board is not changed).
+      */
+    static void view(const Board &board, LinesBoardView &view);
+
+private:
+    BotLibrary(const BotLibrary &);
+    BotLibrary &operator =(const BotLibrary &);
+
+    typedef int (*VersionFunction)(void);
+    typedef const char *(*NameFunction)(void);
+    typedef void *(*CreateFunction)(unsigned long long);
+    typedef int (*ChooseFunction)(void *, const LinesBoardView *, LinesMove *);
+    typedef void (*DestroyFunction)(void *);
+
+    /*!
+      * @return the address of an exported function or null
+      */
+    void *symbol(const char *name) const;
+
+private:
+    void *m_handle; /*!< the handle of the library */
+    std::string m_name; /*!< the name of the bot */
+    std::string m_error; /*!< the last error of load() */
+
+    CreateFunction m_create;
+    ChooseFunction m_choose;
+    DestroyFunction m_destroy;
+};
+
+#endif // BOTLIBRARY_HPP
@@ -0,0 +1,75 @@
+/*!
+  * @file botplugin.h
+  * This file contains the C interface of the bot plugins.
+  *
+  * A bot plugin is a shared library exporting the functions declared below. The host passes the
+  * position as a read-only view of its own arrays: nothing is copied or serialized, the pointers are
+  * valid during the call only and the bot must not write through them.
+  *
+  * The cells are numbered row * stride + column; a cell holds 0 if it is empty or the index of the
+  * color of its ball + 1. The 'hint' balls are the balls that will be spawned after the move (their
+  * cells are empty until then).
+  */
+#ifndef BOTPLUGIN_H
+#define BOTPLUGIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define LINES_BOT_EXPORT __declspec(dllexport)
+#else
+#define LINES_BOT_EXPORT __attribute__((visibility("default")))
+#endif
+
+/*! The version of the interface; the host refuses the plugins of another version. */
+#define LINES_BOT_ABI_VERSION 1
+
+/*! \brief A read-only view of a position. */
+typedef struct LinesBoardView
+{
+    int dimension;                   /*!< the number of the rows and of the columns */
+    int stride;                      /*!< the distance between two rows in the array of the cells */
+    int colors;                      /*!< the number of the colors of the balls */
+    int lineLength;                  /*!< the minimum length of a line to be removed */
+    const unsigned char *cells;      /*!< dimension rows of stride cells */
+    int hintCount;                   /*!< the number of the 'hint' balls */
+    const unsigned char *hintCells;  /*!< the cells of the 'hint' balls */
+    const unsigned char *hintColors; /*!< the colors of the 'hint' balls (the index of the color + 1) */
+    int score;                       /*!< the score of the game so far */
+} LinesBoardView;
+
+/*! \brief A move of a ball between two cells. */
+typedef struct LinesMove
+{
+    int from;
+    int to;
+} LinesMove;
+
+/*! @return LINES_BOT_ABI_VERSION */
+LINES_BOT_EXPORT int lines_bot_abi_version(void);
+
+/*! @return the name of the bot */
+LINES_BOT_EXPORT const char *lines_bot_name(void);
+
+/*! Creates an instance of the bot; an instance is used by one thread at a time.
+  * @param seed the seed of the random numbers of the instance
+  * @return the instance or a null pointer */
+LINES_BOT_EXPORT void *lines_bot_create(unsigned long long seed);
+
+/*! Chooses a move.
+  * @param bot the instance
+  * @param board the position (it has at least one legal move)
+  * @param move receives the move
+  * @return 0 if the bot resigns, any other value otherwise */
+LINES_BOT_EXPORT int lines_bot_choose(void *bot, const LinesBoardView *board, LinesMove *move);
+
+/*! Destroys an instance of the bot. */
+LINES_BOT_EXPORT void lines_bot_destroy(void *bot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOTPLUGIN_H */
@@ -0,0 +1,376 @@
+/*!
+  * @file canonicalboard.cpp
+  * This file contains the definition of the class CanonicalBoard.
+  */
+
+#include <algorithm>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "canonicalboard.hpp"
+
+namespace
+{
+    enum
+    {
+        Planes = CanonicalBoard::CellBits,
+        Rows = Board::MaxDimension,
+        HintBits = 11, // the bits of a packed 'hint' ball: the cell (8 bits) then the color (3 bits)
+        TransposeBit = 4,
+        FlipRowsBit = 1,
+        FlipColumnsBit = 2
+    };
+
+    // the bit planes of a board: bit c of planes[k][r] is the bit k of the cell (r, c)
+    typedef uint16_t BitPlanes[Planes][Rows];
+
+    /*! \brief The lookup tables of the bit manipulations.
+      */
+    struct Tables
+    {
+        Tables()
+        {
+            for (int b = 0; b < 256; ++b) {
+                m_reverse[b] = 0;
+                m_spread[b] = 0;
+                for (int i = 0; i < 8; ++i) {
+                    if (b & (1 << i)) {
+                        m_reverse[b] |= (unsigned char)(0x80 >> i);
+                        m_spread[b] |= 1u << (Planes * i);
+                    }
+                }
+            }
+        }
+
+        unsigned char m_reverse[256]; /*!< the bits of a byte in reverse order */
+        uint32_t m_spread[256]; /*!< the bit i of a byte moved to the bit 3 * i */
+    };
+
+    const Tables s_tables;
+
+    inline uint16_t reverse16(uint16_t x)
+    {
+        return uint16_t((s_tables.m_reverse[x & 0xFF] << 8) | s_tables.m_reverse[x >> 8]);
+    }
+
+    inline uint64_t spread16(uint16_t x)
+    {
+        return uint64_t(s_tables.m_spread[x & 0xFF]) | (uint64_t(s_tables.m_spread[x >> 8]) << 24);
+    }
+
+    // splits the cells into bit planes: one byte mask per row and plane
+    void extractPlanes(const Board &board, BitPlanes &planes)
+    {
+        memset(planes, 0, sizeof(BitPlanes));
+
+        for (int r = 0; r < board.dim(); ++r) {
+            const Board::Cell *row = board.cells() + Board::index(r, 0);
+#if defined(__SSE2__)
+            __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+            planes[0][r] = uint16_t(_mm_movemask_epi8(_mm_slli_epi16(cells, 7)));
+            planes[1][r] = uint16_t(_mm_movemask_epi8(_mm_slli_epi16(cells, 6)));
+            planes[2][r] = uint16_t(_mm_movemask_epi8(_mm_slli_epi16(cells, 5)));
+#else
+            for (int c = 0; c < board.dim(); ++c) {
+                for (int k = 0; k < Planes; ++k) {
+                    planes[k][r] |= uint16_t(((row[c] >> k) & 1) << c);
+                }
+            }
+#endif
+        }
+    }
+
+    // transposes a 16 x 16 bits matrix by swapping blocks of 8, 4, 2 and 1 bits
+    void transpose(uint16_t *rows)
+    {
+        uint16_t mask = 0x00FF;
+        for (int j = 8; j != 0; j >>= 1, mask = uint16_t(mask ^ (mask << j))) {
+            for (int k = 0; k < Rows; k = ((k | j) + 1) & ~j) {
+                uint16_t t = uint16_t(((rows[k] >> j) ^ rows[k | j]) & mask);
+                rows[k] = uint16_t(rows[k] ^ (t << j));
+                rows[k | j] = uint16_t(rows[k | j] ^ t);
+            }
+        }
+    }
+
+    // interleaves three 16 bits planes rows into a row of 3 bits cells (the bit c of the planes
+    // gives the cell at the bits 3 * c to 3 * c + 2)
+    inline uint64_t interleave(uint16_t p0, uint16_t p1, uint16_t p2)
+    {
+        return spread16(p0) | (spread16(p1) << 1) | (spread16(p2) << 2);
+    }
+
+    /*! \brief The packed rows of the transforms of a board.
+      *
+      * A packed row holds the first cell in its most significant bits. The rows of the 8 transforms
+      * are the rows of the board and of its transposition, packed with or without mirroring the
+      * columns, taken top-down or bottom-up.
+      */
+    struct PackedRows
+    {
+        explicit PackedRows(const Board &board)
+            : m_dimension(board.dim())
+        {
+            BitPlanes planes[2];
+            extractPlanes(board, planes[0]);
+
+            memcpy(planes[1], planes[0], sizeof(BitPlanes));
+            for (int k = 0; k < Planes; ++k) {
+                transpose(planes[1][k]);
+            }
+
+            int shift = Rows - m_dimension;
+            for (int o = 0; o < 2; ++o) {
+                const BitPlanes &p = planes[o];
+                for (int r = 0; r < m_dimension; ++r) {
+                    // the packing mirrors the columns, so the mirrored columns are packed from the plain bits
+                    m_rows[o][1][r] = interleave(p[0][r], p[1][r], p[2][r]);
+                    m_rows[o][0][r] = interleave(uint16_t(reverse16(p[0][r]) >> shift),
+                                                 uint16_t(reverse16(p[1][r]) >> shift),
+                                                 uint16_t(reverse16(p[2][r]) >> shift));
+                }
+            }
+        }
+
+        // the packed row i of a transform (see CanonicalBoard::transformCell())
+        inline uint64_t row(int transform, int i) const
+        {
+            int r = (transform & FlipRowsBit) ? m_dimension - 1 - i : i;
+            return m_rows[(transform & TransposeBit) ? 1 : 0][(transform & FlipColumnsBit) ? 1 : 0][r];
+        }
+
+        // compares the cells of two transforms
+        int compare(int a, int b) const
+        {
+            for (int i = 0; i < m_dimension; ++i) {
+                uint64_t x = row(a, i);
+                uint64_t y = row(b, i);
+                if (x != y) {
+                    return (x < y) ? -1 : 1;
+                }
+            }
+
+            return 0;
+        }
+
+        uint64_t m_rows[2][2][Rows]; /*!< [transposed][columns mirrored][row] */
+        int m_dimension;
+    };
+
+    // appends the 'width' low bits of a value to a stream of bits (the most significant bits first)
+    inline void appendBits(uint64_t *words, int &position, uint64_t value, int width)
+    {
+        int word = position >> 6;
+        int room = 64 - (position & 63);
+
+        if (width <= room) {
+            words[word] |= value << (room - width);
+        } else {
+            words[word] |= value >> (width - room);
+            words[word + 1] |= value << (64 - (width - room));
+        }
+
+        position += width;
+    }
+
+    // reads 'width' bits from a stream of bits
+    inline uint64_t readBits(const uint64_t *words, int &position, int width)
+    {
+        int word = position >> 6;
+        int room = 64 - (position & 63);
+        uint64_t mask = (uint64_t(1) << width) - 1;
+        uint64_t value;
+
+        if (width <= room) {
+            value = words[word] >> (room - width);
+        } else {
+            value = (words[word] << (width - room)) | (words[word + 1] >> (64 - (width - room)));
+        }
+
+        position += width;
+        return value & mask;
+    }
+
+    // packs the cells of a transform
+    void packRows(const PackedRows &rows, int transform, CanonicalBoard::Key &key)
+    {
+        memset(key.m_cells, 0, sizeof(key.m_cells));
+
+        int position = 0;
+        for (int i = 0; i < rows.m_dimension; ++i) {
+            appendBits(key.m_cells, position, rows.row(transform, i), Planes * rows.m_dimension);
+        }
+    }
+
+    // packs the sorted set of the transformed 'hint' balls
+    void packHints(const Board &board, int transform, CanonicalBoard::Key &key)
+    {
+        uint64_t hints[Board::HintCount];
+        int count = board.hintCount();
+
+        for (int i = 0; i < count; ++i) {
+            int cell = CanonicalBoard::transformCell(board.hintCell(i), transform, board.dim());
+            hints[i] = (uint64_t(cell) << Planes) | board.hintColor(i);
+        }
+
+        // sorts the (at most three) hints
+        for (int i = 1; i < count; ++i) {
+            for (int j = i; (j > 0) && (hints[j] < hints[j - 1]); --j) {
+                std::swap(hints[j], hints[j - 1]);
+            }
+        }
+
+        key.m_hints = 0;
+        for (int i = 0; i < count; ++i) {
+            key.m_hints = (key.m_hints << HintBits) | hints[i];
+        }
+
+        key.m_hints |= uint64_t(count) << (HintBits * Board::HintCount);
+    }
+}
+
+//!
+int CanonicalBoard::Key::compare(const Key &other) const
+{
+    for (int i = 0; i < KeyWords; ++i) {
+        if (m_cells[i] != other.m_cells[i]) {
+            return (m_cells[i] < other.m_cells[i]) ? -1 : 1;
+        }
+    }
+
+    if (m_hints != other.m_hints) {
+        return (m_hints < other.m_hints) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+//!
+uint64_t CanonicalBoard::Key::hash() const
+{
+    uint64_t h = Random::mix(m_hints);
+    for (int i = 0; i < KeyWords; ++i) {
+        h = Random::mix(h ^ m_cells[i]);
+    }
+
+    return h;
+}
+
+/*!
+  * The rows of the transforms are packed once and the transforms are compared row by row;
+  * the 'hint' balls are compared only when the cells are the same.
+  */
+CanonicalBoard::CanonicalBoard(const Board &board)
+    : m_transform(0),
+    m_dimension(board.dim())
+{
+    PackedRows rows(board);
+
+    for (int t = 1; t < Transforms; ++t) {
+        int order = rows.compare(t, m_transform);
+        if (0 == order) {
+            Key a;
+            Key b;
+            packHints(board, t, a);
+            packHints(board, m_transform, b);
+            order = (a.m_hints < b.m_hints) ? -1 : 0;
+        }
+
+        if (order < 0) {
+            m_transform = t;
+        }
+    }
+
+    packRows(rows, m_transform, m_key);
+    packHints(board, m_transform, m_key);
+}
+
+//!
+Board::Move CanonicalBoard::toCanonical(const Board::Move &move) const
+{
+    return Board::Move(transformCell(move.m_from, m_transform, m_dimension),
+                       transformCell(move.m_to, m_transform, m_dimension));
+}
+
+//!
+Board::Move CanonicalBoard::fromCanonical(const Board::Move &move) const
+{
+    return Board::Move(inverseCell(move.m_from, m_transform, m_dimension),
+                       inverseCell(move.m_to, m_transform, m_dimension));
+}
+
+//!
+void CanonicalBoard::pack(const Board &board, int transform, Key &key)
+{
+    PackedRows rows(board);
+
+    packRows(rows, transform, key);
+    packHints(board, transform, key);
+}
+
+//!
+Board CanonicalBoard::unpack(const Key &key, int dimension)
+{
+    Board board(dimension);
+
+    int position = 0;
+    for (int r = 0; r < board.dim(); ++r) {
+        for (int c = 0; c < board.dim(); ++c) {
+            board.setCell(Board::index(r, c), Board::Cell(readBits(key.m_cells, position, CellBits)));
+        }
+    }
+
+    int count = int(key.m_hints >> (HintBits * Board::HintCount));
+    for (int i = 0; i < count; ++i) {
+        uint64_t hint = (key.m_hints >> (HintBits * (count - 1 - i))) & ((1 << HintBits) - 1);
+        board.addHint(int(hint >> Planes), Board::Cell(hint & ((1 << Planes) - 1)));
+    }
+
+    return board;
+}
+
+/*!
+  * The transform is applied in this order: the transposition (bit 2), the mirroring of
+  * the rows (bit 0) and the mirroring of the columns (bit 1).
+  */
+int CanonicalBoard::transformCell(int index, int transform, int dimension)
+{
+    int r = Board::row(index);
+    int c = Board::column(index);
+
+    if (transform & TransposeBit) {
+        std::swap(r, c);
+    }
+
+    if (transform & FlipRowsBit) {
+        r = dimension - 1 - r;
+    }
+
+    if (transform & FlipColumnsBit) {
+        c = dimension - 1 - c;
+    }
+
+    return Board::index(r, c);
+}
+
+//!
+int CanonicalBoard::inverseCell(int index, int transform, int dimension)
+{
+    int r = Board::row(index);
+    int c = Board::column(index);
+
+    if (transform & FlipRowsBit) {
+        r = dimension - 1 - r;
+    }
+
+    if (transform & FlipColumnsBit) {
+        c = dimension - 1 - c;
+    }
+
+    if (transform & TransposeBit) {
+        std::swap(r, c);
+    }
+
+    return Board::index(r, c);
+}
@@ -0,0 +1,130 @@
+/*!
+  * @file canonicalboard.hpp
+  * This file contains the declaration of the class CanonicalBoard.
+  */
+#ifndef CANONICALBOARD_HPP
+#define CANONICALBOARD_HPP
+
+#include "board.hpp"
+
+/*! This class computes the canonical form of a position with respect to the symmetries of the square.
+  *
+  * The 8 rotations and reflections of a board (the dihedral group) give positions of the same value:
+  * the windows of the evaluation and the lines of the rules (W-E, N-S, NW-SE, SW-NE) are mapped onto
+  * each other. A position is packed into a fixed width key (3 bits per cell, row by row, the first
+  * cell in the most significant bits, followed by the sorted set of the 'hint' balls) and its
+  * canonical form is the transform giving the smallest key.
+  *
+  * The transforms do not walk the cells: the board is split into three bit planes of 16 bits rows
+  * (one SSE2 mask per row and plane), the planes are transposed and mirrored with bit-parallel
+  * operations and the rows are interleaved back into 3 bits cells through lookup tables.
+  *
+  * The moves are mapped between the frame of the original board and the canonical frame by
+  * toCanonical() and fromCanonical(). Note that a seeded run is not symmetric (the spawned balls
+  * are placed by the scan order of the cells), so the canonical form only fits the values that
+  * are expectations over the spawns.
+  */
+class CanonicalBoard
+{
+public:
+    enum
+    {
+        Transforms = 8, // the number of the symmetries of the square
+        CellBits = 3,   // the number of the bits of a packed cell
+        KeyWords = (Board::MaxCells * CellBits + 63) / 64
+    };
+
+    /*! \brief A packed position.
+      */
+    struct Key
+    {
+        uint64_t m_cells[KeyWords]; /*!< the cells, 3 bits per cell, row by row */
+        uint64_t m_hints; /*!< the sorted 'hint' balls, 11 bits each (the cell then the color) and their count */
+
+        /*!
+          * @return a negative value, 0 or a positive value if this key is less, equal or greater than the other one
+          */
+        int compare(const Key &other) const;
+
+        inline bool operator <(const Key &other) const
+        {
+            return compare(other) < 0;
+        }
+
+        inline bool operator ==(const Key &other) const
+        {
+            return 0 == compare(other);
+        }
+
+        /*!
+          * @return a 64 bits hash of the key
+          */
+        uint64_t hash() const;
+    };
+
+    /*! The constructor; computes the canonical form of a position.
+      * @param[in] board the position
+      */
+    explicit CanonicalBoard(const Board &board);
+
+    /*!
+      * @return the key of the canonical form
+      */
+    inline const Key &key() const
+    {
+        return m_key;
+    }
+
+    /*!
+      * @return the transform mapping the original board onto the canonical form
+      */
+    inline int transform() const
+    {
+        return m_transform;
+    }
+
+    /*! Maps a move of the original board onto the canonical frame.
+      */
+    Board::Move toCanonical(const Board::Move &move) const;
+
+    /*! Maps a move of the canonical frame back onto the original board.
+      */
+    Board::Move fromCanonical(const Board::Move &move) const;
+
+    /*! Packs a transformed board.
+      *
+      * @param[in] board the position
+      * @param[in] transform the transform (0 to Transforms - 1, 0 being the identity)
+      * @param[out] key receives the packed position
+      */
+    static void pack(const Board &board, int transform, Key &key);
+
+    /*! Rebuilds a board from a packed position (the score is not packed).
+      *
+      * @param[in] key the packed position
+      * @param[in] dimension the dimension of the board
+      * @return the board
+      */
+    static Board unpack(const Key &key, int dimension);
+
+    /*! Maps a cell by a transform.
+      *
+      * @param[in] index the index of the cell
+      * @param[in] transform the transform
+      * @param[in] dimension the dimension of the board
+      * @return the index of the transformed cell
+      */
+    static int transformCell(int index, int transform, int dimension);
+
+    /*! Maps a cell by the inverse of a transform.
+      * \sa transformCell()
+      */
+    static int inverseCell(int index, int transform, int dimension);
+
+private:
+    Key m_key; /*!< the key of the canonical form */
+    int m_transform; /*!< the transform giving the canonical form */
+    int m_dimension; /*!< the dimension of the board */
+};
+
+#endif // CANONICALBOARD_HPP
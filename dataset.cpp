@@ -0,0 +1,648 @@
+/*!
+  * @file dataset.cpp
+  * This file contains the definition of the classes DatasetChunk, DatasetWriter and DatasetReader.
+  */
+
+#include <algorithm>
+#include <string.h>
+#include "dataset.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LINES_DATASET_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char s_fileMagic[8] = { 'L', 'I', 'N', 'E', 'S', 'D', 'S', '1' };
+    const char s_indexMagic[8] = { 'L', 'I', 'N', 'E', 'S', 'I', 'D', 'X' };
+
+    enum
+    {
+        ChunkMagic = 0x4B43444C, // "LDCK"
+        FileHeaderSize = 16,     // the magic, the version and a reserved word
+        Version = 1,
+        Alignment = 8            // the alignment of the columns in a chunk
+    };
+
+    // The header of a chunk, followed by its columns.
+    struct ChunkHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_records;
+        uint32_t m_dimension;
+        uint32_t m_size; // the bytes of the chunk, header included
+        uint32_t m_columns[DatasetChunk::Columns]; // the offsets of the columns from the header
+    };
+
+    // The end of the index written by DatasetWriter::close(), after the offsets of the chunks.
+    struct IndexTrailer
+    {
+        uint64_t m_chunks;
+        char m_magic[8];
+    };
+
+    // the bytes of a sample in a column (the legal moves have a variable size)
+    inline int columnWidth(int column, int cells)
+    {
+        switch (column) {
+        case DatasetChunk::CellsColumn:
+            return (cells + 1) / 2;
+        case DatasetChunk::HintsColumn:
+            return 2 * Board::HintCount;
+        case DatasetChunk::MovesColumn:
+            return 2;
+        case DatasetChunk::OutcomesColumn:
+        case DatasetChunk::MaskIndexColumn:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    inline size_t align(size_t offset)
+    {
+        return (offset + Alignment - 1) & ~size_t(Alignment - 1);
+    }
+
+    inline void append(std::vector<unsigned char> &column, const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char*>(data);
+        column.insert(column.end(), bytes, bytes + size);
+    }
+
+    inline uint32_t read32(const unsigned char *data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+}
+
+//!
+DatasetChunk::DatasetChunk(int dimension, int capacity)
+    : m_dimension(Board(dimension).dim()),
+    m_cells(m_dimension * m_dimension),
+    m_capacity(std::max(1, std::min(capacity, int(MaxCapacity)))),
+    m_records(0),
+    m_moves(Board::MaxMoves)
+{
+    for (int c = 0; c < Columns; ++c) {
+        m_columns[c].reserve(size_t(m_capacity) * (MasksColumn == c ? 128 : columnWidth(c, m_cells)));
+    }
+}
+
+/*!
+  * The legal moves are grouped by the cell of the ball; the cells whose balls reach the same cells
+  * share one bitset.
+  */
+void DatasetChunk::add(const Board &board, const Board::Move &move, int outcome)
+{
+    int n = m_dimension;
+
+    std::vector<unsigned char> &cells = m_columns[CellsColumn];
+    size_t base = cells.size();
+    cells.resize(base + columnWidth(CellsColumn, m_cells), 0);
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c < n; ++c) {
+            int i = r * n + c;
+            cells[base + i / 2] |= (unsigned char)(board.cell(r, c) << (4 * (i & 1)));
+        }
+    }
+
+    unsigned char hints[2 * Board::HintCount];
+    memset(hints, 0, sizeof(hints));
+    for (int i = 0; i < board.hintCount(); ++i) {
+        int p = board.hintCell(i);
+        hints[2 * i] = (unsigned char)(Board::row(p) * n + Board::column(p));
+        hints[2 * i + 1] = board.hintColor(i);
+    }
+    append(m_columns[HintsColumn], hints, sizeof(hints));
+
+    unsigned char cellsMoved[2] = {
+        (unsigned char)(Board::row(move.m_from) * n + Board::column(move.m_from)),
+        (unsigned char)(Board::row(move.m_to) * n + Board::column(move.m_to))
+    };
+    append(m_columns[MovesColumn], cellsMoved, sizeof(cellsMoved));
+
+    int32_t value = outcome;
+    append(m_columns[OutcomesColumn], &value, sizeof(value));
+
+    uint32_t offset = uint32_t(m_columns[MasksColumn].size());
+    append(m_columns[MaskIndexColumn], &offset, sizeof(offset));
+
+    // the cells reached by every ball
+    int rowBytes = (m_cells + 7) / 8;
+    unsigned char targets[Board::MaxCells][Board::MaxCells / 8];
+    unsigned char sets[Board::MaxCells];
+    memset(sets, NoSet, m_cells);
+
+    int count = board.legalMoves(&m_moves[0]);
+    for (int i = 0; i < count; ++i) {
+        int from = Board::row(m_moves[i].m_from) * n + Board::column(m_moves[i].m_from);
+        int to = Board::row(m_moves[i].m_to) * n + Board::column(m_moves[i].m_to);
+
+        if (NoSet == sets[from]) {
+            sets[from] = 0;
+            memset(targets[from], 0, rowBytes);
+        }
+
+        targets[from][to >> 3] |= (unsigned char)(1 << (to & 7));
+    }
+
+    // the distinct sets, numbered in the order of their first ball
+    int owners[Board::MaxCells];
+    int distinct = 0;
+    for (int from = 0; from < m_cells; ++from) {
+        if (NoSet == sets[from]) {
+            continue;
+        }
+
+        int s = 0;
+        while ((s < distinct) && (0 != memcmp(targets[owners[s]], targets[from], rowBytes))) {
+            ++s;
+        }
+
+        if (s == distinct) {
+            owners[distinct++] = from;
+        }
+
+        sets[from] = (unsigned char)s;
+    }
+
+    append(m_columns[MasksColumn], sets, m_cells);
+    for (int s = 0; s < distinct; ++s) {
+        append(m_columns[MasksColumn], targets[owners[s]], rowBytes);
+    }
+
+    ++m_records;
+}
+
+//!
+void DatasetChunk::clear()
+{
+    for (int c = 0; c < Columns; ++c) {
+        m_columns[c].clear();
+    }
+
+    m_records = 0;
+}
+
+/*!
+  * The index of the legal moves gets its last offset (the end of the last sample) here.
+  */
+const std::vector<unsigned char> &DatasetChunk::encode()
+{
+    ChunkHeader header;
+    header.m_magic = ChunkMagic;
+    header.m_records = uint32_t(m_records);
+    header.m_dimension = uint32_t(m_dimension);
+
+    size_t sizes[Columns];
+    size_t offset = sizeof(ChunkHeader);
+    for (int c = 0; c < Columns; ++c) {
+        sizes[c] = m_columns[c].size() + (MaskIndexColumn == c ? sizeof(uint32_t) : 0);
+
+        offset = align(offset);
+        header.m_columns[c] = uint32_t(offset);
+        offset += sizes[c];
+    }
+    header.m_size = uint32_t(align(offset));
+
+    m_data.assign(header.m_size, 0);
+    memcpy(&m_data[0], &header, sizeof(header));
+
+    for (int c = 0; c < Columns; ++c) {
+        if (!m_columns[c].empty()) {
+            memcpy(&m_data[header.m_columns[c]], &m_columns[c][0], m_columns[c].size());
+        }
+    }
+
+    uint32_t end = uint32_t(m_columns[MasksColumn].size());
+    memcpy(&m_data[header.m_columns[MaskIndexColumn] + m_columns[MaskIndexColumn].size()], &end, sizeof(end));
+
+    return m_data;
+}
+
+//!
+DatasetWriter::DatasetWriter()
+    : m_fd(-1),
+    m_file(0),
+    m_end(0),
+    m_records(0),
+    m_failed(false)
+{
+}
+
+//!
+DatasetWriter::~DatasetWriter()
+{
+    close();
+}
+
+//!
+bool DatasetWriter::open(const std::string &path)
+{
+    close();
+
+#if defined(LINES_DATASET_POSIX)
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+        return false;
+    }
+#else
+    m_file = std::fopen(path.c_str(), "w+b");
+    if (!m_file) {
+        return false;
+    }
+#endif
+
+    unsigned char header[FileHeaderSize];
+    memset(header, 0, sizeof(header));
+    memcpy(header, s_fileMagic, sizeof(s_fileMagic));
+
+    uint32_t version = Version;
+    memcpy(header + sizeof(s_fileMagic), &version, sizeof(version));
+
+    m_end.store(FileHeaderSize);
+    m_records.store(0);
+    m_failed.store(false);
+
+    return writeAt(0, header, sizeof(header));
+}
+
+/*!
+  * The chunks are found by following their headers, so that the writes of the chunks did not need
+  * to record anything in a shared list.
+  */
+bool DatasetWriter::close()
+{
+    if ((m_fd < 0) && !m_file) {
+        return true;
+    }
+
+    std::vector<uint64_t> offsets;
+    uint64_t end = m_end.load();
+    uint64_t offset = FileHeaderSize;
+
+    while (offset < end) {
+        ChunkHeader header;
+        if (!readAt(offset, &header, sizeof(header)) || (ChunkMagic != header.m_magic) || (0 == header.m_size)) {
+            m_failed.store(true);
+            break;
+        }
+
+        offsets.push_back(offset);
+        offset += header.m_size;
+    }
+
+    IndexTrailer trailer;
+    trailer.m_chunks = offsets.size();
+    memcpy(trailer.m_magic, s_indexMagic, sizeof(s_indexMagic));
+
+    if (!offsets.empty() && !writeAt(end, &offsets[0], offsets.size() * sizeof(uint64_t))) {
+        m_failed.store(true);
+    }
+    if (!writeAt(end + offsets.size() * sizeof(uint64_t), &trailer, sizeof(trailer))) {
+        m_failed.store(true);
+    }
+
+#if defined(LINES_DATASET_POSIX)
+    ::close(m_fd);
+    m_fd = -1;
+#else
+    std::fclose(m_file);
+    m_file = 0;
+#endif
+
+    return !m_failed.load();
+}
+
+//!
+bool DatasetWriter::append(DatasetChunk &chunk)
+{
+    if (((m_fd < 0) && !m_file) || (0 == chunk.records())) {
+        return (0 == chunk.records());
+    }
+
+    const std::vector<unsigned char> &data = chunk.encode();
+    uint64_t offset = m_end.fetch_add(data.size());
+
+    if (!writeAt(offset, &data[0], data.size())) {
+        m_failed.store(true);
+        return false;
+    }
+
+    m_records.fetch_add(uint64_t(chunk.records()), std::memory_order_relaxed);
+    return true;
+}
+
+//!
+bool DatasetWriter::writeAt(uint64_t offset, const void *data, size_t size)
+{
+#if defined(LINES_DATASET_POSIX)
+    const char *bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = pwrite(m_fd, bytes, size, off_t(offset));
+        if (written <= 0) {
+            return false;
+        }
+
+        bytes += written;
+        size -= size_t(written);
+        offset += uint64_t(written);
+    }
+
+    return true;
+#else
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (0 == std::fseek(m_file, long(offset), SEEK_SET)) && (std::fwrite(data, 1, size, m_file) == size);
+#endif
+}
+
+//!
+bool DatasetWriter::readAt(uint64_t offset, void *data, size_t size)
+{
+#if defined(LINES_DATASET_POSIX)
+    return pread(m_fd, data, size, off_t(offset)) == ssize_t(size);
+#else
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (0 == std::fseek(m_file, long(offset), SEEK_SET)) && (std::fread(data, 1, size, m_file) == size);
+#endif
+}
+
+//!
+DatasetReader::DatasetReader()
+    : m_data(0),
+    m_size(0),
+    m_records(0)
+{
+}
+
+//!
+DatasetReader::~DatasetReader()
+{
+    close();
+}
+
+//!
+bool DatasetReader::open(const std::string &path)
+{
+    close();
+
+#if defined(LINES_DATASET_POSIX)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if ((0 != fstat(fd, &info)) || (info.st_size < FileHeaderSize)) {
+        ::close(fd);
+        return false;
+    }
+
+    void *memory = mmap(0, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == memory) {
+        return false;
+    }
+
+    m_data = static_cast<const unsigned char*>(memory);
+    m_size = size_t(info.st_size);
+#else
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    unsigned char block[65536];
+    size_t read;
+    while ((read = std::fread(block, 1, sizeof(block), file)) > 0) {
+        m_buffer.insert(m_buffer.end(), block, block + read);
+    }
+    std::fclose(file);
+
+    if (m_buffer.size() < FileHeaderSize) {
+        m_buffer.clear();
+        return false;
+    }
+
+    m_data = &m_buffer[0];
+    m_size = m_buffer.size();
+#endif
+
+    if (0 != memcmp(m_data, s_fileMagic, sizeof(s_fileMagic))) {
+        close();
+        return false;
+    }
+
+    // the index, if the file was closed
+    IndexTrailer trailer;
+    bool indexed = false;
+    if (m_size >= FileHeaderSize + sizeof(trailer)) {
+        memcpy(&trailer, m_data + m_size - sizeof(trailer), sizeof(trailer));
+
+        uint64_t room = (m_size - FileHeaderSize - sizeof(trailer)) / sizeof(uint64_t);
+        indexed = (0 == memcmp(trailer.m_magic, s_indexMagic, sizeof(s_indexMagic))) && (trailer.m_chunks <= room);
+    }
+
+    if (indexed) {
+        const unsigned char *offsets = m_data + m_size - sizeof(trailer) - trailer.m_chunks * sizeof(uint64_t);
+        for (uint64_t i = 0; indexed && (i < trailer.m_chunks); ++i) {
+            uint64_t offset;
+            memcpy(&offset, offsets + i * sizeof(uint64_t), sizeof(offset));
+            indexed = addChunk(offset);
+        }
+    }
+
+    if (!indexed) {
+        m_chunks.clear();
+        m_records = 0;
+
+        uint64_t offset = FileHeaderSize;
+        while (addChunk(offset)) {
+            offset += read32(m_data + offset + offsetof(ChunkHeader, m_size));
+        }
+    }
+
+    return true;
+}
+
+//!
+void DatasetReader::close()
+{
+#if defined(LINES_DATASET_POSIX)
+    if (m_data) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+#else
+    m_buffer.clear();
+#endif
+
+    m_data = 0;
+    m_size = 0;
+    m_chunks.clear();
+    m_records = 0;
+}
+
+//!
+bool DatasetReader::addChunk(uint64_t offset)
+{
+    ChunkHeader header;
+    if ((offset < FileHeaderSize) || (offset + sizeof(header) > m_size)) {
+        return false;
+    }
+
+    memcpy(&header, m_data + offset, sizeof(header));
+    if ((ChunkMagic != header.m_magic) || (header.m_size < sizeof(header)) || (offset + header.m_size > m_size) ||
+        (header.m_dimension < 1) || (header.m_dimension > Board::MaxDimension)) {
+        return false;
+    }
+
+    Chunk chunk;
+    chunk.m_data = m_data + offset;
+    chunk.m_records = int(header.m_records);
+    chunk.m_dimension = int(header.m_dimension);
+    chunk.m_first = m_records;
+
+    int cells = chunk.m_dimension * chunk.m_dimension;
+    for (int c = 0; c < DatasetChunk::Columns; ++c) {
+        chunk.m_columns[c] = header.m_columns[c];
+
+        uint64_t width = (DatasetChunk::MaskIndexColumn == c) ? 1 + header.m_records : header.m_records;
+        if (header.m_columns[c] + width * columnWidth(c, cells) > header.m_size) {
+            return false;
+        }
+    }
+
+    m_chunks.push_back(chunk);
+    m_records += header.m_records;
+
+    return true;
+}
+
+//!
+bool DatasetReader::locate(uint64_t record, int &chunk, int &index) const
+{
+    if (record >= m_records) {
+        return false;
+    }
+
+    int low = 0;
+    int high = int(m_chunks.size()) - 1;
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+        if (m_chunks[middle].m_first <= record) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    chunk = low;
+    index = int(record - m_chunks[low].m_first);
+
+    return true;
+}
+
+//!
+const unsigned char *DatasetReader::column(int chunk, int index, DatasetChunk::Column column, int width) const
+{
+    const Chunk &c = m_chunks[chunk];
+    return c.m_data + c.m_columns[column] + size_t(index) * width;
+}
+
+//!
+void DatasetReader::board(int chunk, int index, Board &board) const
+{
+    int n = m_chunks[chunk].m_dimension;
+    int cellCount = n * n;
+
+    board = Board(n);
+
+    const unsigned char *cells = column(chunk, index, DatasetChunk::CellsColumn, columnWidth(DatasetChunk::CellsColumn, cellCount));
+    for (int i = 0; i < cellCount; ++i) {
+        Board::Cell color = Board::Cell((cells[i / 2] >> (4 * (i & 1))) & 0x0F);
+        if (color != Board::Empty) {
+            board.setCell(Board::index(i / n, i % n), color);
+        }
+    }
+
+    const unsigned char *hints = column(chunk, index, DatasetChunk::HintsColumn, columnWidth(DatasetChunk::HintsColumn, cellCount));
+    for (int i = 0; i < Board::HintCount; ++i) {
+        if (hints[2 * i + 1] != Board::Empty) {
+            board.addHint(Board::index(hints[2 * i] / n, hints[2 * i] % n), hints[2 * i + 1]);
+        }
+    }
+}
+
+//!
+Board::Move DatasetReader::move(int chunk, int index) const
+{
+    int n = m_chunks[chunk].m_dimension;
+    const unsigned char *cells = column(chunk, index, DatasetChunk::MovesColumn, 2);
+
+    return Board::Move(Board::index(cells[0] / n, cells[0] % n), Board::index(cells[1] / n, cells[1] % n));
+}
+
+//!
+int DatasetReader::outcome(int chunk, int index) const
+{
+    return int(int32_t(read32(column(chunk, index, DatasetChunk::OutcomesColumn, 4))));
+}
+
+//!
+int DatasetReader::legalMoves(int chunk, int index, Board::Move *moves) const
+{
+    int n = m_chunks[chunk].m_dimension;
+    int cells = n * n;
+    int rowBytes = (cells + 7) / 8;
+
+    const unsigned char *sets = m_chunks[chunk].m_data + m_chunks[chunk].m_columns[DatasetChunk::MasksColumn] +
+                                read32(column(chunk, index, DatasetChunk::MaskIndexColumn, 4));
+    const unsigned char *targets = sets + cells;
+
+    int count = 0;
+    for (int from = 0; from < cells; ++from) {
+        if (DatasetChunk::NoSet == sets[from]) {
+            continue;
+        }
+
+        const unsigned char *row = targets + sets[from] * rowBytes;
+        for (int to = 0; to < cells; ++to) {
+            if (row[to >> 3] & (1 << (to & 7))) {
+                moves[count++] = Board::Move(Board::index(from / n, from % n), Board::index(to / n, to % n));
+            }
+        }
+    }
+
+    return count;
+}
+
+//!
+void DatasetReader::legalMask(int chunk, int index, unsigned char *mask) const
+{
+    int n = m_chunks[chunk].m_dimension;
+    int cells = n * n;
+    int rowBytes = (cells + 7) / 8;
+
+    const unsigned char *sets = m_chunks[chunk].m_data + m_chunks[chunk].m_columns[DatasetChunk::MasksColumn] +
+                                read32(column(chunk, index, DatasetChunk::MaskIndexColumn, 4));
+    const unsigned char *targets = sets + cells;
+
+    memset(mask, 0, size_t(cells) * cells);
+    for (int from = 0; from < cells; ++from) {
+        if (DatasetChunk::NoSet == sets[from]) {
+            continue;
+        }
+
+        const unsigned char *row = targets + sets[from] * rowBytes;
+        for (int to = 0; to < cells; ++to) {
+            mask[from * cells + to] = (unsigned char)((row[to >> 3] >> (to & 7)) & 1);
+        }
+    }
+}
@@ -0,0 +1,305 @@
+/*!
+  * @file dataset.hpp
+  * This file contains the declaration of the classes DatasetChunk, DatasetWriter and DatasetReader.
+  */
+#ifndef DATASET_HPP
+#define DATASET_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "board.hpp"
+
+/*! This class builds a chunk of training samples in memory, column by column.
+  *
+  * A sample is a position, its legal moves, the move played and the outcome (the points scored
+  * from the position to the end of the game). The columns of a chunk are packed so that every
+  * sample can be read in place, without decoding the rest of the chunk:
+  * - the cells: 4 bits per cell (the index of the color + 1 or 0), (cells + 1) / 2 bytes per sample,
+  * - the 'hint' balls: HintCount pairs of bytes (the cell row * dim + column, the color or 0),
+  * - the moves: 2 bytes (the cells moved from and to, numbered row * dim + column),
+  * - the outcomes: 32 bits,
+  * - the index of the legal moves: the offset of every sample in the last column (32 bits, one more
+  *   than the samples),
+  * - the legal moves: for every cell, the number of the set of the cells its ball can reach (0xFF
+  *   if the cell does not hold a ball that can move), followed by the distinct sets as bitsets of
+  *   (cells + 7) / 8 bytes; the balls touching the same regions share one set, so the legal moves
+  *   of a 9x9 position take about 200 bytes instead of the 820 bytes of a full bit mask.
+  *
+  * The numbers are stored in the byte order of the host.
+  */
+class DatasetChunk
+{
+public:
+    /*! \brief The columns of a chunk.
+      */
+    enum Column
+    {
+        CellsColumn,
+        HintsColumn,
+        MovesColumn,
+        OutcomesColumn,
+        MaskIndexColumn,
+        MasksColumn,
+        Columns
+    };
+
+    enum
+    {
+        MaxCapacity = 1 << 20, // the greatest number of the samples of a chunk
+        NoSet = 0xFF           // the set number of a cell without a ball that can move
+    };
+
+    /*! The constructor.
+      *
+      * @param[in] dimension the dimension of the boards
+      * @param[in] capacity the number of the samples of a full chunk
+      */
+    explicit DatasetChunk(int dimension = 9, int capacity = 65536);
+
+    /*!
+      * @return the dimension of the boards
+      */
+    inline int dim() const
+    {
+        return m_dimension;
+    }
+
+    /*!
+      * @return the number of the samples added
+      */
+    inline int records() const
+    {
+        return m_records;
+    }
+
+    /*!
+      * @return true if the chunk holds its capacity of samples
+      */
+    inline bool isFull() const
+    {
+        return m_records >= m_capacity;
+    }
+
+    /*! Adds a sample.
+      *
+      * @param[in] board the position (of the dimension of the chunk)
+      * @param[in] move the move played
+      * @param[in] outcome the points scored from the position to the end of the game
+      */
+    void add(const Board &board, const Board::Move &move, int outcome);
+
+    /*! Removes all the samples.
+      */
+    void clear();
+
+    /*! Lays the chunk out as it is written in a file.
+      * @return the bytes of the chunk (valid until the next change of the chunk)
+      */
+    const std::vector<unsigned char> &encode();
+
+private:
+    int m_dimension; /*!< the dimension of the boards */
+    int m_cells; /*!< the number of the cells of a board */
+    int m_capacity; /*!< the number of the samples of a full chunk */
+    int m_records; /*!< the number of the samples added */
+
+    std::vector<unsigned char> m_columns[Columns]; /*!< the columns being built */
+    std::vector<unsigned char> m_data; /*!< the encoded chunk */
+    std::vector<Board::Move> m_moves; /*!< the legal moves of the sample being added */
+};
+
+/*! This class appends chunks of samples to a dataset file.
+  *
+  * The file starts with a header followed by the chunks, each one starting with a header that
+  * gives its size and the offsets of its columns; close() appends the index of the chunks. Several
+  * threads may append chunks at the same time: every chunk reserves its range of the file with an
+  * atomic addition and is written there with pwrite(), without any lock (on systems without
+  * pwrite() the writes are serialized by a mutex).
+  */
+class DatasetWriter
+{
+public:
+    /*! The constructor.
+      */
+    DatasetWriter();
+
+    /*! The destructor; closes the file.
+      */
+    ~DatasetWriter();
+
+    /*! Creates a dataset file (an existing file is truncated).
+      * @return false if the file cannot be created
+      */
+    bool open(const std::string &path);
+
+    /*! Writes the index of the chunks and closes the file.
+      * @return false if a write failed
+      */
+    bool close();
+
+    /*! Appends a chunk; may be called from several threads at once.
+      *
+      * @param[in] chunk the chunk (it is encoded by the call, not cleared)
+      * @return false if the write failed
+      */
+    bool append(DatasetChunk &chunk);
+
+    /*!
+      * @return the number of the samples written
+      */
+    inline uint64_t records() const
+    {
+        return m_records.load(std::memory_order_relaxed);
+    }
+
+    /*!
+      * @return the number of the bytes written
+      */
+    inline uint64_t bytes() const
+    {
+        return m_end.load(std::memory_order_relaxed);
+    }
+
+private:
+    bool writeAt(uint64_t offset, const void *data, size_t size);
+    bool readAt(uint64_t offset, void *data, size_t size);
+
+private:
+    int m_fd; /*!< the descriptor of the file or -1 */
+    std::FILE *m_file; /*!< the file (on systems without pwrite()) */
+    std::mutex m_mutex; /*!< serializes the writes to m_file */
+    std::atomic<uint64_t> m_end; /*!< the end of the last range reserved */
+    std::atomic<uint64_t> m_records; /*!< the number of the samples written */
+    std::atomic<bool> m_failed; /*!< did a write fail ? */
+};
+
+/*! This class reads a dataset file written by DatasetWriter.
+  *
+  * The file is mapped into memory and the samples are decoded in place from the mapping. The chunks
+  * are found by the index written by DatasetWriter::close() or, if the file was not closed, by
+  * following the headers of the chunks up to the first incomplete one.
+  */
+class DatasetReader
+{
+public:
+    /*! The constructor.
+      */
+    DatasetReader();
+
+    /*! The destructor; closes the file.
+      */
+    ~DatasetReader();
+
+    /*! Opens a dataset file.
+      * @return false if the file cannot be read or is not a dataset file
+      */
+    bool open(const std::string &path);
+
+    /*! Closes the file.
+      */
+    void close();
+
+    /*!
+      * @return the number of the chunks
+      */
+    inline int chunks() const
+    {
+        return int(m_chunks.size());
+    }
+
+    /*!
+      * @return the number of the samples of all the chunks
+      */
+    inline uint64_t records() const
+    {
+        return m_records;
+    }
+
+    /*!
+      * @return the number of the samples of a chunk
+      */
+    inline int chunkRecords(int chunk) const
+    {
+        return m_chunks[chunk].m_records;
+    }
+
+    /*!
+      * @return the dimension of the boards of a chunk
+      */
+    inline int chunkDimension(int chunk) const
+    {
+        return m_chunks[chunk].m_dimension;
+    }
+
+    /*! Finds a sample by its number in the file.
+      *
+      * @param[in] record the number of the sample
+      * @param[out] chunk receives the chunk of the sample
+      * @param[out] index receives the index of the sample in its chunk
+      * @return false if there is no such sample
+      */
+    bool locate(uint64_t record, int &chunk, int &index) const;
+
+    /*! Decodes the position of a sample (with its 'hint' balls; the score is zero).
+      */
+    void board(int chunk, int index, Board &board) const;
+
+    /*!
+      * @return the move of a sample (as indexes in the array of the cells of a Board)
+      */
+    Board::Move move(int chunk, int index) const;
+
+    /*!
+      * @return the outcome of a sample
+      */
+    int outcome(int chunk, int index) const;
+
+    /*! Decodes the legal moves of a sample.
+      *
+      * @param[out] moves receives the moves (as indexes in the array of the cells of a Board)
+      * @return the number of the legal moves
+      */
+    int legalMoves(int chunk, int index, Board::Move *moves) const;
+
+    /*! Decodes the legal moves of a sample as a mask.
+      * @param[out] mask receives cells * cells bytes: mask[from * cells + to] is 1 if the move is
+      * legal, the cells being numbered row * dim + column (as the actions of VecEnv)
+      */
+    void legalMask(int chunk, int index, unsigned char *mask) const;
+
+private:
+    /*! \brief A chunk of the mapped file.
+      */
+    struct Chunk
+    {
+        const unsigned char *m_data; /*!< the header of the chunk */
+        int m_records;
+        int m_dimension;
+        uint32_t m_columns[DatasetChunk::Columns]; /*!< the offsets of the columns from the header */
+        uint64_t m_first; /*!< the number of the first sample of the chunk in the file */
+    };
+
+    /*! Adds the chunk at the given offset of the file.
+      * @return false if there is no complete chunk there
+      */
+    bool addChunk(uint64_t offset);
+
+    /*!
+      * @return the address of the sample in a column
+      */
+    const unsigned char *column(int chunk, int index, DatasetChunk::Column column, int width) const;
+
+private:
+    const unsigned char *m_data; /*!< the contents of the file */
+    size_t m_size; /*!< the size of the file */
+    std::vector<unsigned char> m_buffer; /*!< the contents of the file (on systems without mmap()) */
+    std::vector<Chunk> m_chunks; /*!< the chunks */
+    uint64_t m_records; /*!< the number of the samples */
+};
+
+#endif // DATASET_HPP
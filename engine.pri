@@ -0,0 +1,43 @@
+# -------------------------------------------------
+# The headless engine: the board, the rules and the bots.
+# It does not depend on Qt and it is shared by the game and by the tools.
+# -------------------------------------------------
+CONFIG += c++11 thread
+INCLUDEPATH += $$PWD
+unix:!macx: LIBS += -ldl
+SOURCES += $$PWD/board.cpp \
+    $$PWD/evaluator.cpp \
+    $$PWD/expectimax.cpp \
+    $$PWD/montecarlo.cpp \
+    $$PWD/beamsolver.cpp \
+    $$PWD/transpositiontable.cpp \
+    $$PWD/canonicalboard.cpp \
+    $$PWD/tuner.cpp \
+    $$PWD/memotable.cpp \
+    $$PWD/exactsolver.cpp \
+    $$PWD/analyzer.cpp \
+    $$PWD/vecenv.cpp \
+    $$PWD/batchevaluator.cpp \
+    $$PWD/dataset.cpp \
+    $$PWD/botlibrary.cpp \
+    $$PWD/gameengine.cpp
+HEADERS += $$PWD/random.hpp \
+    $$PWD/board.hpp \
+    $$PWD/evaluator.hpp \
+    $$PWD/expectimax.hpp \
+    $$PWD/montecarlo.hpp \
+    $$PWD/beamsolver.hpp \
+    $$PWD/transpositiontable.hpp \
+    $$PWD/canonicalboard.hpp \
+    $$PWD/tuner.hpp \
+    $$PWD/memotable.hpp \
+    $$PWD/exactsolver.hpp \
+    $$PWD/analyzer.hpp \
+    $$PWD/vecenv.hpp \
+    $$PWD/bitrows.hpp \
+    $$PWD/batchevaluator.hpp \
+    $$PWD/dataset.hpp \
+    $$PWD/botplugin.h \
+    $$PWD/botlibrary.hpp \
+    $$PWD/spscqueue.hpp \
+    $$PWD/gameengine.hpp
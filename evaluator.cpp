@@ -0,0 +1,696 @@
+/*!
+  * @file evaluator.cpp
+  * This file contains the definition of the class Evaluator.
+  */
+
+#include <algorithm>
+#include <functional>
+#include <string.h>
+#include "evaluator.hpp"
+#include "bitrows.hpp"
+
+#if !defined(LINES_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__))
+#define LINES_EVAL_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define LINES_EVAL_AVX2
+#define LINES_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define LINES_EVAL_AVX2
+#define LINES_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+namespace
+{
+    // the offset between two consecutive cells of a window: W-E, N-S, NW-SE and SW-NE
+    const int s_windowDeltas[4] = { 1, Board::Stride, Board::Stride + 1, 1 - Board::Stride };
+
+    // the first and the last (exclusive) offsets of the rows where a window may start
+    inline void windowRows(int direction, int dimension, int &first, int &last)
+    {
+        first = (direction == 3) ? Board::LineLength - 1 : 0;
+        last = (direction == 0) || (direction == 3) ? dimension : dimension - Board::LineLength + 1;
+
+        first *= Board::Stride;
+        last *= Board::Stride;
+    }
+
+#if defined(LINES_EVAL_SSE2)
+    // The rows of a board in the 16-bit lanes of two registers: the rows 0 to 7, then the rows 8 to 15.
+    struct RowPlane
+    {
+        __m128i m_lo;
+        __m128i m_hi;
+    };
+
+    // the rows moved K rows down (the row r gets the row r - K), then K rows up
+    template <int K>
+    inline RowPlane rowsDown(const RowPlane &p)
+    {
+        RowPlane q;
+        q.m_lo = _mm_slli_si128(p.m_lo, 2 * K);
+        q.m_hi = _mm_or_si128(_mm_slli_si128(p.m_hi, 2 * K), _mm_srli_si128(p.m_lo, 16 - 2 * K));
+        return q;
+    }
+
+    template <int K>
+    inline RowPlane rowsUp(const RowPlane &p)
+    {
+        RowPlane q;
+        q.m_lo = _mm_or_si128(_mm_srli_si128(p.m_lo, 2 * K), _mm_slli_si128(p.m_hi, 16 - 2 * K));
+        q.m_hi = _mm_srli_si128(p.m_hi, 2 * K);
+        return q;
+    }
+
+    inline RowPlane operator &(const RowPlane &a, const RowPlane &b)
+    {
+        RowPlane q = { _mm_and_si128(a.m_lo, b.m_lo), _mm_and_si128(a.m_hi, b.m_hi) };
+        return q;
+    }
+
+    inline RowPlane operator |(const RowPlane &a, const RowPlane &b)
+    {
+        RowPlane q = { _mm_or_si128(a.m_lo, b.m_lo), _mm_or_si128(a.m_hi, b.m_hi) };
+        return q;
+    }
+
+    // an occluded fill of the bits over the runs of the columns of every row
+    template <int K>
+    inline void fillColumns(__m128i &gen, __m128i &left, __m128i &right, __m128i &up, __m128i &down)
+    {
+        up = _mm_or_si128(up, _mm_and_si128(left, _mm_slli_epi16(up, K)));
+        down = _mm_or_si128(down, _mm_and_si128(right, _mm_srli_epi16(down, K)));
+        left = _mm_and_si128(left, _mm_slli_epi16(left, K));
+        right = _mm_and_si128(right, _mm_srli_epi16(right, K));
+        gen = _mm_or_si128(up, down);
+    }
+
+    inline __m128i spreadColumns(__m128i run, __m128i bits)
+    {
+        __m128i left = run, right = run, up = bits, down = bits, gen = bits;
+        fillColumns<1>(gen, left, right, up, down);
+        fillColumns<2>(gen, left, right, up, down);
+        fillColumns<4>(gen, left, right, up, down);
+        fillColumns<8>(gen, left, right, up, down);
+        return gen;
+    }
+
+    // the same fill over the runs of the rows of every column
+    template <int K>
+    inline void fillRows(RowPlane &down, RowPlane &up, RowPlane &below, RowPlane &above)
+    {
+        down = down | (below & rowsDown<K>(down));
+        up = up | (above & rowsUp<K>(up));
+        below = below & rowsDown<K>(below);
+        above = above & rowsUp<K>(above);
+    }
+
+    inline RowPlane spreadRows(const RowPlane &run, const RowPlane &bits)
+    {
+        RowPlane down = bits, up = bits, below = run, above = run;
+        fillRows<1>(down, up, below, above);
+        fillRows<2>(down, up, below, above);
+        fillRows<4>(down, up, below, above);
+        fillRows<8>(down, up, below, above);
+        return down | up;
+    }
+
+    // Grows a set of empty cells to the whole regions that contain it (see BitRows::flood()): the set
+    // is spread along the rows and along the columns in turn until it does not change.
+    void floodSse2(const BitRows &rows, uint16_t *set)
+    {
+        uint16_t cells[2 * 8] = {0};
+        uint16_t empty[2 * 8] = {0};
+        memcpy(cells, set, rows.m_dimension * sizeof(uint16_t));
+        memcpy(empty, rows.m_empty, rows.m_dimension * sizeof(uint16_t));
+
+        RowPlane run = { _mm_loadu_si128(reinterpret_cast<const __m128i*>(empty)),
+                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(empty + 8)) };
+        RowPlane p = { _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells)),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + 8)) };
+
+        while (true) {
+            RowPlane q;
+            q.m_lo = spreadColumns(run.m_lo, p.m_lo);
+            q.m_hi = spreadColumns(run.m_hi, p.m_hi);
+            q = spreadRows(run, q);
+
+            __m128i same = _mm_and_si128(_mm_cmpeq_epi16(q.m_lo, p.m_lo), _mm_cmpeq_epi16(q.m_hi, p.m_hi));
+            p = q;
+            if (_mm_movemask_epi8(same) == 0xFFFF) {
+                break;
+            }
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cells), p.m_lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cells + 8), p.m_hi);
+        memcpy(set, cells, rows.m_dimension * sizeof(uint16_t));
+    }
+#endif
+
+    // writes the bits of a row of reachable cells as 16 bytes of 0 or 1
+    inline void writeReachRow(uint16_t bits, unsigned char *row)
+    {
+#if defined(LINES_EVAL_SSE2)
+        const __m128i masks = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        // the low byte of the row into the bytes 0 to 7, the high byte into the bytes 8 to 15
+        __m128i bytes = _mm_cvtsi32_si128(bits);
+        bytes = _mm_unpacklo_epi8(bytes, bytes);
+        bytes = _mm_unpacklo_epi16(bytes, bytes);
+        bytes = _mm_unpacklo_epi32(bytes, bytes);
+        __m128i set = _mm_cmpeq_epi8(_mm_and_si128(bytes, masks), masks);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row), _mm_and_si128(set, _mm_set1_epi8(1)));
+#else
+        for (int c = 0; c < Board::Stride; ++c) {
+            row[c] = (unsigned char)((bits >> c) & 1);
+        }
+#endif
+    }
+
+    inline short clampWeight(int w)
+    {
+        if (w > EvalWeights::MaxWeight) return EvalWeights::MaxWeight;
+        if (w < -EvalWeights::MaxWeight) return -EvalWeights::MaxWeight;
+        return short(w);
+    }
+}
+
+//!
+EvalWeights::EvalWeights()
+    : m_reach(2),
+    m_free(4)
+{
+    static const short line[Board::LineLength + 1] = { 0, 1, 6, 36, 216, 1296 };
+    memcpy(m_line, line, sizeof(m_line));
+}
+
+//!
+Evaluator::Evaluator(Kernel kernel)
+    : m_kernel(ScalarKernel),
+    m_validDimension(0)
+{
+    memset(m_cells, 0, sizeof(m_cells));
+    memset(m_colorScores, 0, sizeof(m_colorScores));
+
+    setKernel(kernel);
+}
+
+//!
+Evaluator::Kernel Evaluator::bestKernel()
+{
+    if (isSupported(Avx2Kernel)) {
+        return Avx2Kernel;
+    }
+
+    if (isSupported(Sse2Kernel)) {
+        return Sse2Kernel;
+    }
+
+    return ScalarKernel;
+}
+
+//!
+bool Evaluator::isSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case ScalarKernel:
+        return true;
+#ifdef LINES_EVAL_SSE2
+    case Sse2Kernel:
+        return true;
+#endif
+#ifdef LINES_EVAL_AVX2
+    case Avx2Kernel:
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_cpu_supports("avx2");
+#else
+        return true;
+#endif
+#endif
+    default:
+        return false;
+    }
+}
+
+//!
+const char *Evaluator::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Sse2Kernel:
+        return "sse2";
+    case Avx2Kernel:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+//!
+void Evaluator::setKernel(Kernel kernel)
+{
+    m_kernel = isSupported(kernel) ? kernel : ScalarKernel;
+}
+
+//!
+void Evaluator::setWeights(const EvalWeights &weights)
+{
+    for (int i = 0; i <= Board::LineLength; ++i) {
+        m_weights.m_line[i] = clampWeight(weights.m_line[i]);
+    }
+
+    // the reach term of a window is at most LineLength * m_reach
+    m_weights.m_reach = clampWeight(weights.m_reach);
+    m_weights.m_free = clampWeight(weights.m_free);
+}
+
+//!
+int Evaluator::evaluate(const Board &board)
+{
+    return evaluate(board, m_kernel);
+}
+
+//!
+int Evaluator::evaluate(const Board &board, Kernel kernel)
+{
+    prepare(board);
+
+    return evaluatePrepared(board, kernel);
+}
+
+//!
+int Evaluator::evaluatePrepared(const Board &board, Kernel kernel)
+{
+    switch (isSupported(kernel) ? kernel : ScalarKernel) {
+    case Avx2Kernel:
+        runAvx2(board.dim());
+        break;
+    case Sse2Kernel:
+        runSse2(board.dim());
+        break;
+    default:
+        runScalar(board.dim());
+        break;
+    }
+
+    int score = m_weights.m_free * board.freeCount();
+    for (int i = 0; i < Board::Colors; ++i) {
+        score += m_colorScores[i];
+    }
+
+    return score;
+}
+
+//!
+bool Evaluator::suggestMove(const Board &board, Board::Move &move, int candidates)
+{
+    int count = board.legalMoves(m_moves);
+    if (0 == count) {
+        return false;
+    }
+
+    bool ranked = (candidates > 0) && (candidates < count);
+    if (ranked) {
+        // keeps the best ranked moves (the rank in the high bits, the index in the low bits)
+        for (int i = 0; i < count; ++i) {
+            m_ranks[i] = (uint64_t(board.moveRank(m_moves[i])) << 32) | uint64_t(i);
+        }
+
+        std::partial_sort(m_ranks, m_ranks + candidates, m_ranks + count, std::greater<uint64_t>());
+        count = candidates;
+    }
+
+    int bestValue = 0;
+    for (int i = 0; i < count; ++i) {
+        const Board::Move &candidate = ranked ? m_moves[m_ranks[i] & 0xFFFFFFFF] : m_moves[i];
+
+        Board next(board);
+        int points = next.applyMove(candidate);
+        int value = points + evaluate(next);
+
+        if ((0 == i) || (value > bestValue)) {
+            bestValue = value;
+            move = candidate;
+        }
+    }
+
+    return true;
+}
+
+//!
+void Evaluator::prepare(const Board &board)
+{
+    memcpy(m_cells, board.cells(), Board::MaxCells);
+
+    int dimension = board.dim();
+    if (m_validDimension != dimension) {
+        buildValidMasks(dimension);
+    }
+
+    // an empty cell can be reached by the balls of a color if its region touches one of them: the
+    // empty cells next to the balls of the color are grown to their whole regions, over bit rows
+    BitRows rows(board);
+    int n = dimension;
+
+    uint16_t reach[Board::Colors][Board::MaxDimension];
+    for (int k = 0; k < Board::Colors; ++k) {
+        uint16_t balls[Board::MaxDimension];
+        for (int r = 0; r < n; ++r) {
+            balls[r] = uint16_t(BitRows::rowOf(board, r, Board::Cell(k + 1)) & rows.m_balls[r]);
+        }
+        for (int r = 0; r < n; ++r) {
+            reach[k][r] = uint16_t(rows.m_empty[r] & BitRows::neighbours(balls, r, n));
+        }
+
+#if defined(LINES_EVAL_SSE2)
+        floodSse2(rows, reach[k]);
+#else
+        rows.flood(reach[k]);
+#endif
+    }
+
+    // the rows beyond the dimension are never written, they stay zero
+    for (int k = 0; k < Board::Colors; ++k) {
+        for (int r = 0; r < n; ++r) {
+            writeReachRow(reach[k][r], m_reach[k] + Board::index(r, 0));
+        }
+    }
+}
+
+//!
+void Evaluator::buildValidMasks(int dimension)
+{
+    static const int dirs[4][2] = { {0, 1}, {1, 0}, {1, 1}, {-1, 1} };
+
+    memset(m_valid, 0, sizeof(m_valid));
+    memset(m_reach, 0, sizeof(m_reach));
+
+    for (int d = 0; d < 4; ++d) {
+        int lr = (Board::LineLength - 1) * dirs[d][0];
+        int lc = (Board::LineLength - 1) * dirs[d][1];
+
+        for (int r = 0; r < dimension; ++r) {
+            for (int c = 0; c < dimension; ++c) {
+                int er = r + lr;
+                int ec = c + lc;
+                if ((er >= 0) && (er < dimension) && (ec >= 0) && (ec < dimension)) {
+                    m_valid[d][Board::index(r, c)] = 0xFF;
+                }
+            }
+        }
+    }
+
+    m_validDimension = dimension;
+}
+
+/*!
+  * A window can be open for several colors only if it is empty: a window that holds a ball
+  * is open just for the color of its balls, that is for the greatest value of its cells.
+  */
+void Evaluator::runScalar(int dimension)
+{
+    memset(m_colorScores, 0, sizeof(m_colorScores));
+
+    for (int d = 0; d < 4; ++d) {
+        int delta = s_windowDeltas[d];
+        int first, last;
+        windowRows(d, dimension, first, last);
+
+        for (int p = first; p < last; ++p) {
+            if (!m_valid[d][p]) {
+                continue;
+            }
+
+            int empties = 0;
+            int top = 0;
+            for (int i = 0; i < Board::LineLength; ++i) {
+                int cell = m_cells[p + i * delta];
+                empties += (cell == Board::Empty);
+                top = (cell > top) ? cell : top;
+            }
+
+            int same = 0;
+            for (int i = 0; i < Board::LineLength; ++i) {
+                same += (m_cells[p + i * delta] == top);
+            }
+
+            if ((top != Board::Empty) && (same + empties != Board::LineLength)) {
+                continue; // blocked by balls of different colors
+            }
+
+            if (top == Board::Empty) {
+                // an empty window is open for every color
+                for (int k = 0; k < Board::Colors; ++k) {
+                    m_colorScores[k] += m_weights.m_line[0];
+                }
+                continue;
+            }
+
+            int reachable = 0;
+            for (int i = 0; i < Board::LineLength; ++i) {
+                reachable += m_reach[top - 1][p + i * delta];
+            }
+
+            m_colorScores[top - 1] += m_weights.m_line[Board::LineLength - empties] + m_weights.m_reach * reachable;
+        }
+    }
+}
+
+#ifdef LINES_EVAL_SSE2
+/*!
+  * Processes 16 window starts (one row) per iteration. The weights of the balls are selected in 16 bits
+  * lanes and summed up in 32 bits lanes, the reachable cells are counted in 8 bits lanes and summed up
+  * (_mm_sad_epu8) after each direction, before they could overflow.
+  */
+void Evaluator::runSse2(int dimension)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones16 = _mm_set1_epi16(1);
+    const __m128i length = _mm_set1_epi8(Board::LineLength);
+
+    __m128i lineWeights[Board::LineLength + 1];
+    __m128i lineCounts[Board::LineLength + 1];
+    for (int j = 0; j <= Board::LineLength; ++j) {
+        lineWeights[j] = _mm_set1_epi16(m_weights.m_line[j]);
+        lineCounts[j] = _mm_set1_epi16(short(j));
+    }
+
+    __m128i lineAcc[Board::Colors];
+    __m128i reachSum[Board::Colors];
+    for (int k = 0; k < Board::Colors; ++k) {
+        lineAcc[k] = zero;
+        reachSum[k] = zero;
+    }
+
+    for (int d = 0; d < 4; ++d) {
+        int delta = s_windowDeltas[d];
+        int first, last;
+        windowRows(d, dimension, first, last);
+
+        __m128i reachAcc[Board::Colors];
+        for (int k = 0; k < Board::Colors; ++k) {
+            reachAcc[k] = zero;
+        }
+
+        for (int p = first; p < last; p += 16) {
+            __m128i valid = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_valid[d] + p));
+            if (0 == _mm_movemask_epi8(valid)) {
+                continue;
+            }
+
+            __m128i cells[Board::LineLength];
+            __m128i empties = zero;
+            __m128i top = zero;
+            for (int i = 0; i < Board::LineLength; ++i) {
+                cells[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_cells + p + i * delta));
+                empties = _mm_sub_epi8(empties, _mm_cmpeq_epi8(cells[i], zero));
+                top = _mm_max_epu8(top, cells[i]);
+            }
+
+            __m128i same = zero;
+            for (int i = 0; i < Board::LineLength; ++i) {
+                same = _mm_sub_epi8(same, _mm_cmpeq_epi8(cells[i], top));
+            }
+
+            __m128i allEmpty = _mm_cmpeq_epi8(empties, length);
+            __m128i open = _mm_and_si128(_mm_or_si128(_mm_cmpeq_epi8(_mm_add_epi8(same, empties), length), allEmpty), valid);
+            if (0 == _mm_movemask_epi8(open)) {
+                continue;
+            }
+
+            // the weights of the balls of the open windows
+            __m128i own = _mm_sub_epi8(length, empties);
+            __m128i own16[2] = { _mm_unpacklo_epi8(own, zero), _mm_unpackhi_epi8(own, zero) };
+            __m128i top16[2] = { _mm_unpacklo_epi8(top, zero), _mm_unpackhi_epi8(top, zero) };
+            __m128i open16[2] = { _mm_unpacklo_epi8(open, open), _mm_unpackhi_epi8(open, open) };
+
+            for (int h = 0; h < 2; ++h) {
+                __m128i weight = zero;
+                for (int j = 0; j <= Board::LineLength; ++j) {
+                    weight = _mm_add_epi16(weight, _mm_and_si128(_mm_cmpeq_epi16(own16[h], lineCounts[j]), lineWeights[j]));
+                }
+                weight = _mm_and_si128(weight, open16[h]);
+
+                __m128i empty16 = _mm_cmpeq_epi16(top16[h], zero);
+                for (int k = 1; k <= Board::Colors; ++k) {
+                    __m128i mine = _mm_or_si128(_mm_cmpeq_epi16(top16[h], _mm_set1_epi16(short(k))), empty16);
+                    lineAcc[k - 1] = _mm_add_epi32(lineAcc[k - 1], _mm_madd_epi16(_mm_and_si128(weight, mine), ones16));
+                }
+            }
+
+            // the reachable cells of the open windows that hold balls
+            for (int k = 1; k <= Board::Colors; ++k) {
+                __m128i mine = _mm_and_si128(_mm_cmpeq_epi8(top, _mm_set1_epi8(char(k))), open);
+
+                const unsigned char *reach = m_reach[k - 1] + p;
+                __m128i reachable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(reach));
+                for (int i = 1; i < Board::LineLength; ++i) {
+                    reachable = _mm_add_epi8(reachable, _mm_loadu_si128(reinterpret_cast<const __m128i*>(reach + i * delta)));
+                }
+
+                reachAcc[k - 1] = _mm_add_epi8(reachAcc[k - 1], _mm_and_si128(reachable, mine));
+            }
+        }
+
+        for (int k = 0; k < Board::Colors; ++k) {
+            reachSum[k] = _mm_add_epi64(reachSum[k], _mm_sad_epu8(reachAcc[k], zero));
+        }
+    }
+
+    for (int k = 0; k < Board::Colors; ++k) {
+        int lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), lineAcc[k]);
+
+        long long sums[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), reachSum[k]);
+
+        m_colorScores[k] = lanes[0] + lanes[1] + lanes[2] + lanes[3] + m_weights.m_reach * int(sums[0] + sums[1]);
+    }
+}
+#else
+//!
+void Evaluator::runSse2(int dimension)
+{
+    runScalar(dimension);
+}
+#endif
+
+#ifdef LINES_EVAL_AVX2
+/*!
+  * The same as runSse2() with 32 window starts (two rows) per iteration; the masks of the valid
+  * starts are zero beyond the last row.
+  */
+LINES_TARGET_AVX2 void Evaluator::runAvx2(int dimension)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones16 = _mm256_set1_epi16(1);
+    const __m256i length = _mm256_set1_epi8(Board::LineLength);
+
+    __m256i lineWeights[Board::LineLength + 1];
+    __m256i lineCounts[Board::LineLength + 1];
+    for (int j = 0; j <= Board::LineLength; ++j) {
+        lineWeights[j] = _mm256_set1_epi16(m_weights.m_line[j]);
+        lineCounts[j] = _mm256_set1_epi16(short(j));
+    }
+
+    __m256i lineAcc[Board::Colors];
+    __m256i reachSum[Board::Colors];
+    for (int k = 0; k < Board::Colors; ++k) {
+        lineAcc[k] = zero;
+        reachSum[k] = zero;
+    }
+
+    for (int d = 0; d < 4; ++d) {
+        int delta = s_windowDeltas[d];
+        int first, last;
+        windowRows(d, dimension, first, last);
+
+        __m256i reachAcc[Board::Colors];
+        for (int k = 0; k < Board::Colors; ++k) {
+            reachAcc[k] = zero;
+        }
+
+        for (int p = first; p < last; p += 32) {
+            __m256i valid = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_valid[d] + p));
+            if (0 == _mm256_movemask_epi8(valid)) {
+                continue;
+            }
+
+            __m256i cells[Board::LineLength];
+            __m256i empties = zero;
+            __m256i top = zero;
+            for (int i = 0; i < Board::LineLength; ++i) {
+                cells[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_cells + p + i * delta));
+                empties = _mm256_sub_epi8(empties, _mm256_cmpeq_epi8(cells[i], zero));
+                top = _mm256_max_epu8(top, cells[i]);
+            }
+
+            __m256i same = zero;
+            for (int i = 0; i < Board::LineLength; ++i) {
+                same = _mm256_sub_epi8(same, _mm256_cmpeq_epi8(cells[i], top));
+            }
+
+            __m256i allEmpty = _mm256_cmpeq_epi8(empties, length);
+            __m256i open = _mm256_and_si256(_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_add_epi8(same, empties), length), allEmpty), valid);
+            if (0 == _mm256_movemask_epi8(open)) {
+                continue;
+            }
+
+            // the unpacking interleaves inside the 128 bits halves; the order of the lanes does not matter for the sums
+            __m256i own = _mm256_sub_epi8(length, empties);
+            __m256i own16[2] = { _mm256_unpacklo_epi8(own, zero), _mm256_unpackhi_epi8(own, zero) };
+            __m256i top16[2] = { _mm256_unpacklo_epi8(top, zero), _mm256_unpackhi_epi8(top, zero) };
+            __m256i open16[2] = { _mm256_unpacklo_epi8(open, open), _mm256_unpackhi_epi8(open, open) };
+
+            for (int h = 0; h < 2; ++h) {
+                __m256i weight = zero;
+                for (int j = 0; j <= Board::LineLength; ++j) {
+                    weight = _mm256_add_epi16(weight, _mm256_and_si256(_mm256_cmpeq_epi16(own16[h], lineCounts[j]), lineWeights[j]));
+                }
+                weight = _mm256_and_si256(weight, open16[h]);
+
+                __m256i empty16 = _mm256_cmpeq_epi16(top16[h], zero);
+                for (int k = 1; k <= Board::Colors; ++k) {
+                    __m256i mine = _mm256_or_si256(_mm256_cmpeq_epi16(top16[h], _mm256_set1_epi16(short(k))), empty16);
+                    lineAcc[k - 1] = _mm256_add_epi32(lineAcc[k - 1], _mm256_madd_epi16(_mm256_and_si256(weight, mine), ones16));
+                }
+            }
+
+            for (int k = 1; k <= Board::Colors; ++k) {
+                __m256i mine = _mm256_and_si256(_mm256_cmpeq_epi8(top, _mm256_set1_epi8(char(k))), open);
+
+                const unsigned char *reach = m_reach[k - 1] + p;
+                __m256i reachable = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(reach));
+                for (int i = 1; i < Board::LineLength; ++i) {
+                    reachable = _mm256_add_epi8(reachable, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(reach + i * delta)));
+                }
+
+                reachAcc[k - 1] = _mm256_add_epi8(reachAcc[k - 1], _mm256_and_si256(reachable, mine));
+            }
+        }
+
+        for (int k = 0; k < Board::Colors; ++k) {
+            reachSum[k] = _mm256_add_epi64(reachSum[k], _mm256_sad_epu8(reachAcc[k], zero));
+        }
+    }
+
+    for (int k = 0; k < Board::Colors; ++k) {
+        int lanes[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), lineAcc[k]);
+
+        long long sums[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), reachSum[k]);
+
+        m_colorScores[k] = lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7] +
+                           m_weights.m_reach * int(sums[0] + sums[1] + sums[2] + sums[3]);
+    }
+}
+#else
+//!
+void Evaluator::runAvx2(int dimension)
+{
+    runSse2(dimension);
+}
+#endif
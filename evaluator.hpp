@@ -0,0 +1,171 @@
+/*!
+  * @file evaluator.hpp
+  * This file contains the declaration of the class Evaluator.
+  */
+#ifndef EVALUATOR_HPP
+#define EVALUATOR_HPP
+
+#include "board.hpp"
+
+/*! \brief The weights of the evaluation heuristic.
+  *
+  * The weights of the balls are 16 bits values because the SIMD kernels select them in 16 bits lanes;
+  * setWeights() clamps all the weights to [-MaxWeight, MaxWeight].
+  */
+struct EvalWeights
+{
+    enum
+    {
+        MaxWeight = 4096
+    };
+
+    /*! The constructor; sets the default weights.
+      */
+    EvalWeights();
+
+    short m_line[Board::LineLength + 1]; /*!< the weight of an open window by the number of its balls */
+    short m_reach; /*!< the weight of an empty cell of an open, not empty, window that a ball of its color can reach */
+    short m_free; /*!< the weight of an empty cell of the board */
+};
+
+/*! This class implements the evaluation function used by the bots and by the hint advisor.
+  *
+  * The board is scanned along the windows of \a Board::LineLength cells the lines are searched on
+  * (W-E, N-S, NW-SE and SW-NE). For every color, a window that holds no ball of another color
+  * ('open' window) scores the weight of the number of its balls plus, if it holds a ball, the weight
+  * of its empty cells that can be reached by a ball of that color; a window holding a ball of another
+  * color ('blocked' window) scores nothing for the color.
+  *
+  * The windows are evaluated by a SSE2 or an AVX2 kernel (16 or 32 window starts per iteration);
+  * the scalar kernel is the reference implementation and every kernel gives exactly the same result.
+  */
+class Evaluator
+{
+public:
+    /*!
+      * The implementations of the evaluation kernel.
+      */
+    enum Kernel
+    {
+        ScalarKernel,
+        Sse2Kernel,
+        Avx2Kernel
+    };
+
+    /*! The constructor.
+      * @param[in] kernel the kernel used by evaluate()
+      */
+    explicit Evaluator(Kernel kernel = bestKernel());
+
+    /*!
+      * @return the fastest kernel supported by the processor
+      */
+    static Kernel bestKernel();
+
+    /*!
+      * @return true if the given kernel was compiled in and is supported by the processor
+      */
+    static bool isSupported(Kernel kernel);
+
+    /*!
+      * @return the name of a kernel
+      */
+    static const char *kernelName(Kernel kernel);
+
+    /*!
+      * @return the kernel used by evaluate()
+      */
+    inline Kernel kernel() const
+    {
+        return m_kernel;
+    }
+
+    /*! Sets the kernel used by evaluate(); falls back to the scalar kernel if the given one is not supported.
+      */
+    void setKernel(Kernel kernel);
+
+    /*!
+      * @return the weights of the heuristic
+      */
+    inline const EvalWeights& weights() const
+    {
+        return m_weights;
+    }
+
+    /*! Sets the weights of the heuristic (clamped to [-EvalWeights::MaxWeight, EvalWeights::MaxWeight]).
+      */
+    void setWeights(const EvalWeights &weights);
+
+    /*! Evaluates a position.
+      * @param[in] board the position
+      * @return the score of the position (the greater, the better)
+      */
+    int evaluate(const Board &board);
+
+    /*! Evaluates a position using the given kernel.
+      * \sa evaluate(const Board &)
+      */
+    int evaluate(const Board &board, Kernel kernel);
+
+    /*! The first step of evaluate(): copies the cells of the board and computes the masks of the
+      * reachable cells. It is public so its cost can be measured apart from the window kernels.
+      * @param[in] board the position
+      */
+    void prepare(const Board &board);
+
+    /*! The second step of evaluate(): scores the windows of the last prepared position.
+      * @param[in] board the position given to the last call of prepare()
+      * @param[in] kernel the kernel
+      * @return the score of the position
+      */
+    int evaluatePrepared(const Board &board, Kernel kernel);
+
+    /*!
+      * @param[in] color the index of the color + 1
+      * @return the score of the windows of the given color computed by the last evaluation
+      */
+    inline int colorScore(int color) const
+    {
+        return m_colorScores[color - 1];
+    }
+
+    /*! Suggests a move: plays every legal move (without the spawning of the next balls) and
+      * picks the one that gives the best sum of the points scored and of the evaluation.
+      *
+      * @param[in] board the position
+      * @param[out] move the suggested move
+      * @param[in] candidates if greater than 0, only this number of moves (the best ones by
+      * Board::moveRank()) are played and evaluated; this is the fast bot of the self-play games
+      * @return false if there is no legal move
+      */
+    bool suggestMove(const Board &board, Board::Move &move, int candidates = 0);
+
+private:
+    enum
+    {
+        Padding = 128 // the bytes after the last cell read by the vector loads of the last windows
+    };
+
+    /*! Builds the masks of the valid window starts for the given dimension.
+      */
+    void buildValidMasks(int dimension);
+
+    void runScalar(int dimension);
+    void runSse2(int dimension);
+    void runAvx2(int dimension);
+
+private:
+    Kernel m_kernel; /*!< the kernel used by evaluate() */
+    EvalWeights m_weights; /*!< the weights of the heuristic */
+
+    unsigned char m_cells[Board::MaxCells + Padding]; /*!< the cells of the evaluated board */
+    unsigned char m_reach[Board::Colors][Board::MaxCells + Padding]; /*!< m_reach[c - 1][p] is 1 if the empty cell p can be reached by a ball of the color c */
+    unsigned char m_valid[4][Board::MaxCells + Padding]; /*!< 0xFF if a window of the direction starts at the cell */
+    int m_validDimension; /*!< the dimension the masks of the valid window starts were built for */
+
+    int m_colorScores[Board::Colors]; /*!< the scores of the colors computed by the last evaluation */
+    Board::Move m_moves[Board::MaxMoves]; /*!< the legal moves (used by suggestMove()) */
+    uint64_t m_ranks[Board::MaxMoves]; /*!< the ranked moves (used by suggestMove()) */
+};
+
+#endif // EVALUATOR_HPP
@@ -0,0 +1,332 @@
+/*!
+  * @file exactsolver.cpp
+  * This file contains the definition of the class ExactSolver.
+  */
+
+#include <algorithm>
+#include <thread>
+#include "canonicalboard.hpp"
+#include "exactsolver.hpp"
+
+namespace
+{
+    // Collects the empty cells of a board.
+    int freeCells(const Board &board, int *cells)
+    {
+        int n = 0;
+        for (int r = 0; r < board.dim(); ++r) {
+            for (int c = 0; c < board.dim(); ++c) {
+                int p = Board::index(r, c);
+                if (board.cell(p) == Board::Empty) {
+                    cells[n++] = p;
+                }
+            }
+        }
+
+        return n;
+    }
+
+    // Checks whether some balls of the given colors put on the given cells could form a line:
+    // every line of a spawn is a part of a line of the same color when all the cells take it.
+    bool canFormLine(const Board &board, const int *cells, int count, int colors)
+    {
+        for (int color = 1; color <= colors; ++color) {
+            Board filled(board);
+            for (int i = 0; i < count; ++i) {
+                filled.setCell(cells[i], Board::Cell(color));
+            }
+
+            if (filled.removeLines(cells, count) > 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+//!
+ExactSolver::ExactSolver()
+    : m_colors(2),
+    m_horizon(2),
+    m_threads(1),
+    m_nextMove(0),
+    m_nodes(0),
+    m_hits(0)
+{
+    setThreads(0);
+}
+
+//!
+void ExactSolver::setColors(int colors)
+{
+    m_colors = std::min<int>(Board::Colors, std::max(1, colors));
+}
+
+//!
+void ExactSolver::setThreads(int threads)
+{
+    if (threads <= 0) {
+        threads = int(std::thread::hardware_concurrency());
+    }
+
+    m_threads = (threads > 0) ? threads : 1;
+}
+
+//!
+bool ExactSolver::openTable(size_t entries, size_t memoryLimit, const std::string &spillPath)
+{
+    return m_table.open(entries, memoryLimit, spillPath);
+}
+
+/*!
+  * The threads take the moves of the root one by one; the positions below the root are shared
+  * through the table, so a value computed by a thread is reused by the others.
+  */
+double ExactSolver::solve(const Board &board, Board::Move &move)
+{
+    m_nodes = 0;
+    m_hits = 0;
+
+    std::vector<Board::Move> moves(Board::MaxMoves);
+    int count = board.isGameOver() ? 0 : board.legalMoves(&moves[0]);
+    if (0 == count) {
+        return 0;
+    }
+
+    std::vector<double> values(count, 0);
+    m_nextMove = 0;
+
+    std::vector<std::thread> workers;
+    int threads = std::min(m_threads, count);
+    for (int i = 1; i < threads; ++i) {
+        workers.push_back(std::thread(&ExactSolver::work, this, &board, &moves[0], count, &values[0]));
+    }
+
+    work(&board, &moves[0], count, &values[0]);
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+
+    int best = int(std::max_element(values.begin(), values.end()) - values.begin());
+    move = moves[best];
+
+    return values[best];
+}
+
+//!
+double ExactSolver::moveValue(const Board &board, const Board::Move &move)
+{
+    Counters counters = { 0, 0 };
+    double result = moveValue(board, move, m_horizon, counters);
+
+    m_nodes = counters.m_nodes;
+    m_hits = counters.m_hits;
+
+    return result;
+}
+
+//!
+void ExactSolver::work(const Board *board, const Board::Move *moves, int count, double *values)
+{
+    Counters counters = { 0, 0 };
+
+    while (true) {
+        int i = m_nextMove.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count) {
+            break;
+        }
+
+        values[i] = moveValue(*board, moves[i], m_horizon, counters);
+    }
+
+    m_nodes += counters.m_nodes;
+    m_hits += counters.m_hits;
+}
+
+/*!
+  * The key is the hash of the canonical form mixed with the number of the turns to go; a
+  * collision of two 64 bits keys is unlikely even for billions of entries (about 2^-64 per
+  * pair of positions). A position whose value cannot be stored (the table is full or not
+  * allocated) is computed again when it is met again.
+  */
+double ExactSolver::value(const Board &board, int turns, Counters &counters)
+{
+    if ((turns <= 0) || board.isGameOver()) {
+        return 0;
+    }
+
+    uint64_t key = CanonicalBoard(board).key().hash() ^ Random::mix(uint64_t(turns));
+
+    double result;
+    if (m_table.find(key, result)) {
+        ++counters.m_hits;
+        return result;
+    }
+
+    ++counters.m_nodes;
+
+    Board::Move moves[Board::MaxMoves];
+    int count = board.legalMoves(moves);
+
+    result = 0;
+    for (int i = 0; i < count; ++i) {
+        result = std::max(result, moveValue(board, moves[i], turns, counters));
+    }
+
+    m_table.insert(key, result);
+
+    return result;
+}
+
+//!
+double ExactSolver::moveValue(const Board &board, const Board::Move &move, int turns, Counters &counters)
+{
+    Board next(board);
+    bool enforceHints = next.isHintCell(move.m_to);
+
+    double points = next.applyMove(move);
+    if (next.isGameOver()) {
+        return points;
+    }
+
+    if (enforceHints || (0 == next.hintCount())) {
+        return points + randomSpawnValue(next, turns, counters);
+    }
+
+    // the 'hint' balls become normal balls: the generator is not used
+    Random unused(0);
+    int spawned[Board::HintCount];
+    int n = next.placeSpawn(unused, false, spawned);
+
+    return points + hintsValue(next, spawned, n, turns, counters);
+}
+
+/*!
+  * Board::placeSpawn() draws min(3, free) distinct cells one after the other, so every set of
+  * cells (and every coloring of it) has the same probability. On the last turn only the lines of
+  * the spawned balls count, so the spawns are not enumerated if no line can be formed.
+  */
+double ExactSolver::randomSpawnValue(const Board &board, int turns, Counters &counters)
+{
+    Board base(board);
+    base.clearHints();
+
+    int cells[Board::MaxCells];
+    int f = freeCells(base, cells);
+    int k = std::min<int>(Board::HintCount, f);
+
+    if ((turns <= 1) && !canFormLine(base, cells, f, m_colors)) {
+        return 0;
+    }
+
+    int colorings = 1;
+    for (int i = 0; i < k; ++i) {
+        colorings *= m_colors;
+    }
+
+    // walks the k-subsets of the free cells in lexicographic order
+    int subset[Board::HintCount];
+    for (int i = 0; i < k; ++i) {
+        subset[i] = i;
+    }
+
+    double sum = 0;
+    long long outcomes = 0;
+
+    while (true) {
+        for (int coloring = 0; coloring < colorings; ++coloring) {
+            Board next(base);
+            int spawned[Board::HintCount];
+
+            for (int i = 0, c = coloring; i < k; ++i, c /= m_colors) {
+                spawned[i] = cells[subset[i]];
+                next.setCell(spawned[i], Board::Cell(1 + c % m_colors));
+            }
+
+            sum += hintsValue(next, spawned, k, turns, counters);
+            ++outcomes;
+        }
+
+        int i = k - 1;
+        while ((i >= 0) && (subset[i] == f - k + i)) {
+            --i;
+        }
+
+        if (i < 0) {
+            break;
+        }
+
+        ++subset[i];
+        for (int j = i + 1; j < k; ++j) {
+            subset[j] = subset[j - 1] + 1;
+        }
+    }
+
+    return sum / double(outcomes);
+}
+
+/*!
+  * Board::drawHints() draws min(3, free) distinct cells one after the other (Board::randomFreeCell()
+  * skips the cells that already hold a 'hint' ball), so, as for the spawns, every set of cells and
+  * every coloring of it has the same probability.
+  *
+  * The 'hint' balls do not take their cells, so the lines of the spawned balls do not depend on
+  * them: the lines are removed once, before the draws are enumerated.
+  */
+double ExactSolver::hintsValue(const Board &board, const int *spawned, int n, int turns, Counters &counters)
+{
+    int cells[Board::MaxCells];
+    int f = freeCells(board, cells);
+    int k = std::min<int>(Board::HintCount, f);
+
+    Board base(board);
+    double points = base.removeLines(spawned, n);
+
+    if ((turns <= 1) || (0 == f)) {
+        return points + value(base, turns - 1, counters);
+    }
+
+    int colorings = 1;
+    for (int i = 0; i < k; ++i) {
+        colorings *= m_colors;
+    }
+
+    // walks the k-subsets of the free cells in lexicographic order
+    int subset[Board::HintCount];
+    for (int i = 0; i < k; ++i) {
+        subset[i] = i;
+    }
+
+    double sum = 0;
+    long long outcomes = 0;
+
+    while (true) {
+        for (int coloring = 0; coloring < colorings; ++coloring) {
+            Board next(base);
+            for (int i = 0, c = coloring; i < k; ++i, c /= m_colors) {
+                next.addHint(cells[subset[i]], Board::Cell(1 + c % m_colors));
+            }
+
+            sum += value(next, turns - 1, counters);
+            ++outcomes;
+        }
+
+        int i = k - 1;
+        while ((i >= 0) && (subset[i] == f - k + i)) {
+            --i;
+        }
+
+        if (i < 0) {
+            break;
+        }
+
+        ++subset[i];
+        for (int j = i + 1; j < k; ++j) {
+            subset[j] = subset[j - 1] + 1;
+        }
+    }
+
+    return points + sum / double(outcomes);
+}
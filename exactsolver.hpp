@@ -0,0 +1,157 @@
+/*!
+  * @file exactsolver.hpp
+  * This file contains the declaration of the class ExactSolver.
+  */
+#ifndef EXACTSOLVER_HPP
+#define EXACTSOLVER_HPP
+
+#include <atomic>
+#include <vector>
+#include "board.hpp"
+#include "memotable.hpp"
+
+/*! This class computes the exact expected score of a position on a small board (5x5 to 7x7 with
+  * a few colors), as a ground truth for the heuristic bots.
+  *
+  * The value of a position is the expected number of points of the next \a horizon() turns under
+  * the best play (an exhaustive expectimax): the player nodes take the best of all the legal moves
+  * and the chance nodes average all the outcomes of the spawn rule of Board, each one weighted by
+  * its exact probability. The known 'hint' balls make the spawn after a move deterministic; the next
+  * set of 'hint' balls is three distinct random cells (fewer on a board with fewer free cells) with
+  * random colors, and so are the spawned balls after a ball was moved onto a 'hint' ball. The balls
+  * of the rule have \a colors() colors instead of Board::Colors, which keeps the chance nodes small.
+  * The game is not finite under the best play, hence the horizon; the value of a full board is 0.
+  *
+  * The values are memoized in a MemoTable keyed by the hash of the canonical form of the position
+  * (CanonicalBoard, the values are expectations over the spawns so they are symmetric) and of the
+  * remaining horizon. The table is shared by the threads, which split the moves of the root; it is
+  * mapped onto a spill file when it is larger than the allowed memory.
+  */
+class ExactSolver
+{
+public:
+    /*! The constructor.
+      */
+    ExactSolver();
+
+    /*! Sets the number of the colors of the spawned balls (1 to Board::Colors).
+      */
+    void setColors(int colors);
+
+    /*!
+      * @return the number of the colors of the spawned balls
+      */
+    inline int colors() const
+    {
+        return m_colors;
+    }
+
+    /*! Sets the number of the turns whose points are counted.
+      */
+    inline void setHorizon(int turns)
+    {
+        m_horizon = (turns > 0) ? turns : 1;
+    }
+
+    /*!
+      * @return the number of the turns whose points are counted
+      */
+    inline int horizon() const
+    {
+        return m_horizon;
+    }
+
+    /*! Sets the number of the threads (0 means one thread per core).
+      */
+    void setThreads(int threads);
+
+    /*! Allocates the memoization table.
+      *
+      * @param[in] entries the number of the entries (16 bytes each)
+      * @param[in] memoryLimit the number of the bytes the table may take in memory
+      * @param[in] spillPath the file the table is mapped onto if it is larger than memoryLimit
+      * @return false if the table cannot be allocated
+      */
+    bool openTable(size_t entries, size_t memoryLimit, const std::string &spillPath);
+
+    /*!
+      * @return the memoization table
+      */
+    inline const MemoTable &table() const
+    {
+        return m_table;
+    }
+
+    /*! Computes the exact value of a position and its best move.
+      *
+      * @param[in] board the position (its balls and 'hint' balls must use the first colors() colors)
+      * @param[out] move receives the best move
+      * @return the expected points of the next horizon() turns (0 if there is no legal move)
+      */
+    double solve(const Board &board, Board::Move &move);
+
+    /*! Computes the exact value of a move: the expected points of the next horizon() turns
+      * if the given move is played now and the best moves afterwards.
+      */
+    double moveValue(const Board &board, const Board::Move &move);
+
+    /*!
+      * @return the number of the positions evaluated by the last call
+      */
+    inline long long nodes() const
+    {
+        return m_nodes;
+    }
+
+    /*!
+      * @return the number of the values found in the table by the last call
+      */
+    inline long long hits() const
+    {
+        return m_hits;
+    }
+
+private:
+    /*! \brief The counters of a thread.
+      */
+    struct Counters
+    {
+        long long m_nodes;
+        long long m_hits;
+    };
+
+    /*! The loop of a thread: computes the values of the root moves until all of them are done.
+      */
+    void work(const Board *board, const Board::Move *moves, int count, double *values);
+
+    /*! The value of a position with 'turns' turns to go.
+      */
+    double value(const Board &board, int turns, Counters &counters);
+
+    /*! The value of a move with 'turns' turns to go (the move being the first one).
+      */
+    double moveValue(const Board &board, const Board::Move &move, int turns, Counters &counters);
+
+    /*! The value of the random spawn that follows a move onto a 'hint' ball (or a position without
+      * hints): all the sets of distinct cells and their colors.
+      */
+    double randomSpawnValue(const Board &board, int turns, Counters &counters);
+
+    /*! The value of a position whose spawned balls are on the board but whose lines are not
+      * removed yet: averages all the draws of the next 'hint' balls.
+      */
+    double hintsValue(const Board &board, const int *spawned, int n, int turns, Counters &counters);
+
+private:
+    int m_colors; /*!< the number of the colors of the spawned balls */
+    int m_horizon; /*!< the number of the counted turns */
+    int m_threads; /*!< the number of the threads */
+
+    MemoTable m_table; /*!< the memoized values */
+
+    std::atomic<int> m_nextMove; /*!< the next root move (shared by the threads) */
+    std::atomic<long long> m_nodes; /*!< the positions evaluated by the last call */
+    std::atomic<long long> m_hits; /*!< the values found in the table by the last call */
+};
+
+#endif // EXACTSOLVER_HPP
@@ -0,0 +1,269 @@
+/*!
+  * @file expectimax.cpp
+  * This file contains the definition of the class Expectimax.
+  */
+
+#include <algorithm>
+#include "expectimax.hpp"
+
+namespace
+{
+    // the key of the searched value of a position (the static value is keyed by the hash itself)
+    inline uint64_t searchKey(uint64_t hash, int depth)
+    {
+        return hash ^ Random::mix(uint64_t(depth));
+    }
+}
+
+//!
+Expectimax::Expectimax()
+    : m_table(0),
+    m_stop(0),
+    m_timeBudget(500),
+    m_maxDepth(0),
+    m_samples(8),
+    m_moveLimit(12),
+    m_seed(0x5EEDULL),
+    m_aborted(false),
+    m_depth(0),
+    m_value(0),
+    m_nodes(0)
+{
+    setMaxDepth(3);
+}
+
+//!
+void Expectimax::setMaxDepth(int depth)
+{
+    m_maxDepth = (depth > 0) ? depth : 1;
+
+    m_moves.resize(m_maxDepth + 1);
+    m_scored.resize(m_maxDepth + 1);
+    for (int i = 0; i <= m_maxDepth; ++i) {
+        m_moves[i].resize(Board::MaxMoves);
+    }
+}
+
+//!
+bool Expectimax::bestMove(const Board &board, Board::Move &move)
+{
+    m_nodes = 0;
+    m_depth = 0;
+    m_value = 0;
+    m_aborted = false;
+
+    if (m_table) {
+        m_table->newSearch();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // the first iteration always completes (unless the search is stopped): it gives a value to every root move
+    m_deadline = std::chrono::steady_clock::time_point::max();
+
+    int count = board.legalMoves(&m_moves[0][0]);
+    if (0 == count) {
+        return false;
+    }
+
+    std::vector<ScoredMove> &root = m_scored[0];
+    root.resize(count);
+    for (int i = 0; i < count; ++i) {
+        root[i].m_move = m_moves[0][i];
+        root[i].m_value = 0;
+    }
+
+    std::vector<ScoredMove> iteration;
+    for (int depth = 1; depth <= m_maxDepth; ++depth) {
+        // only the best moves of the previous iteration are searched deeper
+        int n = (depth == 1) ? count : std::min(count, m_moveLimit);
+        iteration.assign(root.begin(), root.begin() + n);
+
+        for (int i = 0; (i < n) && !m_aborted; ++i) {
+            iteration[i].m_value = moveValue(board, iteration[i].m_move, depth, 1);
+        }
+
+        if (m_aborted) {
+            break;
+        }
+
+        std::stable_sort(iteration.begin(), iteration.end());
+        std::copy(iteration.begin(), iteration.end(), root.begin());
+
+        m_depth = depth;
+        m_value = root[0].m_value;
+        move = root[0].m_move;
+
+        if ((1 == depth) && (m_timeBudget > 0)) {
+            m_deadline = start + std::chrono::milliseconds(m_timeBudget);
+        }
+
+        if ((1 == count) || timeUp()) {
+            break;
+        }
+    }
+
+    // only a stopped search can miss its first iteration
+    return m_depth > 0;
+}
+
+//!
+double Expectimax::moveValue(const Board &board, const Board::Move &move, int depth, int ply)
+{
+    Board next(board);
+    bool enforceHints = next.isHintCell(move.m_to);
+
+    double points = next.applyMove(move);
+    if (next.isGameOver()) {
+        return points + GameOverValue;
+    }
+
+    return points + spawnValue(next, enforceHints, depth, ply);
+}
+
+/*!
+  * The 'hint' balls drawn after the last spawn of the search change neither the lines nor the
+  * evaluation, so the known spawn of the last move is evaluated once, without a chance node.
+  */
+double Expectimax::spawnValue(const Board &board, bool enforceHints, int depth, int ply)
+{
+    int spawned[Board::HintCount];
+
+    if (!enforceHints && (board.hintCount() > 0) && (1 == depth)) {
+        Board next(board);
+        Random unused;
+
+        int n = next.placeSpawn(unused, false, spawned);
+        double points = next.removeLines(spawned, n);
+
+        return points + leafValue(next);
+    }
+
+    double sum = 0;
+    for (int s = 0; s < m_samples; ++s) {
+        // common random numbers: the siblings at the same ply draw the same sequences
+        Random rng(Random::mix(m_seed + uint64_t(ply) * 0x100000001B3ULL + uint64_t(s)));
+
+        Board next(board);
+        int n = next.placeSpawn(rng, enforceHints, spawned);
+        next.drawHints(rng);
+        double points = next.removeLines(spawned, n);
+
+        sum += points + ((1 == depth) ? leafValue(next) : maxValue(next, depth - 1, ply));
+        if (m_aborted) {
+            return 0;
+        }
+    }
+
+    return sum / m_samples;
+}
+
+//!
+double Expectimax::maxValue(const Board &board, int depth, int ply)
+{
+    if (board.isGameOver()) {
+        return GameOverValue;
+    }
+
+    uint64_t key = 0;
+    if (m_table) {
+        key = searchKey(board.hash(), depth);
+        TranspositionTable::Entry entry;
+        if (m_table->probe(key, entry) && (entry.m_depth >= depth)) {
+            return entry.m_value;
+        }
+    }
+
+    Board::Move *moves = &m_moves[ply][0];
+    int count = board.legalMoves(moves);
+    if (0 == count) {
+        return leafValue(board);
+    }
+
+    double best = GameOverValue;
+
+    if (1 == depth) {
+        // the children are leaves: the ordering would cost as much as the search
+        for (int i = 0; i < count; ++i) {
+            best = std::max(best, moveValue(board, moves[i], 1, ply + 1));
+            if (m_aborted) {
+                return best;
+            }
+        }
+
+        if (m_table) {
+            m_table->store(key, float(best), depth);
+        }
+
+        return best;
+    }
+
+    // orders the moves by their static value and searches only the best ones
+    std::vector<ScoredMove> &scored = m_scored[ply];
+    scored.resize(count);
+    for (int i = 0; i < count; ++i) {
+        Board next(board);
+        scored[i].m_move = moves[i];
+        scored[i].m_value = next.applyMove(moves[i]) + leafValue(next);
+    }
+
+    int n = std::min(count, m_moveLimit);
+    std::partial_sort(scored.begin(), scored.begin() + n, scored.end());
+
+    Board::Move bestMove = scored[0].m_move;
+    for (int i = 0; i < n; ++i) {
+        double value = moveValue(board, scored[i].m_move, depth, ply + 1);
+        if (value > best) {
+            best = value;
+            bestMove = scored[i].m_move;
+        }
+
+        if (m_aborted) {
+            return best;
+        }
+    }
+
+    if (m_table) {
+        m_table->store(key, float(best), depth, bestMove);
+    }
+
+    return best;
+}
+
+//!
+double Expectimax::leafValue(const Board &board)
+{
+    ++m_nodes;
+    if ((0 == (m_nodes & 255)) && timeUp()) {
+        m_aborted = true;
+    }
+
+    if (board.isGameOver()) {
+        return GameOverValue;
+    }
+
+    if (!m_table) {
+        return m_evaluator.evaluate(board);
+    }
+
+    uint64_t key = board.hash();
+    TranspositionTable::Entry entry;
+    if (m_table->probe(key, entry)) {
+        return entry.m_value;
+    }
+
+    int value = m_evaluator.evaluate(board);
+    m_table->store(key, float(value), 0);
+
+    return value;
+}
+
+//!
+bool Expectimax::timeUp()
+{
+    if (m_stop && m_stop->load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    return std::chrono::steady_clock::now() >= m_deadline;
+}
@@ -0,0 +1,224 @@
+/*!
+  * @file expectimax.hpp
+  * This file contains the declaration of the class Expectimax.
+  */
+#ifndef EXPECTIMAX_HPP
+#define EXPECTIMAX_HPP
+
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include "board.hpp"
+#include "evaluator.hpp"
+#include "transpositiontable.hpp"
+
+/*! This class implements an expectimax search over the moves of the player and the spawning of the balls.
+  *
+  * After a move the visible 'hint' balls become normal balls (see Board::spawn()), so
+  * the spawn that follows a move is known exactly and no chance node is needed for it; only the next
+  * set of 'hint' balls is random. When a ball is moved onto a 'hint' ball the hints are dropped and
+  * the spawn itself becomes random. The random outcomes are handled by chance nodes that average
+  * \a samples() sampled outcomes; the samples are drawn with common random numbers (the same seeds for
+  * all the siblings), which reduces the variance of the comparison between two moves.
+  *
+  * The search deepens iteratively (one move per iteration) until the maximum depth is reached or
+  * the time budget is exhausted; the best move of the last completed iteration is returned. Below the
+  * root only the \a moveLimit() best moves according to the static evaluation are searched.
+  *
+  * If a TranspositionTable is given, the static values and the searched values of the positions
+  * are cached in it (under different keys, the searched values by depth). The chance nodes of
+  * different plies draw different samples, so a cached value may come from other samples than
+  * the ones the search would draw; it is an estimate of the same expectation.
+  */
+class Expectimax
+{
+public:
+    enum
+    {
+        GameOverValue = -1000000 // the value of a full board
+    };
+
+    /*! The constructor.
+      */
+    Expectimax();
+
+    /*!
+      * @return the time budget of a search in milliseconds
+      */
+    inline int timeBudget() const
+    {
+        return m_timeBudget;
+    }
+
+    /*! Sets the time budget of a search.
+      * @param[in] ms the time budget in milliseconds (0 means no limit)
+      */
+    inline void setTimeBudget(int ms)
+    {
+        m_timeBudget = ms;
+    }
+
+    /*!
+      * @return the maximum depth (the number of the moves of the player) of the search
+      */
+    inline int maxDepth() const
+    {
+        return m_maxDepth;
+    }
+
+    /*! Sets the maximum depth of the search.
+      */
+    void setMaxDepth(int depth);
+
+    /*!
+      * @return the number of the sampled outcomes of a chance node
+      */
+    inline int samples() const
+    {
+        return m_samples;
+    }
+
+    /*! Sets the number of the sampled outcomes of a chance node.
+      */
+    inline void setSamples(int samples)
+    {
+        m_samples = (samples > 0) ? samples : 1;
+    }
+
+    /*!
+      * @return the number of the moves searched at the inner nodes
+      */
+    inline int moveLimit() const
+    {
+        return m_moveLimit;
+    }
+
+    /*! Sets the number of the moves searched at the inner nodes.
+      */
+    inline void setMoveLimit(int limit)
+    {
+        m_moveLimit = (limit > 0) ? limit : 1;
+    }
+
+    /*! Sets the seed used to draw the outcomes of the chance nodes.
+      */
+    inline void setSeed(uint64_t seed)
+    {
+        m_seed = seed;
+    }
+
+    /*! Sets the table caching the values of the positions; the table may be shared by several searches.
+      * @param[in] table the table or null to search without a table
+      */
+    inline void setTable(TranspositionTable *table)
+    {
+        m_table = table;
+    }
+
+    /*! Sets a flag that stops the search when it is raised by another thread; the search then
+      * returns the best move of its last completed iteration.
+      * @param[in] flag the flag or null
+      */
+    inline void setStopFlag(const std::atomic<bool> *flag)
+    {
+        m_stop = flag;
+    }
+
+    /*!
+      * @return the evaluator used at the leaves
+      */
+    inline Evaluator &evaluator()
+    {
+        return m_evaluator;
+    }
+
+    /*! Searches the best move.
+      *
+      * @param[in] board the position
+      * @param[out] move the best move
+      * @return false if there is no legal move or if the search was stopped during its first iteration
+      */
+    bool bestMove(const Board &board, Board::Move &move);
+
+    /*!
+      * @return the depth of the last completed iteration of the last search
+      */
+    inline int depth() const
+    {
+        return m_depth;
+    }
+
+    /*!
+      * @return the expected value of the best move found by the last search
+      */
+    inline double value() const
+    {
+        return m_value;
+    }
+
+    /*!
+      * @return the number of the evaluated positions during the last search
+      */
+    inline long long nodes() const
+    {
+        return m_nodes;
+    }
+
+private:
+    /*! \brief A move and its value.
+      */
+    struct ScoredMove
+    {
+        Board::Move m_move; /*!< the move */
+        double m_value; /*!< the value of the move */
+
+        inline bool operator <(const ScoredMove &other) const
+        {
+            return m_value > other.m_value; // the best moves first
+        }
+    };
+
+    /*! The value of a move: the points scored by it plus the expected value of the spawn that follows.
+      */
+    double moveValue(const Board &board, const Board::Move &move, int depth, int ply);
+
+    /*! The expected value of the spawn that follows a move and of the next (depth - 1) moves.
+      */
+    double spawnValue(const Board &board, bool enforceHints, int depth, int ply);
+
+    /*! The value of the best move at a position, searching depth moves ahead.
+      */
+    double maxValue(const Board &board, int depth, int ply);
+
+    /*! The static value of a position.
+      */
+    double leafValue(const Board &board);
+
+    /*! Checks the clock (every few nodes) and the stop flag.
+      * @return true if the time budget is exhausted or the search is stopped
+      */
+    bool timeUp();
+
+private:
+    Evaluator m_evaluator; /*!< the evaluation function */
+    TranspositionTable *m_table; /*!< the cache of the values of the positions (may be null) */
+    const std::atomic<bool> *m_stop; /*!< the flag stopping the search (may be null) */
+
+    int m_timeBudget; /*!< the time budget in milliseconds */
+    int m_maxDepth; /*!< the maximum depth */
+    int m_samples; /*!< the number of the samples of a chance node */
+    int m_moveLimit; /*!< the number of the moves searched at the inner nodes */
+    uint64_t m_seed; /*!< the seed of the chance nodes */
+
+    std::vector<std::vector<Board::Move> > m_moves; /*!< the legal moves of every ply */
+    std::vector<std::vector<ScoredMove> > m_scored; /*!< the ordered moves of every ply */
+
+    std::chrono::steady_clock::time_point m_deadline; /*!< the end of the time budget */
+    bool m_aborted; /*!< is the time budget exhausted ? */
+
+    int m_depth; /*!< the depth of the last completed iteration */
+    double m_value; /*!< the value of the best move */
+    long long m_nodes; /*!< the number of the evaluated positions */
+};
+
+#endif // EXPECTIMAX_HPP
@@ -0,0 +1,188 @@
+/*!
+  * @file gameengine.cpp
+  * This file contains the definition of the class GameEngine.
+  */
+
+#include "gameengine.hpp"
+
+//!
+GameEngine::GameEngine()
+    : m_stop(false)
+{
+    m_worker = std::thread(&GameEngine::run, this);
+}
+
+//!
+GameEngine::~GameEngine()
+{
+    m_stop = true;
+
+    Command command;
+    command.m_type = Command::Quit;
+    post(command);
+
+    m_worker.join();
+}
+
+//!
+void GameEngine::newGame(int dimension, uint64_t seed)
+{
+    Command command;
+    command.m_type = Command::NewGame;
+    command.m_dimension = (unsigned char)dimension;
+    command.m_seed = seed;
+
+    post(command);
+}
+
+//!
+void GameEngine::move(int from, int to)
+{
+    Command command;
+    command.m_type = Command::Move;
+    command.m_from = (unsigned char)from;
+    command.m_to = (unsigned char)to;
+
+    post(command);
+}
+
+/*!
+  * The lock is only taken to not lose the wake-up of a worker that is about to sleep; the queue
+  * itself is lock-free. The user interface posts a few commands per second, so the queue is never
+  * full in practice; if it is, the producer yields until the worker catches up.
+  */
+void GameEngine::post(const Command &command)
+{
+    while (!m_commands.push(command)) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wakeUp.notify_one();
+}
+
+/*!
+  */
+void GameEngine::run()
+{
+    for (;;) {
+        Command command;
+        while (m_commands.pop(command)) {
+            switch (command.m_type) {
+            case Command::NewGame:
+                m_board = Board(command.m_dimension);
+                m_rng.setSeed(command.m_seed);
+                report(Event::Started, 0, 0, 0, command.m_dimension);
+                spawn(true);
+                settle();
+                break;
+            case Command::Move:
+                play(command.m_from, command.m_to);
+                break;
+            case Command::Quit:
+                return;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wakeUp.wait(lock, [this] { return !m_commands.isEmpty(); });
+    }
+}
+
+/*!
+  * The board is changed as Board::play() changes it, step by step, so that every step can be reported.
+  */
+void GameEngine::play(int from, int to)
+{
+    Board::Move move(from, to);
+    if (m_board.isGameOver() || !m_board.canMove(move)) {
+        report(Event::Rejected, from, to);
+        return;
+    }
+
+    bool enforceHints = m_board.isHintCell(to);
+
+    Board before(m_board);
+    before.setCell(to, before.cell(from));
+    before.setCell(from, Board::Empty);
+
+    report(Event::Moved, from, to);
+    reportCleared(before, m_board.applyMove(move));
+
+    if (!m_board.isGameOver()) {
+        spawn(enforceHints);
+    }
+
+    settle();
+}
+
+//!
+void GameEngine::spawn(bool enforceHints)
+{
+    if (m_board.isGameOver()) {
+        return;
+    }
+
+    int spawned[Board::HintCount];
+    int n = m_board.placeSpawn(m_rng, enforceHints, spawned);
+    for (int i = 0; i < n; ++i) {
+        report(Event::Spawned, spawned[i], 0, m_board.cell(spawned[i]));
+    }
+
+    m_board.drawHints(m_rng);
+
+    report(Event::HintsDropped);
+    for (int i = 0; i < m_board.hintCount(); ++i) {
+        report(Event::Hinted, m_board.hintCell(i), 0, m_board.hintColor(i));
+    }
+
+    Board before(m_board);
+    reportCleared(before, m_board.removeLines(spawned, n));
+}
+
+//!
+void GameEngine::reportCleared(const Board &before, int points)
+{
+    if (points <= 0) {
+        return;
+    }
+
+    for (int r = 0; r < m_board.dim(); ++r) {
+        for (int c = 0; c < m_board.dim(); ++c) {
+            int p = Board::index(r, c);
+            if ((before.cell(p) != Board::Empty) && (m_board.cell(p) == Board::Empty)) {
+                report(Event::Cleared, p);
+            }
+        }
+    }
+
+    report(Event::Scored, 0, 0, 0, points);
+}
+
+//!
+void GameEngine::settle()
+{
+    report(m_board.isGameOver() ? Event::GameOver : Event::Settled, 0, 0, 0, m_board.score());
+}
+
+/*!
+  * The user interface drains the queue once per frame; a full queue only delays the worker.
+  */
+void GameEngine::report(int type, int cell, int target, int color, int value)
+{
+    Event event;
+    event.m_type = (unsigned char)type;
+    event.m_cell = (unsigned char)cell;
+    event.m_target = (unsigned char)target;
+    event.m_color = (unsigned char)color;
+    event.m_value = value;
+
+    while (!m_events.push(event)) {
+        if (m_stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
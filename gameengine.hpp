@@ -0,0 +1,153 @@
+/*!
+  * @file gameengine.hpp
+  * This file contains the declaration of the class GameEngine.
+  */
+#ifndef GAMEENGINE_HPP
+#define GAMEENGINE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "board.hpp"
+#include "spscqueue.hpp"
+
+/*! This class runs the rules of the game on a worker thread.
+  *
+  * The thread of the user interface posts the commands (a new game, a move) into a lock-free queue
+  * and never waits for them: the worker owns the board, plays the commands in order and reports
+  * every change of the board as an event into a second lock-free queue. The user interface drains
+  * the events once per frame and only renders them.
+  *
+  * A turn is reported as: Moved (or Rejected), Cleared for every ball of the lines formed by the
+  * move, Scored, Spawned for every new ball, HintsDropped, Hinted for every new 'hint' ball,
+  * Cleared and Scored for the lines formed by the spawned balls and finally Settled (or GameOver).
+  * A new game is reported as Started followed by the events of the first spawn.
+  */
+class GameEngine
+{
+public:
+    /*! \brief A command posted by the user interface.
+      */
+    struct Command
+    {
+        enum Type
+        {
+            NewGame, // starts a new game
+            Move,    // moves a ball
+            Quit     // stops the worker
+        };
+
+        unsigned char m_type; /*!< the type of the command */
+        unsigned char m_from; /*!< Move: the cell of the ball */
+        unsigned char m_to; /*!< Move: the target cell */
+        unsigned char m_dimension; /*!< NewGame: the dimension of the board */
+        uint64_t m_seed; /*!< NewGame: the seed of the spawns */
+    };
+
+    /*! \brief A change of the board reported by the worker.
+      */
+    struct Event
+    {
+        enum Type
+        {
+            Started,      // a new game is started; m_value is the dimension
+            Moved,        // the ball of m_cell is moved onto m_target
+            Rejected,     // the move from m_cell onto m_target is not legal
+            Spawned,      // a ball of the color m_color appears on m_cell
+            HintsDropped, // the remaining 'hint' balls are dropped
+            Hinted,       // a 'hint' ball of the color m_color is shown on m_cell
+            Cleared,      // the ball of m_cell is removed by a line
+            Scored,       // the lines just removed are worth m_value points
+            Settled,      // the position is fixed and waits for a move; m_value is the score
+            GameOver      // the board is full; m_value is the score
+        };
+
+        unsigned char m_type; /*!< the type of the event */
+        unsigned char m_cell; /*!< the cell (an index in the array of the cells of Board) */
+        unsigned char m_target; /*!< the target cell of a move */
+        unsigned char m_color; /*!< the color of a ball (the index of the color + 1) */
+        int m_value; /*!< the value of the event (see Type) */
+    };
+
+    /*! The constructor; starts the worker thread.
+      */
+    GameEngine();
+
+    /*! The destructor; stops the worker thread.
+      */
+    ~GameEngine();
+
+    /*! Posts a new game.
+      * @param[in] dimension the dimension of the board
+      * @param[in] seed the seed of the spawns
+      */
+    void newGame(int dimension, uint64_t seed);
+
+    /*! Posts a move; the move is checked by the worker (see Event::Rejected).
+      * @param[in] from the cell of the ball
+      * @param[in] to the target cell
+      */
+    void move(int from, int to);
+
+    /*! Takes the next event; it never waits.
+      * @param[out] event receives the event
+      * @return false if there is no pending event
+      */
+    inline bool pollEvent(Event &event)
+    {
+        return m_events.pop(event);
+    }
+
+private:
+    GameEngine(const GameEngine &);
+    GameEngine &operator =(const GameEngine &);
+
+    enum
+    {
+        CommandCapacity = 64,
+        EventCapacity = 1024
+    };
+
+    /*! Queues a command and wakes the worker up.
+      */
+    void post(const Command &command);
+
+    /*! The loop of the worker thread.
+      */
+    void run();
+
+    /*! Plays a move and the spawn that follows it.
+      */
+    void play(int from, int to);
+
+    /*! Spawns the next balls as Board::spawn() does and reports them.
+      */
+    void spawn(bool enforceHints);
+
+    /*! Reports the balls of the board 'before' that are not on the board any more and the points scored.
+      */
+    void reportCleared(const Board &before, int points);
+
+    /*! Reports the end of a turn.
+      */
+    void settle();
+
+    /*! Queues an event; waits while the queue is full.
+      */
+    void report(int type, int cell = 0, int target = 0, int color = 0, int value = 0);
+
+private:
+    Board m_board; /*!< the board; used by the worker only */
+    Random m_rng; /*!< the generator of the spawns; used by the worker only */
+
+    SpscQueue<Command, CommandCapacity> m_commands; /*!< from the user interface to the worker */
+    SpscQueue<Event, EventCapacity> m_events; /*!< from the worker to the user interface */
+
+    std::mutex m_mutex; /*!< guards the sleep of the worker only */
+    std::condition_variable m_wakeUp; /*!< signalled when a command is posted */
+    std::atomic<bool> m_stop; /*!< is the worker stopped ? */
+    std::thread m_worker; /*!< the worker thread */
+};
+
+#endif // GAMEENGINE_HPP
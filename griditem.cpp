@@ -10,33 +10,50 @@
 #include <QPen>
 #include <QGraphicsSceneMouseEvent>
 #include <QMessageBox>
+#include <QtCore/QtMath>
 #include <QtCore/QVector>
-#include <QtCore/QTime>
-#include <QtCore/QEventLoop>
 #include <QtCore/QCoreApplication>
 #include "ballitem.hpp"
 #include "griditem.hpp"
 #include "gridpos.hpp"
 #include "pathfinder.hpp"
 #include "boardview.hpp"
-#include "linestracker.hpp"
 #include "mainwidget.hpp"
 #include "ballitemsprovider.hpp"
 #include "utils.hpp"
+#include "paintprofile.hpp"
 
 //!
 GridItem::GridItem(int dimension)
-    : m_dimension(9),
+    : m_dimension(dimension),
     m_penWidth(1),
-    m_ballSelected(false)
+    m_renderMode(ItemRendering),
+    m_ballSelected(false),
+    m_hoverPos(-1, -1),
+    m_hoverPending(false),
+    m_hintPending(false),
+    m_pendingGames(0),
+    m_moving(false),
+    m_processingEvents(false)
 {
     m_squareSize = isRunningOnDesktop() ? 50 : 20;
 
-    for (int i = 0; i < dimension; ++i) {
-        memset(reinterpret_cast<void*>(&m_balls[i]), 0, sizeof(int) * m_dimension);
-    }
-
     m_size = m_dimension * m_dimension;
+    m_balls.fill(0, m_size);
+    m_centers.resize(m_size);
+
+    m_tilesPerSide = (m_dimension + TileSquares - 1) / TileSquares;
+    m_tiles.resize(m_tilesPerSide * m_tilesPerSide);
+    m_tileScale = 0;
+
+    m_looks.fill(0, m_size);
+    m_dirtyCells.fill(false, m_size);
+
+    m_gridLayerDpr = 0;
+    m_originX = 0;
+    m_originY = 0;
+
+    m_clock.start();
 }
 
 //!
@@ -46,33 +63,331 @@ GridItem::~GridItem()
 }
 
 /*!
-* Computes the bounding rect of the grid.
+* The rect is computed by updateGeometry().
 */
 QRectF GridItem::boundingRect() const
 {
+    return m_rect;
+}
+
+/*!
+* Computes the bounding rect of the grid from the size of the scene and the table of the centers of
+* the squares. The cached layer of the grid is dropped if the rect changes.
+*/
+void GridItem::updateGeometry()
+{
+    QRectF rect;
+
     QGraphicsScene *grscene = scene();
     if (grscene) {
         qreal w = grscene->width();
         qreal h = grscene->height();
 
-        return QRectF((-w - m_penWidth)/2, (-h - m_penWidth)/2, w + m_penWidth, h + m_penWidth);
+        rect = QRectF((-w - m_penWidth)/2, (-h - m_penWidth)/2, w + m_penWidth, h + m_penWidth);
+    }
+
+    if (rect == m_rect) {
+        return;
+    }
+
+    prepareGeometryChange();
+    m_rect = rect;
+
+    m_originX = int(m_rect.x());
+    m_originY = int(m_rect.y());
+
+    for (int row = 0; row < m_dimension; ++row) {
+        for (int col = 0; col < m_dimension; ++col) {
+            m_centers[square(row, col)] = QPoint(m_originX + m_squareSize * col + m_squareSize/2,
+                                                 m_originY + m_squareSize * row + m_squareSize/2);
+        }
+    }
+
+    m_gridLayer = QPixmap();
+    invalidateTiles();
+}
+
+/*!
+*/
+QVariant GridItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if (change == ItemSceneHasChanged) {
+        updateGeometry();
     }
 
-    return QRectF();
+    return QGraphicsItem::itemChange(change, value);
+}
+
+/*!
+* The looks are synced with the balls at the next flushDirtyRegion(), which repaints every square.
+*/
+void GridItem::setRenderMode(RenderMode mode)
+{
+    m_renderMode = mode;
+
+    // the exposed rect is given to paint() only to the items that ask for it
+    setFlag(ItemUsesExtendedStyleOption, mode == BatchedRendering);
+
+    for (int row = 0; row < m_dimension; ++row) {
+        for (int col = 0; col < m_dimension; ++col) {
+            BallItem *ball = m_balls[square(row, col)];
+            if (ball && !m_animatedBalls.contains(ball)) {
+                ball->setVisible(mode == ItemRendering);
+            }
+            markCellDirty(row, col);
+        }
+    }
 }
 
 /*!
-* Renders the grid onto the screen.
+* Renders the grid onto the screen: a blit of the cached layer of the border and of the lines (or,
+* in the batched mode, of the tiles that intersect the exposed rect) and then the path tracker.
+* In the batched mode the balls at the squares of the path are blitted again above it, as the
+* ball items are. When a square is smaller than CoarseSquareSize pixels on the screen, the batched
+* mode paints blocks of colors instead.
 */
 void GridItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *options, QWidget *widget)
 {
-    Q_UNUSED(options);
     Q_UNUSED(widget);
 
+#if defined(LINES_PAINT_PROFILE)
+    PaintTimer timer(PaintProfile::GridPaint);
+#endif
+
+    qreal dpr = painter->device()->devicePixelRatioF();
+
+    if (m_renderMode == BatchedRendering) {
+        qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+        if (lod * m_squareSize < CoarseSquareSize) {
+            paintCoarse(painter, options->exposedRect);
+            return;
+        }
+
+        paintTiles(painter, options->exposedRect, dpr * lod);
+    } else {
+        if (m_gridLayer.isNull() || (m_gridLayerDpr != dpr)) {
+            renderGridLayer(dpr);
+        }
+
+        painter->drawPixmap(QPointF(qFloor(m_rect.x()), qFloor(m_rect.y())), m_gridLayer);
+    }
+
+    // render the path tracker
+    int lineCount = m_pathTracker.lineCount();
+    if (lineCount) {
+        painter->setPen(QPen(Qt::black, m_penWidth));
+        painter->drawLines(m_pathTracker.lines(), lineCount);
+
+        // the starts of the segments and the end of the last one: every square once
+        if (m_renderMode == BatchedRendering) {
+            for (int i = 0; i < lineCount; ++i) {
+                paintBalls(painter, QRectF(m_pathTracker.line(i).p1(), QSizeF(0, 0)));
+            }
+            paintBalls(painter, QRectF(m_pathTracker.line(lineCount - 1).p2(), QSizeF(0, 0)));
+        }
+    }
+}
+
+/*!
+* The tiles are rendered for the scale of the painted device, rounded to a quarter, so a zoomed
+* view stays sharp; a change of the scale drops them.
+*/
+void GridItem::paintTiles(QPainter *painter, const QRectF &exposed, qreal scale)
+{
+    scale = qMax(qreal(0.25), qCeil(scale * 4) / qreal(4));
+    if (scale != m_tileScale) {
+        invalidateTiles();
+        m_tileScale = scale;
+    }
+
+    int tileSize = m_squareSize * TileSquares;
+    int col1 = qMax(0, qFloor((exposed.left() - m_originX) / tileSize));
+    int col2 = qMin(m_tilesPerSide - 1, qFloor((exposed.right() - m_originX) / tileSize));
+    int row1 = qMax(0, qFloor((exposed.top() - m_originY) / tileSize));
+    int row2 = qMin(m_tilesPerSide - 1, qFloor((exposed.bottom() - m_originY) / tileSize));
+
+    for (int row = row1; row <= row2; ++row) {
+        for (int col = col1; col <= col2; ++col) {
+            QPixmap &tile = m_tiles[row * m_tilesPerSide + col];
+            if (tile.isNull()) {
+                tile = renderTile(row, col, scale);
+            }
+
+            painter->drawPixmap(tileRect(row, col).topLeft(), tile);
+        }
+    }
+}
+
+/*!
+* The lines that bound the tile are drawn by both tiles they separate, each one clipped to its own
+* pixmap, so the tiles put side by side look like the layer of the item mode.
+*/
+QPixmap GridItem::renderTile(int tileRow, int tileCol, qreal scale)
+{
+    QRect rc = tileRect(tileRow, tileCol);
+
+    QPixmap tile(qCeil(rc.width() * scale), qCeil(rc.height() * scale));
+    tile.setDevicePixelRatio(scale);
+    tile.fill(Qt::transparent);
+
+    QPainter tilePainter(&tile);
+    QPainter *painter = &tilePainter;
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->translate(-rc.x(), -rc.y());
+
     painter->setPen(QPen(QColor(255, 0, 255), m_penWidth));
-    painter->drawRect(boundingRect());
+    painter->drawRect(m_rect);
+
+    int col1 = tileCol * TileSquares;
+    int col2 = qMin(m_dimension, col1 + TileSquares);
+    int row1 = tileRow * TileSquares;
+    int row2 = qMin(m_dimension, row1 + TileSquares);
+
+    // the lines between the squares of the tile and on its sides
+    for (int i = qMax(1, col1); i <= qMin(m_dimension - 1, col2); ++i) {
+        int x = m_originX + i * m_squareSize;
+        painter->drawLine(x, rc.top(), x, rc.bottom() + 1);
+    }
+    for (int i = qMax(1, row1); i <= qMin(m_dimension - 1, row2); ++i) {
+        int y = m_originY + i * m_squareSize;
+        painter->drawLine(rc.left(), y, rc.right() + 1, y);
+    }
 
-    QRectF rc = boundingRect();
+    paintBalls(painter, QRectF(m_originX + col1 * m_squareSize, m_originY + row1 * m_squareSize,
+                               (col2 - col1) * m_squareSize - 1, (row2 - row1) * m_squareSize - 1));
+
+    return tile;
+}
+
+/*!
+*/
+QRect GridItem::tileRect(int tileRow, int tileCol) const
+{
+    int col1 = tileCol * TileSquares;
+    int col2 = qMin(m_dimension, col1 + TileSquares);
+    int row1 = tileRow * TileSquares;
+    int row2 = qMin(m_dimension, row1 + TileSquares);
+
+    int left = (col1 == 0) ? qFloor(m_rect.left()) - 1 : m_originX + col1 * m_squareSize;
+    int right = (col2 == m_dimension) ? qCeil(m_rect.right()) + 1 : m_originX + col2 * m_squareSize;
+    int top = (row1 == 0) ? qFloor(m_rect.top()) - 1 : m_originY + row1 * m_squareSize;
+    int bottom = (row2 == m_dimension) ? qCeil(m_rect.bottom()) + 1 : m_originY + row2 * m_squareSize;
+
+    return QRect(left, top, right - left, bottom - top);
+}
+
+/*!
+*/
+void GridItem::invalidateTiles()
+{
+    for (int i = 0; i < m_tiles.count(); ++i) {
+        m_tiles[i] = QPixmap();
+    }
+}
+
+/*!
+* The lines and the 'hint' balls are left out: they would be smaller than a pixel.
+*/
+void GridItem::paintCoarse(QPainter *painter, const QRectF &exposed)
+{
+    int col1 = qMax(0, qFloor((exposed.left() - m_originX) / m_squareSize));
+    int col2 = qMin(m_dimension - 1, qFloor((exposed.right() - m_originX) / m_squareSize));
+    int row1 = qMax(0, qFloor((exposed.top() - m_originY) / m_squareSize));
+    int row2 = qMin(m_dimension - 1, qFloor((exposed.bottom() - m_originY) / m_squareSize));
+
+    const BallSpriteCache &sprites = BallItemsProvider::instance()->sprites();
+
+    painter->setPen(QPen(QColor(255, 0, 255), 0));
+    painter->drawRect(m_rect);
+
+    for (int row = row1; row <= row2; ++row) {
+        for (int col = col1; col <= col2; ++col) {
+            unsigned char look = m_looks[square(row, col)];
+            if (!look || ((look >> LookStateShift) == BallSpriteCache::Hint)) {
+                continue;
+            }
+
+            painter->fillRect(m_originX + col * m_squareSize, m_originY + row * m_squareSize,
+                              m_squareSize, m_squareSize, sprites.color((look & LookColorMask) - 1));
+        }
+    }
+}
+
+/*!
+* A ball fits in its square whatever its look, so only the squares that intersect the exposed
+* rect are visited: a repaint of a square is a single blit.
+*/
+void GridItem::paintBalls(QPainter *painter, const QRectF &exposed)
+{
+    int col1 = qMax(0, qFloor((exposed.left() - m_originX) / m_squareSize));
+    int col2 = qMin(m_dimension - 1, qFloor((exposed.right() - m_originX) / m_squareSize));
+    int row1 = qMax(0, qFloor((exposed.top() - m_originY) / m_squareSize));
+    int row2 = qMin(m_dimension - 1, qFloor((exposed.bottom() - m_originY) / m_squareSize));
+
+    qreal dpr = painter->device()->devicePixelRatioF();
+    BallSpriteCache &sprites = BallItemsProvider::instance()->sprites();
+
+    for (int row = row1; row <= row2; ++row) {
+        for (int col = col1; col <= col2; ++col) {
+            unsigned char look = m_looks[square(row, col)];
+            if (!look) {
+                continue;
+            }
+
+            const QPixmap &sprite = sprites.sprite((look & LookColorMask) - 1,
+                                                   BallSpriteCache::State(look >> LookStateShift), dpr);
+
+            qreal half = sprite.width() / sprite.devicePixelRatio() / 2;
+            QPoint center = m_centers[square(row, col)];
+            painter->drawPixmap(QPointF(center.x() - half, center.y() - half), sprite);
+        }
+    }
+}
+
+/*!
+*/
+unsigned char GridItem::lookAt(int row, int col) const
+{
+    BallItem *ball = m_balls[square(row, col)];
+    if (!ball || m_animatedBalls.contains(ball)) {
+        return 0;
+    }
+
+    int state = BallSpriteCache::Normal;
+    if (ball->isHint()) {
+        state = BallSpriteCache::Hint;
+    } else if (ball->isSelected()) {
+        state = BallSpriteCache::Selected;
+    }
+
+    return (unsigned char)((state << LookStateShift) | (ball->colorIndex() + 1));
+}
+
+/*!
+* The layer starts at the integral coordinates below the top left corner of the grid, so it is blitted
+* without a resampling.
+*/
+void GridItem::renderGridLayer(qreal dpr)
+{
+    qreal x0 = qFloor(m_rect.x());
+    qreal y0 = qFloor(m_rect.y());
+    int w = qCeil(m_rect.right() - x0) + 1;
+    int h = qCeil(m_rect.bottom() - y0) + 1;
+
+    m_gridLayer = QPixmap(qCeil(w * dpr), qCeil(h * dpr));
+    m_gridLayer.setDevicePixelRatio(dpr);
+    m_gridLayer.fill(Qt::transparent);
+    m_gridLayerDpr = dpr;
+
+    QPainter layerPainter(&m_gridLayer);
+    QPainter *painter = &layerPainter;
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->translate(-x0, -y0);
+
+    painter->setPen(QPen(QColor(255, 0, 255), m_penWidth));
+    painter->drawRect(m_rect);
+
+    QRectF rc = m_rect;
 
     // renders the horizontal lines
     int y1 = int(rc.y());
@@ -89,12 +404,6 @@ void GridItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *options,
         int y = int(i * m_squareSize + rc.y());
         painter->drawLine(x1, y, x2, y);
     }
-
-    // render the path tracker
-    if (m_pathTracker.points().count()) {
-        painter->setPen(QPen(Qt::black, m_penWidth));
-        painter->drawLines(m_pathTracker.points());
-    }
 }
 
 /*!
@@ -104,17 +413,16 @@ void GridItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *options,
 */
 void GridItem::reset()
 {
-    resetAnimation();
+    m_analyzer.clear();
+    m_animatedBalls.clear();
 
     for (int row = 0; row < m_dimension; ++row) {
         for (int col = 0; col < m_dimension; ++col) {
-            BallItem * pBall = m_balls[row][col];
+            BallItem * pBall = m_balls[square(row, col)];
             if (pBall) {
-                pBall->setVisible(false);
-                pBall->setParentItem(0);
-
-                delete m_balls[row][col];
-                m_balls[row][col] = reinterpret_cast<BallItem*>(0);
+                BallItemsProvider::instance()->releaseBall(pBall);
+                m_balls[square(row, col)] = reinterpret_cast<BallItem*>(0);
+                markCellDirty(row, col);
             }
         }
     }
@@ -133,16 +441,16 @@ void GridItem::showBall(BallItem *ball, int row, int col, bool updateInternalStr
     Q_ASSERT(isValidPosition(row, col));
 
     ball->setCoordinates(row, col);
-    if (!ball->isVisible()) {
-        ball->setVisible(true);
+
+    // in the batched mode the grid paints the ball from the look of its square
+    bool visible = (m_renderMode == ItemRendering) || m_animatedBalls.contains(ball);
+    if (ball->isVisible() != visible) {
+        ball->setVisible(visible);
     }
+    markCellDirty(row, col);
 
     if (updateInternalStruct) {
-        m_balls[row][col] = ball;
-
-        // available to used
-        BallItemsProvider::instance()->fromAvailableToUsed(ball->coordinates());
-        //
+        m_balls[square(row, col)] = ball;
     }
 
     QPoint pt;
@@ -175,9 +483,10 @@ BallItem* GridItem::hideBall(BallItem *ball)
     }
 
     ball->setVisible(false);
-    // changes used position to an available one
-    BallItemsProvider::instance()->fromUsedToAvailable(ball->coordinates());
-    //
+    m_animatedBalls.removeOne(ball);
+    if (isValidPosition(ball->coordinates())) {
+        markCellDirty(ball->row(), ball->column());
+    }
 
     freePos(ball->coordinates());
     return ball;
@@ -192,62 +501,153 @@ void GridItem::moveBall(BallItem *ball, const QVector<GridPos> &path)
         return;
     }
 
-    QVector<GridPos> tmpPath(path);
+    GridPos firstPos = path.front();
+    GridPos lastPos = path.back();
 
-    // skip the first square
-    GridPos firstPos = tmpPath.front();
+    // the source square becomes available
     freePos(firstPos);
-    //
 
-    // the source square becomes available
-    BallItemsProvider::instance()->fromUsedToAvailable(firstPos);
-    //
-
-    QGraphicsScene *theScene = scene();
-    Q_ASSERT(theScene);
-    Q_ASSERT(theScene->views().isEmpty() == false);
-
-    theScene->views()[0]->setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
-    foreach(GridPos pos, tmpPath) {
-        if (pos != tmpPath.back()) {
-            // do not store the ball item on the positions of the intermediate squares (the 3rd argument
-            // is set to false).
-            showBall(ball, pos, false);
-            pause(100);
-        } else {
-            // is there any hint ball onto the target square ?
-            BallItem *hintBall = ballAt(pos);
-            if (hintBall) {
-                hideBall(hintBall);
-                delete hintBall;
+    // is there any hint ball onto the target square ?
+    BallItem *hintBall = ballAt(lastPos);
+    if (hintBall) {
+        BallItemsProvider::instance()->releaseBall(hideBall(hintBall));
+    }
 
-                BallItemsProvider::instance()->removeHint(hintBall);
-            }
+    // stores the ball item on the position of the target square; an animation cancelled
+    // half-way leaves the grid consistent
+    setBallAt(lastPos, ball);
+    ball->setCoordinates(lastPos);
+
+    // the ball walks as an item in any mode: in the batched mode it leaves the painted squares
+    // until its walk ends
+    beginItemAnimation(ball);
+    markCellDirty(firstPos.row(), firstPos.column());
+
+    QVector<QPointF> centers;
+    foreach (GridPos pos, path) {
+        QPoint pt;
+        fromGridToCenteredCoordinate(pos, pt);
+        centers.append(pt);
+    }
 
-            // stores the ball item on the position of the target square.
-            showBall(ball, pos, true);
+    // the ball glides from square to square; the scene repaints the squares it crosses at every
+    // frame and the path tracks are wiped square by square
+    int segments = centers.count() - 1;
+    int wiped = 0;
+    m_animations.appendTween([this, ball, centers, segments, wiped](double progress) mutable {
+        if (!m_animatedBalls.contains(ball)) {
+            return;
         }
-        // also wipes the path tracks square by square
-        m_pathTracker.removeFrontLine();
-        update();
+
+        double f = progress * segments;
+        int i = qMin(int(f), segments - 1);
+        ball->setPos(centers[i] + (centers[i + 1] - centers[i]) * (f - i));
+
+        for (; wiped < int(f); ++wiped) {
+            wipePathFront();
+        }
+
+        if (progress >= 1.0) {
+            endItemAnimation(ball);
+        }
+    }, WalkDuration * segments);
+}
+
+/*!
+*/
+void GridItem::beginItemAnimation(BallItem *ball)
+{
+    if (!m_animatedBalls.contains(ball)) {
+        m_animatedBalls.append(ball);
     }
+
+    ball->setVisible(true);
+    markCellDirty(ball->row(), ball->column());
+}
+
+/*!
+*/
+void GridItem::endItemAnimation(BallItem *ball)
+{
+    if (!m_animatedBalls.removeOne(ball)) {
+        return;
+    }
+
+    QPoint pt;
+    fromGridToCenteredCoordinate(ball->coordinates(), pt);
+    ball->setPos(pt.x(), pt.y());
+    ball->setScale(1.0);
+
+    ball->setVisible(m_renderMode == ItemRendering);
+    markCellDirty(ball->row(), ball->column());
+}
+
+/*!
+* The pop-in runs out of the sequence of the animations: the balls of a turn pop in together and the
+* next events are not held back.
+*/
+void GridItem::popIn(BallItem *ball)
+{
+    beginItemAnimation(ball);
+    ball->setScale(0.0);
+
+    m_animations.play([this, ball](double progress) {
+        if (!m_animatedBalls.contains(ball)) {
+            return;
+        }
+
+        if (progress < 1.0) {
+            // eases out: fast at first, slow when it reaches its size
+            ball->setScale(1.0 - (1.0 - progress) * (1.0 - progress));
+        } else {
+            endItemAnimation(ball);
+        }
+    }, PopInDuration);
+}
+
+/*!
+* The events are rendered in turbo mode: every animation they schedule is finished at once.
+*/
+void GridItem::fastForward()
+{
+    bool turbo = m_animations.isTurbo();
+
+    m_animations.setTurbo(true);
+    processEngineEvents();
+    m_animations.setTurbo(turbo);
 }
 
 /*!
 */
 void GridItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
 {
-    if (event->button() != Qt::LeftButton) {
+    if ((event->button() != Qt::LeftButton) || !isPlayable()) {
         event->ignore();
         return;
     }
 
+    // the player does not wait for an animation: it is finished at once
+    if (m_moving || m_animations.isBusy()) {
+        fastForward();
+    }
+
+    // the engine has not reported the whole turn yet
+    if (m_moving) {
+        event->ignore();
+        return;
+    }
+
+    // the player is back: the analysis stops, its completed stages are kept
+    m_analyzer.cancel();
+    m_hintPending = false;
+
     GridPos pt;
     fromViewToGridCoordinate(event->pos(), pt);
 
     if (!m_ballSelected && !isFreePos(pt)) {
         m_ballSelected = true;
         m_beginPos = pt;
+        m_hoverPos = GridPos(-1, -1);
         selectBall(m_beginPos);
     }
 }
@@ -261,6 +661,9 @@ void GridItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
         return;
     }
 
+    // the path follows the last square hovered
+    processHover();
+
     GridPos pt;
     fromViewToGridCoordinate(event->pos(), pt);
 
@@ -268,45 +671,19 @@ void GridItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
         m_ballSelected = false;
         selectBall(pt, false);
 
-        // clear the path tracker and repaint the grid
-        m_pathTracker.clear();
-        update();
+        // clear the path tracker and repaint its squares
+        clearPath();
         //
     } else if (isValidPosition(pt) && isFreePos(pt)) {
-        QVector<GridPos>& path = m_pathTracker.path();
+        const QVector<GridPos>& path = m_pathTracker.path();
         if (!path.isEmpty()) {
-            // have we moved onto a square occupied by a hint ball ? if we have then a new set of the hint balls
-            // needs to be generated.
-            BallItem *ball = ballAt(path.back());
-            bool enforceHintBalls = (ball && ball->isHint());
-            //
-
-            moveBall(ballAt(m_beginPos), path);
-
-            // unselect the moving ball
-            ball = ballAt(path.back());
-            ball->select(false);
-            m_ballSelected = false;
+            // the position changes: the results of the analysis are obsolete
+            m_analyzer.clear();
 
-            // searches for the lines of the same ball items that have the same colours.
-            checkLines(ball);
-
-            // do we have more available positions ? if we do then proceed with a new set of ball items.
-            if (!BallItemsProvider::instance()->availableIndexes().isEmpty()) {
-                // get the next set of balls
-                const QList<BallItem*> &currentBalls = BallItemsProvider::instance()->nextBalls(enforceHintBalls);
-                // searches for the lines of the same ball items that have the same colours.
-                checkLines(currentBalls);
-            } 
-            
-            // even more available positions ? if not then quit or reset the game.
-            if (BallItemsProvider::instance()->availableIndexes().isEmpty()){
-                if (promptForGameEnd()) {
-                    QCoreApplication::quit();
-                } else {
-                    MainWidget::instance()->boardView()->reset();
-                } 
-            }
+            // the engine plays the turn; the ball stays selected until the move is reported back
+            m_moving = true;
+            m_engine.move(Board::index(m_beginPos.row(), m_beginPos.column()),
+                          Board::index(path.back().row(), path.back().column()));
         }
     }
 }
@@ -315,7 +692,7 @@ void GridItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 */
 void GridItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
-    if (!m_ballSelected) {
+    if (!m_ballSelected || m_moving) {
         event->ignore();
         return;
     }
@@ -323,112 +700,137 @@ void GridItem::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
     GridPos pt;
     fromViewToGridCoordinate(event->pos(), pt);
 
-    if (isValidPosition(pt) && isFreePos(pt) && (pt != m_beginPos)) {
-        m_pathTracker.clear();
-
-        QVector<GridPos>& path = m_pathTracker.path();
-        bool found = PathFinder::instance()->execute(this, m_beginPos, pt, path);
-
-        if (found && (path.count() >= 2)) {
-            int n = path.count();
-            for (int i = 0; i < n-1; ++i) {
-                QPoint pt1;
-                fromGridToCenteredCoordinate(path.at(i), pt1);
-
-                QPoint pt2;
-                fromGridToCenteredCoordinate(path.at(i+1), pt2);
-
-                m_pathTracker.addLine(pt1, pt2);
-            }
-
-            update(); // repaint the grid
-        }
+    // the path is searched at the next frame, once the pointer has entered another square
+    if (isValidPosition(pt) && isFreePos(pt) && (pt != m_beginPos) && (pt != m_hoverPos)) {
+        m_hoverPos = pt;
+        m_hoverPending = true;
     }
 }
 
 /*!
 */
-void GridItem::checkLines(BallItem *ball)
+void GridItem::processHover()
 {
-    QList<BallItem*> *list = new QList<BallItem*>;
-    list->push_back(ball);
-
-    checkLines(*list);
+    if (!m_hoverPending) {
+        return;
+    }
+    m_hoverPending = false;
 
-    delete list;
+    GridPos pos = m_hoverPos;
+    if (m_ballSelected && !m_moving && isValidPosition(pos) && isFreePos(pos) && (pos != m_beginPos)) {
+        trackPath(pos);
+    }
 }
 
 /*!
+* The path is read from the background analysis when its paths are ready; otherwise it is searched.
+* The segments the new path shares with the old one, from the selected ball on, are kept; only the
+* other segments of both paths are repainted.
 */
-void GridItem::checkLines(const QList<BallItem*> &balls)
+bool GridItem::trackPath(GridPos &pos)
 {
-    if (0 == balls.count())
-        return;
+    QVector<GridPos> path;
+    bool found = false;
 
-    LinesTracker::set_of_positions_t *positions = new LinesTracker::set_of_positions_t;
+    if (m_analyzer.stage() >= Analyzer::Paths) {
+        std::vector<int> cells;
+        found = m_analyzer.path(Board::index(m_beginPos.row(), m_beginPos.column()),
+                                Board::index(pos.row(), pos.column()), cells);
 
-    int n = balls.count();
-    for (int i = 0; i < n; ++i) {
-        LinesTracker::instance()->search(this, balls[i]);
+        for (size_t i = 0; i < cells.size(); ++i) {
+            path.append(GridPos(Board::row(cells[i]), Board::column(cells[i])));
+        }
+    } else {
+        found = PathFinder::instance()->execute(this, m_beginPos, pos, path);
+    }
 
-        if (LinesTracker::instance()->horizontalLine().count() >= 5)
-            insertIntoPositionSet(*positions, LinesTracker::instance()->horizontalLine());
+    if (!found || (path.count() < 2)) {
+        clearPath();
+        return false;
+    }
 
-        if (LinesTracker::instance()->verticalLine().count() >= 5)
-            insertIntoPositionSet(*positions, LinesTracker::instance()->verticalLine());
+    QVector<QLine> lines;
+    for (int i = 0; i < path.count() - 1; ++i) {
+        QPoint pt1;
+        fromGridToCenteredCoordinate(path.at(i), pt1);
 
-        if (LinesTracker::instance()->diag1Line().count() >= 5)
-            insertIntoPositionSet(*positions, LinesTracker::instance()->diag1Line());
+        QPoint pt2;
+        fromGridToCenteredCoordinate(path.at(i+1), pt2);
 
-        if (LinesTracker::instance()->diag2Line().count() >= 5)
-            insertIntoPositionSet(*positions, LinesTracker::instance()->diag2Line());
+        lines.append(QLine(pt1, pt2));
+    }
 
-        LinesTracker::instance()->clear();
+    int kept = 0;
+    while ((kept < m_pathTracker.lineCount()) && (kept < lines.count()) && (m_pathTracker.line(kept) == lines[kept])) {
+        ++kept;
     }
 
-    if (positions->count()) {
-        animateBalls(*positions);
+    // repaints the segments of the old path that are dropped and the new ones
+    for (int i = kept; i < m_pathTracker.lineCount(); ++i) {
+        markDirty(lineBounds(m_pathTracker.line(i)));
+    }
+    m_pathTracker.truncate(kept);
 
-        int score = removeLines(*positions);
-        MainWidget::instance()->updateScore(score);
+    for (int i = kept; i < lines.count(); ++i) {
+        m_pathTracker.addLine(lines[i].p1(), lines[i].p2());
+        markDirty(lineBounds(lines[i]));
     }
 
-    delete positions;
+    m_pathTracker.path() = path;
+
+    return true;
 }
 
 /*!
 */
-int GridItem::removeLines(LinesTracker::set_of_positions_t &positions)
+QRectF GridItem::lineBounds(const QLine &line) const
 {
-    int score = 0;
+    return QRectF(QPointF(line.p1()), QPointF(line.p2())).normalized().adjusted(-m_penWidth - 1, -m_penWidth - 1,
+                                                                                m_penWidth + 1, m_penWidth + 1);
+}
 
-    foreach (GridPos pos, positions) {
-        BallItem *ball = hideBall(pos);
-        if (ball)
-            delete ball;
+/*!
+* A path that is cleared is searched again when the pointer hovers the same square.
+*/
+void GridItem::clearPath()
+{
+    for (int i = 0; i < m_pathTracker.lineCount(); ++i) {
+        markDirty(lineBounds(m_pathTracker.line(i)));
     }
+    m_pathTracker.clear();
 
-    int n = positions.size();
-    score += (n-1) * 150;
+    m_hoverPos = GridPos(-1, -1);
+    m_hoverPending = false;
+}
 
-    return score;
+/*!
+*/
+void GridItem::wipePathFront()
+{
+    if (m_pathTracker.lineCount() < 1) {
+        return;
+    }
+
+    markDirty(lineBounds(m_pathTracker.line(0)));
+    m_pathTracker.removeFrontLine();
 }
 
 /*!
 */
-void GridItem::animateBalls(LinesTracker::set_of_positions_t &positions)
+void GridItem::animateBalls(const QList<GridPos> &positions)
 {
     bool selected = true;
 
     int steps = 5;
     while (--steps >= 0) {
-        foreach (GridPos pos, positions) {
-            ballAt(pos)->select(selected);
-        }
-        update();
+        m_animations.append([this, positions, selected] {
+            foreach (GridPos pos, positions) {
+                ballAt(pos)->select(selected);
+                markCellDirty(pos.row(), pos.column());
+            }
+        }, BlinkDuration);
 
         selected = !selected;
-        pause(150);
     }
 }
 
@@ -440,17 +842,18 @@ void GridItem::resetAnimation()
     int steps = 5;
 
     while (--steps >= 0) {
-        for (int i = 0; i < dim(); ++i) {
-            for (int j = 0; j < dim(); ++j) {
-                if (ballAt(i, j)) {
-                    ballAt(i, j)->select(selected);
+        m_animations.append([this, selected] {
+            for (int i = 0; i < dim(); ++i) {
+                for (int j = 0; j < dim(); ++j) {
+                    if (ballAt(i, j)) {
+                        ballAt(i, j)->select(selected);
+                        markCellDirty(i, j);
+                    }
                 }
             }
-        }
-        update();
+        }, BlinkDuration);
 
         selected = !selected;
-        pause(150);
     }
 }
 
@@ -464,13 +867,7 @@ void GridItem::fromGridToCenteredCoordinate(int row, int col, QPoint &gridPos)
         return;
     }
 
-    QRectF rc = boundingRect();
-
-    int x0 = int(rc.x());
-    int y0 = int(rc.y());
-
-    gridPos.setX(x0 + m_squareSize * col + m_squareSize/2);
-    gridPos.setY(y0 + m_squareSize * row + m_squareSize/2);
+    gridPos = m_centers[square(row, col)];
 }
 
 /*!
@@ -486,10 +883,8 @@ void GridItem::fromGridToCenteredCoordinate(const GridPos &pos, QPoint &centerPo
 */
 void GridItem::fromViewToGridCoordinate(int x, int y, GridPos &gridCoord)
 {
-    QRectF rc = boundingRect();
-
-    int col = (int(rc.x()) + x) / m_squareSize + m_dimension - 1;
-    int row = (int(rc.y()) + y) / m_squareSize + m_dimension - 1;
+    int col = (m_originX + x) / m_squareSize + m_dimension - 1;
+    int row = (m_originY + y) / m_squareSize + m_dimension - 1;
 
     gridCoord.setColumn(col); // column's coordinate is mapped to property 'y'
     gridCoord.setRow(row); // row's coordinate is mapped to property 'x'
@@ -512,30 +907,6 @@ void GridItem::fromViewToGridCoordinate(const QPointF &viewCoord, GridPos &gridC
                              gridCoord);
 }
 
-/*!
-*/
-void GridItem::pause(int ms, bool ignoreUserEvents)
-{
-    QFlags<QEventLoop::ProcessEventsFlag> processEventsFlag = QEventLoop::AllEvents;
-
-    if (ignoreUserEvents) {
-        processEventsFlag |= QEventLoop::ExcludeUserInputEvents;
-    }
-
-    QTime dieTime = QTime::currentTime().addMSecs(ms);
-    while(QTime::currentTime() < dieTime)
-        QCoreApplication::processEvents(processEventsFlag, 100);
-}
-
-/*!
-*/
-void GridItem::insertIntoPositionSet(LinesTracker::set_of_positions_t &positions, const LinesTracker::list_of_positions_t &line)
-{
-    foreach (GridPos pos, line) {
-        positions.insert(pos);
-    }
-}
-
 /*!
 */
 int GridItem::promptForGameEnd()
@@ -557,9 +928,372 @@ void GridItem::dumpBallsMatrix()
 
     for (int i = 0; i < dim(); ++i) {
         for (int j = 0; j < dim(); ++j) {
-            dbg.nospace() << (m_balls[i][j] ? (m_balls[i][j]->isHint() ? 2 : 1) : 0) << " ";
+            dbg.nospace() << (m_balls[square(i, j)] ? (m_balls[square(i, j)]->isHint() ? 2 : 1) : 0) << " ";
         }
         dbg.nospace() << "\n";
     }
     dbg.nospace() << "-----\n";
 }
+
+/*!
+*/
+void GridItem::toBoard(Board &board)
+{
+    Q_ASSERT(isPlayable());
+    board.reset();
+
+    for (int i = 0; i < dim(); ++i) {
+        for (int j = 0; j < dim(); ++j) {
+            BallItem *ball = m_balls[square(i, j)];
+            if (!ball) {
+                continue;
+            }
+
+            if (ball->isHint()) {
+                board.addHint(Board::index(i, j), Board::Cell(ball->colorIndex() + 1));
+            } else {
+                board.setCell(Board::index(i, j), Board::Cell(ball->colorIndex() + 1));
+            }
+        }
+    }
+}
+
+/*!
+*/
+void GridItem::showSuggestedMove()
+{
+    if (m_moving || m_animations.isBusy()) {
+        fastForward();
+    }
+
+    if (m_moving || !isPlayable()) {
+        return;
+    }
+
+    // the move is shown now if the analysis has one, else when it publishes one
+    m_hintPending = true;
+    processHint();
+}
+
+/*!
+* The analysis was stopped by a press of the player or dropped with its position: it is started
+* again once the position is fixed. A position without any legal move has no hint.
+*/
+void GridItem::processHint()
+{
+    if (!m_hintPending || m_moving || (0 != m_pendingGames)) {
+        return;
+    }
+
+    Board::Move move;
+    if (m_analyzer.suggestedMove(move)) {
+        m_hintPending = false;
+        showMove(move);
+    } else if (m_analyzer.stage() >= Analyzer::Ranked) {
+        m_hintPending = false;
+    } else if (!m_analyzer.isRunning()) {
+        startAnalysis();
+    }
+}
+
+/*!
+*/
+void GridItem::showMove(const Board::Move &move)
+{
+    if (m_ballSelected) {
+        selectBall(m_beginPos, false);
+    }
+
+    m_beginPos = GridPos(Board::row(move.m_from), Board::column(move.m_from));
+    m_ballSelected = true;
+    selectBall(m_beginPos);
+
+    GridPos target(Board::row(move.m_to), Board::column(move.m_to));
+    trackPath(target);
+    m_hoverPos = target;
+}
+
+/*!
+*/
+void GridItem::startAnalysis()
+{
+    if (!isPlayable()) {
+        return;
+    }
+
+    Board board(dim());
+    toBoard(board);
+
+    m_analyzer.start(board);
+}
+
+/*!
+*/
+void GridItem::loadBoard(const Board &board)
+{
+    Q_ASSERT(board.dim() == m_dimension);
+
+    QVector<unsigned char> balls(size(), 0);
+    QVector<unsigned char> hints(size(), 0);
+
+    for (int row = 0; row < m_dimension; ++row) {
+        for (int col = 0; col < m_dimension; ++col) {
+            balls[square(row, col)] = board.cell(row, col);
+        }
+    }
+
+    for (int i = 0; i < board.hintCount(); ++i) {
+        GridPos pos = toGridPos(board.hintCell(i));
+        hints[square(pos.row(), pos.column())] = board.hintColor(i);
+    }
+
+    loadSquares(balls, hints);
+}
+
+/*!
+* The balls are spawned as the events of the engine would spawn them; their pop-ins are finished at once.
+*/
+void GridItem::loadSquares(const QVector<unsigned char> &balls, const QVector<unsigned char> &hints)
+{
+    Q_ASSERT((balls.count() == size()) && (hints.count() == size()));
+
+    m_animations.finish();
+    m_analyzer.clear();
+    m_hintPending = false;
+
+    m_ballSelected = false;
+    clearPath();
+    m_clearedPositions.clear();
+
+    reset();
+
+    for (int row = 0; row < m_dimension; ++row) {
+        for (int col = 0; col < m_dimension; ++col) {
+            int i = square(row, col);
+            if (balls[i]) {
+                spawnBall(GridPos(row, col), balls[i], false);
+            } else if (hints[i]) {
+                spawnBall(GridPos(row, col), hints[i], true);
+            }
+        }
+    }
+
+    m_animations.finish();
+}
+
+/*!
+*/
+void GridItem::newGame()
+{
+    // the running animations are finished at once, so the balls are back on their squares
+    m_animations.finish();
+    m_analyzer.clear();
+    m_hintPending = false;
+
+    m_ballSelected = false;
+    m_moving = false;
+    clearPath();
+    m_clearedPositions.clear();
+
+    resetAnimation();
+    m_animations.append([this] {
+        reset();
+    });
+
+    // a grid larger than a board is only rendered (see isPlayable())
+    if (!isPlayable()) {
+        return;
+    }
+
+    // the events still queued for the previous game are dropped until this one starts
+    ++m_pendingGames;
+    m_engine.newGame(dim(), (uint64_t(qrand()) << 32) ^ uint64_t(qrand()));
+}
+
+/*!
+* The prompt at the end of a game runs a modal event loop, so the frame timer may call this method
+* again while an event is rendered; the nested call returns at once.
+*/
+void GridItem::processEngineEvents()
+{
+    processEngineEvents(m_clock.elapsed());
+}
+
+/*!
+*/
+void GridItem::processEngineEvents(long long now)
+{
+    if (m_processingEvents) {
+        return;
+    }
+    m_processingEvents = true;
+
+    GameEngine::Event event;
+    while (!m_animations.advance(now) && m_engine.pollEvent(event)) {
+        if (event.m_type == GameEngine::Event::Started) {
+            --m_pendingGames;
+        } else if (0 == m_pendingGames) {
+            processEngineEvent(event);
+        }
+    }
+
+    m_processingEvents = false;
+}
+
+/*!
+*/
+void GridItem::processEngineEvent(const GameEngine::Event &event)
+{
+    switch (event.m_type) {
+    case GameEngine::Event::Moved: {
+        GridPos from = toGridPos(event.m_cell);
+        GridPos to = toGridPos(event.m_target);
+
+        // the ball follows the tracked path; it jumps if the path does not match the move
+        QVector<GridPos> path = m_pathTracker.path();
+        if (path.isEmpty() || (path.front() != from) || (path.back() != to)) {
+            clearPath();
+            path.clear();
+            path.append(from);
+            path.append(to);
+        }
+
+        BallItem *ball = ballAt(from);
+        moveBall(ball, path);
+
+        m_animations.append([this, ball] {
+            ball->select(false);
+            markCellDirty(ball->row(), ball->column());
+            m_ballSelected = false;
+            clearPath();
+        });
+        break;
+    }
+    case GameEngine::Event::Rejected:
+        if (m_ballSelected) {
+            selectBall(m_beginPos, false);
+        }
+        m_ballSelected = false;
+        m_moving = false;
+        clearPath();
+        break;
+    case GameEngine::Event::Spawned:
+        spawnBall(event.m_cell, event.m_color, false);
+        break;
+    case GameEngine::Event::HintsDropped:
+        for (int row = 0; row < m_dimension; ++row) {
+            for (int col = 0; col < m_dimension; ++col) {
+                BallItem *ball = m_balls[square(row, col)];
+                if (ball && ball->isHint()) {
+                    BallItemsProvider::instance()->releaseBall(hideBall(ball));
+                }
+            }
+        }
+        break;
+    case GameEngine::Event::Hinted:
+        spawnBall(event.m_cell, event.m_color, true);
+        break;
+    case GameEngine::Event::Cleared:
+        m_clearedPositions.append(toGridPos(event.m_cell));
+        break;
+    case GameEngine::Event::Scored: {
+        QList<GridPos> positions = m_clearedPositions;
+        int points = event.m_value;
+        m_clearedPositions.clear();
+
+        animateBalls(positions);
+        m_animations.append([this, positions, points] {
+            foreach (GridPos pos, positions) {
+                BallItemsProvider::instance()->releaseBall(hideBall(pos));
+                markCellDirty(pos.row(), pos.column());
+            }
+
+            MainWidget::instance()->updateScore(points);
+        });
+        break;
+    }
+    case GameEngine::Event::Settled:
+        m_moving = false;
+        startAnalysis();
+        break;
+    case GameEngine::Event::GameOver:
+        m_moving = false;
+        flushDirtyRegion();
+
+        if (promptForGameEnd()) {
+            QCoreApplication::quit();
+        } else {
+            MainWidget::instance()->boardView()->reset();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+* A 'hint' ball that turns into a normal ball keeps its item.
+*/
+void GridItem::spawnBall(const GridPos &pos, int color, bool hint)
+{
+    BallItem *ball = ballAt(pos);
+    if (ball && ball->isHint() && !hint && (ball->colorIndex() == color - 1)) {
+        ball->setHint(false);
+        markCellDirty(pos.row(), pos.column());
+        return;
+    }
+
+    if (ball) {
+        BallItemsProvider::instance()->releaseBall(hideBall(ball));
+    }
+
+    ball = BallItemsProvider::instance()->acquireBall(color - 1);
+    ball->setHint(hint);
+
+    showBall(ball, pos);
+    popIn(ball);
+}
+
+/*!
+*/
+void GridItem::markCellDirty(int row, int col)
+{
+    Q_ASSERT(isValidPosition(row, col));
+
+    if (!m_dirtyCells[square(row, col)]) {
+        m_dirtyCells[square(row, col)] = true;
+        m_dirtyList.append(GridPos(row, col));
+    }
+}
+
+/*!
+*/
+void GridItem::markDirty(const QRectF &rect)
+{
+    if (!rect.isEmpty()) {
+        m_dirtyRects.append(rect);
+    }
+}
+
+/*!
+* The scene merges the rectangles into the region of the viewport that is repainted at the next
+* paint event, so the squares and the segments changed during a frame are repainted once. The looks
+* of the dirty squares are synced with their balls here, so the batched paint never reads an item.
+*/
+void GridItem::flushDirtyRegion()
+{
+    foreach (GridPos pos, m_dirtyList) {
+        m_dirtyCells[square(pos.row(), pos.column())] = false;
+        m_looks[square(pos.row(), pos.column())] = lookAt(pos.row(), pos.column());
+        m_tiles[(pos.row() / TileSquares) * m_tilesPerSide + pos.column() / TileSquares] = QPixmap();
+
+        QPoint center = m_centers[square(pos.row(), pos.column())];
+        update(QRectF(center.x() - m_squareSize/2, center.y() - m_squareSize/2, m_squareSize, m_squareSize));
+    }
+    m_dirtyList.clear();
+
+    foreach (QRectF rect, m_dirtyRects) {
+        update(rect);
+    }
+    m_dirtyRects.clear();
+}
@@ -11,10 +11,15 @@
 #include <QtCore/QVector>
 #include <QtCore/QList>
 #include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtGui/QPixmap>
 #include "gridpos.hpp"
 #include "ballitem.hpp"
 #include "pathtracker.hpp"
-#include "linestracker.hpp"
+#include "board.hpp"
+#include "analyzer.hpp"
+#include "gameengine.hpp"
+#include "animationscheduler.hpp"
 
 // forward declarations
 class QGraphicsSceneMouseEvent;
@@ -43,6 +48,14 @@ class QGraphicsSceneMouseEvent;
 class GridItem : public QGraphicsItem
 {
 public:
+    /*! \brief The ways the balls are painted.
+      */
+    enum RenderMode
+    {
+        ItemRendering = 0, /*!< every ball is a visible item of the scene */
+        BatchedRendering /*!< the grid paints the balls from the looks of the squares, through cached tiles; only the animated balls are shown as items */
+    };
+
     /*! The constructor.
       * @param[in] dimension the dimension of the grid
       */
@@ -59,6 +72,25 @@ public:
       */
     QRectF boundingRect() const;
 
+    /*! Recomputes the bounding rectangle and the geometry table after a change of the scene rect.
+      */
+    void updateGeometry();
+
+    /*! Sets the way the balls are painted; the items of the balls in grid are shown or hidden accordingly.
+      * @param[in] mode the render mode
+      * \sa renderMode()
+      */
+    void setRenderMode(RenderMode mode);
+
+    /*!
+      * @return the way the balls are painted
+      * \sa setRenderMode()
+      */
+    inline RenderMode renderMode() const
+    {
+        return m_renderMode;
+    }
+
     /*! Renders the grid item.
       * @param[in] painter the painter
       * @param[in] options the parameters used to paint this graphic item
@@ -108,7 +140,7 @@ public:
     inline BallItem* hideBall(int row, int col)
     {
         Q_ASSERT(isValidPosition(row, col));
-        return hideBall(m_balls[row][col]);
+        return hideBall(m_balls[square(row, col)]);
     }
 
     /*! Hides the ball at the given position in grid.
@@ -133,6 +165,7 @@ public:
     BallItem* hideBall(BallItem *ball);
 
     /*! Moves a ball along a path that consists of squares of the grid.
+    * The ball is stored on the target square at once; its walk along the path is scheduled.
     *
     * @param[in] ball the ball to be moved on
     * @param[in] path the list of the squares that form the path where the ball is to be moved on
@@ -150,7 +183,7 @@ public:
     */
     inline bool isEmptyPos(int row, int col)
     {
-        return m_balls[row][col] == 0;
+        return m_balls[square(row, col)] == 0;
     }
 
     /*! Checks out whether a given position in grid is available.
@@ -203,7 +236,7 @@ public:
       */
     inline bool isHintPos(int row, int col)
     {
-        return m_balls[row][col]->isHint();
+        return m_balls[square(row, col)]->isHint();
     }
 
     /*! Checks whether a square contains a hint ball item.
@@ -241,7 +274,7 @@ public:
     inline BallItem* ballAt(int row, int col)
     {
         Q_ASSERT(isValidPosition(row, col));
-        return m_balls[row][col];
+        return m_balls[square(row, col)];
     }
 
     /*!
@@ -265,7 +298,7 @@ public:
     inline void setBallAt(int row, int col, BallItem *ball)
     {
         Q_ASSERT(isValidPosition(row, col));
-        m_balls[row][col] = ball;
+        m_balls[square(row, col)] = ball;
     }
 
     /*!
@@ -284,7 +317,7 @@ public:
     inline void freePos(int row, int col)
     {
         Q_ASSERT(isValidPosition(row, col));
-        m_balls[row][col] = 0;
+        m_balls[square(row, col)] = 0;
     }
 
     /*! Marks a cell as being available in the internal structure of the grid. The method only sets the pointer at (row, col)
@@ -313,7 +346,8 @@ public:
     {
         BallItem *ball = ballAt(row, column);
         if (ball) {
-            ball->select(selectFlag, true); // also repaint the ball to reflect the selection
+            ball->select(selectFlag);
+            markCellDirty(row, column); // the ball is repainted at the end of the frame
         }
     }
 
@@ -331,17 +365,11 @@ public:
         selectBall(pos.row(), pos.column(), selectFlag);
     }
     
-    /*! Removes the lines of the balls from grid.
-      * @param[in] positions the set of the positions that are to freed up.
-      * @return The score corresponding to the removed balls.
-      */
-    int removeLines(LinesTracker::set_of_positions_t &positions);
-
-    /*! Animates the balls that are to be removed from grid.
+    /*! Schedules the blinking of the balls that are to be removed from grid.
       *
-      * @param[in] positions the set of the positions that are to be animated
+      * @param[in] positions the positions that are to be animated
       */
-    void animateBalls(LinesTracker::set_of_positions_t &positions);
+    void animateBalls(const QList<GridPos> &positions);
 
     /*! Gets the dimension (rows x columns) of the grid.
       * @return The dimension of the grid.
@@ -351,6 +379,15 @@ public:
         return m_dimension;
     }
 
+    /*!
+      * @return true if the game can be played on the grid: a grid larger than Board::MaxDimension
+      * is only rendered (the render benchmark loads such grids), it has no game and no analysis
+      */
+    inline bool isPlayable() const
+    {
+        return m_dimension <= Board::MaxDimension;
+    }
+
     /*! Checks whether the coordinates of a given position do not exceed the borders of the grid.
       *
       * @param[in] pos the position to be checked.
@@ -375,30 +412,32 @@ public:
     }
 
     /*!
-      * @return the total number of the squares in grid
+      * @param[in] row the row
+      * @param[in] col the column
+      * @return the center of a square in the coordinates of the grid item (the square may be outside the grid)
       */
-    inline int size() const
+    inline QPoint squareCenter(int row, int col) const
     {
-        return m_size;
+        return QPoint(m_originX + m_squareSize * col + m_squareSize/2, m_originY + m_squareSize * row + m_squareSize/2);
     }
 
-    /*! Searches the all directions for rows of balls of the same color.
-      *
-      * @param[in] ball the ball that was added on the grid
-      *
-      * \sa checkLines(const QList<BallItem*>&)
+    /*!
+      * @return the size (in pixels) of a square on the grid
       */
-    void checkLines(BallItem *ball);
+    inline int squareSize() const
+    {
+        return m_squareSize;
+    }
 
-    /*! Searches the all directions for rows of balls of the same color.
-      *
-      * @param[in] balls the balls that were added on the grid
-      *
-      * \sa checkLines(BallItem*)
+    /*!
+      * @return the total number of the squares in grid
       */
-    void checkLines(const QList<BallItem*> &balls);
+    inline int size() const
+    {
+        return m_size;
+    }
 
-    /*! The reseting game animation effect : animate all the balls on the grid.
+    /*! Schedules the reseting game animation effect : animate all the balls on the grid.
       */
     void resetAnimation();
 
@@ -421,7 +460,101 @@ public:
       */
     void dumpBallsMatrix();
 
+    /*! Copies the balls and the 'hint' balls of the grid into a headless board.
+      * @param[out] board the headless board
+      */
+    void toBoard(Board &board);
+
+    /*! Shows the move suggested by the background analysis: the ball to be moved is selected and
+      * the path to the target square is drawn. If the analysis has no move yet, the hint is shown
+      * by processHint() once it publishes one; nothing is searched on the GUI thread.
+      */
+    void showSuggestedMove();
+
+    /*! Shows the hint awaited by showSuggestedMove() once the background analysis publishes a move
+      * (the analysis is started again if it was stopped); it is called once per frame, after
+      * processEngineEvents().
+      */
+    void processHint();
+
+    /*! Starts the background analysis of the current position; it is called once the position is
+      * fixed (the next balls are spawned and their lines are removed).
+      */
+    void startAnalysis();
+
+    /*! Asks the game engine for a new game; the balls are removed once the reset animation is played.
+      */
+    void newGame();
+
+    /*! Shows a given position at once, without telling the game engine; it is meant for the tools
+      * that render scripted positions.
+      * @param[in] board the balls and the 'hint' balls to be shown
+      */
+    void loadBoard(const Board &board);
+
+    /*! Shows a given position at once, as loadBoard() does; the grid may be larger than a board.
+      * @param[in] balls the colors of the balls of the squares, row by row (0 for an empty square,
+      * 1 to Board::Colors for a ball)
+      * @param[in] hints the colors of the 'hint' balls of the squares, row by row
+      */
+    void loadSquares(const QVector<unsigned char> &balls, const QVector<unsigned char> &hints);
+
+    /*! Advances the animations and renders the events reported by the game engine since the last call;
+      * it is called once per frame. An event is rendered only when the animations of the previous
+      * events are finished.
+      */
+    void processEngineEvents();
+
+    /*! Advances the animations to a given time and renders the events reported by the game engine;
+      * the tools replay frames at fixed times with it.
+      * @param[in] now the time of the frame on the clock of the animations (ms)
+      */
+    void processEngineEvents(long long now);
+
+    /*! Tracks the path to the square hovered last, if the pointer has entered another square since
+      * the last call; it is called once per frame, after processEngineEvents().
+      */
+    void processHover();
+
+    /*! Repaints the squares and the rectangles marked as dirty since the last call; it is called once
+      * per frame, after processHover().
+      */
+    void flushDirtyRegion();
+
+    /*! Gets the selected ball (picked by the player or by a hint).
+      * @param[out] pos the position of the selected ball
+      * @return true if a ball is selected
+      */
+    inline bool selectedBall(GridPos &pos) const
+    {
+        if (m_ballSelected) {
+            pos = m_beginPos;
+        }
+        return m_ballSelected;
+    }
+
+    /*!
+      * @return true if there is nothing to render: no animation runs, no event of the game engine
+      * is awaited and no square is dirty; the frame timer may be stopped
+      */
+    inline bool isIdle() const
+    {
+        return !m_moving && !m_hoverPending && !m_hintPending && (0 == m_pendingGames) && !m_animations.isBusy() &&
+            m_dirtyList.isEmpty() && m_dirtyRects.isEmpty();
+    }
+
+    /*! In turbo mode the moves, the blinks and the pop-ins are not animated: their results are shown at once.
+      * @param[in] flag the turbo flag
+      */
+    inline void setTurbo(bool flag)
+    {
+        m_animations.setTurbo(flag);
+    }
+
 protected:
+    /*! Selects the ball of a move and draws the path to its target square.
+      */
+    void showMove(const Board::Move &move);
 
     /*! Maps the a given (row, column) coordinate to the center of a grid cell.
     * @param[in] row
@@ -471,36 +604,212 @@ protected:
     */
     void fromViewToGridCoordinate(const QPointF &viewCoord, GridPos &gridCoord);
 
+    /*! Updates the geometry when the item is added to a scene.
+      */
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
+    /*! Renders the border and the lines of the grid into the cached layer.
+      * @param[in] dpr the device pixel ratio of the painted device
+      */
+    void renderGridLayer(qreal dpr);
+
     /*!
-      * @param[in] ms
-      * @param[in] ignoreUserEvents
+      * @param[in] line a segment of the path
+      * @return the rectangle covered by the segment drawn with the pen of the path
+      */
+    QRectF lineBounds(const QLine &line) const;
+
+    /*! Marks a square as dirty: it is repainted by the next flushDirtyRegion().
+      * @param[in] row the row
+      * @param[in] col the column
+      */
+    void markCellDirty(int row, int col);
+
+    /*! Marks a rectangle (e.g. the segments of a path) as dirty.
+      * @param[in] rect the rectangle in the coordinates of the grid item
+      */
+    void markDirty(const QRectF &rect);
+
+    /*! Paints the balls of the squares that intersect a rectangle from their looks (see m_looks).
+      * @param[in] painter the painter
+      * @param[in] exposed the rectangle to be painted, in the coordinates of the grid item
+      */
+    void paintBalls(QPainter *painter, const QRectF &exposed);
+
+    /*! Paints the tiles (see m_tiles) that intersect a rectangle, rendering the invalid ones.
+      * @param[in] painter the painter
+      * @param[in] exposed the rectangle to be painted, in the coordinates of the grid item
+      * @param[in] scale the ratio between the device pixels and the item coordinates
+      */
+    void paintTiles(QPainter *painter, const QRectF &exposed, qreal scale);
+
+    /*! Paints the balls of the squares that intersect a rectangle as plain blocks of their colors;
+      * it is used when a square is too small on the screen for the sprites and the lines to be seen.
+      * @param[in] painter the painter
+      * @param[in] exposed the rectangle to be painted, in the coordinates of the grid item
+      */
+    void paintCoarse(QPainter *painter, const QRectF &exposed);
+
+    /*! Renders the lines and the balls of a tile.
+      * @param[in] tileRow the row of the tile
+      * @param[in] tileCol the column of the tile
+      * @param[in] scale the ratio between the device pixels and the item coordinates
+      */
+    QPixmap renderTile(int tileRow, int tileCol, qreal scale);
+
+    /*!
+      * @param[in] tileRow the row of the tile
+      * @param[in] tileCol the column of the tile
+      * @return the rectangle covered by a tile; the tiles of the border also cover the border
+      */
+    QRect tileRect(int tileRow, int tileCol) const;
+
+    /*! Drops the rendered tiles.
+      */
+    void invalidateTiles();
+
+    /*!
+      * @param[in] row the row
+      * @param[in] col the column
+      * @return the look of the ball of a square (see m_looks); an animated ball has no look
       */
-    void pause(int ms, bool ignoreUserEvents = true);
+    unsigned char lookAt(int row, int col) const;
 
-    /*! Inserts a grid positions into a set of positions where all ball items have the same color.
-      * @param[in] set the existing set of the grid positions
-      * @param[in] line the positions to be inserted in set
+    /*! Shows the item of a ball for the time of an animation (its square is left out of the batch).
+      * @param[in] ball the ball
+      * \sa endItemAnimation()
       */
-    void insertIntoPositionSet(LinesTracker::set_of_positions_t &set, const LinesTracker::list_of_positions_t &line);
+    void beginItemAnimation(BallItem *ball);
+
+    /*! Puts an animated ball back on its square at its normal size; its item is hidden again in the
+      * batched mode. It does nothing if the ball is not animated.
+      * @param[in] ball the ball
+      * \sa beginItemAnimation()
+      */
+    void endItemAnimation(BallItem *ball);
+
+    /*! Plays the pop-in of a new ball: it grows from the center of its square.
+      * @param[in] ball the ball
+      */
+    void popIn(BallItem *ball);
+
+    /*! Finishes the running animations and renders the events the game engine has reported so far,
+      * without their animations; it is called when the player acts during an animation.
+      */
+    void fastForward();
+
+    /*! Clears the path tracker and repaints the squares it covered.
+      */
+    void clearPath();
+
+    /*! Removes the first segment of the path tracker and repaints it.
+      */
+    void wipePathFront();
 
     /*! Prompts for ending or reseting the game.
       */
     int promptForGameEnd();
 
+    /*! Searches the path between the selected ball and a given square and stores it into the path tracker.
+      * @param[in] pos the target square
+      * @return true if a path was found
+      */
+    bool trackPath(GridPos &pos);
+
+    /*! Renders an event reported by the game engine.
+      * @param[in] event the event
+      */
+    void processEngineEvent(const GameEngine::Event &event);
+
+    /*! Shows a new ball.
+      * @param[in] cell the cell (an index in the array of the cells of Board)
+      * @param[in] color the color of the ball (the index of the color + 1)
+      * @param[in] hint true for a 'hint' ball
+      */
+    inline void spawnBall(int cell, int color, bool hint)
+    {
+        spawnBall(toGridPos(cell), color, hint);
+    }
+
+    /*! Shows a new ball on a square.
+      * \sa spawnBall(int, int, bool)
+      */
+    void spawnBall(const GridPos &pos, int color, bool hint);
+
+    /*!
+      * @return the index of a square in the tables of the squares (m_balls, m_centers, m_looks, m_dirtyCells)
+      */
+    inline int square(int row, int col) const
+    {
+        return row * m_dimension + col;
+    }
+
+    /*! Converts an index in the array of the cells of Board into grid coordinates.
+      */
+    static inline GridPos toGridPos(int cell)
+    {
+        return GridPos(Board::row(cell), Board::column(cell));
+    }
+
 private:
     int m_dimension; /*!< the dimension of the grid */
     int m_penWidth; /*!< the width of the pen */
 
-    BallItem *m_balls[9][9]; /*!< the matrix that stores the balls on the grid; the dimensions of the matrix are fixed */
+    QVector<BallItem*> m_balls; /*!< the balls on the grid, row by row (see square()) */
 
     int m_squareSize; /*!< the size of a square on the grid; this value is fixed */
+
+    QRectF m_rect; /*!< the bounding rectangle (see updateGeometry()) */
+    int m_originX; /*!< the integral x-coordinate of the left side of the grid */
+    int m_originY; /*!< the integral y-coordinate of the top side of the grid */
+    QVector<QPoint> m_centers; /*!< the centers of the squares, row by row */
+    QPixmap m_gridLayer; /*!< the cached border and lines of the grid */
+    qreal m_gridLayerDpr; /*!< the device pixel ratio the layer is rendered for */
+
+    enum
+    {
+        LookColorMask = 0x0f, // the color index + 1 of the ball of a square (0 for an empty square)
+        LookStateShift = 4 // the state of the ball (see BallSpriteCache::State)
+    };
+
+    enum
+    {
+        TileSquares = 3, // the number of the rows and of the columns of squares in a tile
+        CoarseSquareSize = 8, // the size of a square on the screen (pixels) below which the balls are drawn as blocks
+        WalkDuration = 100, // the time a ball takes to walk one square (ms)
+        BlinkDuration = 150, // the time a ball blinking before its removal keeps a look (ms)
+        PopInDuration = 150 // the time a new ball takes to grow (ms)
+    };
+
+    RenderMode m_renderMode; /*!< the way the balls are painted */
+    int m_tilesPerSide; /*!< the number of the rows and of the columns of tiles */
+    QVector<QPixmap> m_tiles; /*!< the rendered tiles of the batched mode, row by row (a null pixmap is invalid) */
+    qreal m_tileScale; /*!< the scale the tiles are rendered for */
+    QVector<unsigned char> m_looks; /*!< the looks of the squares as of the last flushDirtyRegion(), row by row */
+    QList<BallItem*> m_animatedBalls; /*!< the balls shown as items for the time of an animation in any mode */
+
+    QVector<bool> m_dirtyCells; /*!< is the square in m_dirtyList ? row by row */
+    QList<GridPos> m_dirtyList; /*!< the squares to be repainted at the end of the frame */
+    QList<QRectF> m_dirtyRects; /*!< the other rectangles to be repainted at the end of the frame */
     GridPos m_beginPos; /*!< the initial position (in the grid coordinates) of the ball to be moved */
     GridPos m_endPos; /*!< the final position (in the grid coordinates) of the ball to be moved */
     bool m_ballSelected; /*!< did we select a ball ? */
+    GridPos m_hoverPos; /*!< the free square hovered last while a ball is selected */
+    bool m_hoverPending; /*!< is the path to m_hoverPos to be tracked at the next frame ? */
+    bool m_hintPending; /*!< is a hint awaited from the background analysis ? */
 
     //int m_availabeCount; /*!< the number of the available positions on the grid */
     int m_size; /*!< the total number of positions in grid: dim() * dim() */
     PathTracker m_pathTracker; /*!< holds the path between two squares in grid */
+    Analyzer m_analyzer; /*!< the background analysis of the current position */
+
+    GameEngine m_engine; /*!< the rules of the game, played on a worker thread */
+    int m_pendingGames; /*!< the new games posted to the engine and not started yet */
+    bool m_moving; /*!< is a move posted to the engine and its turn not settled yet ? */
+    bool m_processingEvents; /*!< is processEngineEvents() running ? */
+    AnimationScheduler m_animations; /*!< the steps of the running animations */
+    QElapsedTimer m_clock; /*!< the clock of the animations */
+    QList<GridPos> m_clearedPositions; /*!< the balls reported as cleared and not removed yet */
 };
 
 #endif // GRIDITEM_HPP
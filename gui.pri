@@ -0,0 +1,34 @@
+# -------------------------------------------------
+# The widgets of the game: the board view, the grid and the ball items.
+# It is shared by the game and by the tools that render the board; main.cpp is left out.
+# -------------------------------------------------
+QT += widgets
+INCLUDEPATH += $$PWD
+SOURCES += $$PWD/ballitem.cpp \
+    $$PWD/griditem.cpp \
+    $$PWD/boardview.cpp \
+    $$PWD/buttonsview.cpp \
+    $$PWD/gridpos.cpp \
+    $$PWD/pathfinder.cpp \
+    $$PWD/pathtracker.cpp \
+    $$PWD/ballitemsprovider.cpp \
+    $$PWD/mainwidget.cpp \
+    $$PWD/animationscheduler.cpp \
+    $$PWD/ballspritecache.cpp
+HEADERS += $$PWD/ballitem.hpp \
+    $$PWD/griditem.hpp \
+    $$PWD/buttonsview.hpp \
+    $$PWD/gridpos.hpp \
+    $$PWD/boardview.hpp \
+    $$PWD/mainwidget.hpp \
+    $$PWD/pathfinder.hpp \
+    $$PWD/singleton.hpp \
+    $$PWD/pathtracker.hpp \
+    $$PWD/ballpaintinfo.hpp \
+    $$PWD/ballitemsprovider.hpp \
+    $$PWD/utils.hpp \
+    $$PWD/animationscheduler.hpp \
+    $$PWD/ballspritecache.hpp \
+    $$PWD/paintprofile.hpp
+
+include($$PWD/engine.pri)
@@ -5,7 +5,6 @@
 #include <QApplication>
 #include <QSysInfo>
 #include "mainwidget.hpp"
-#include "linestracker.hpp"
 #include "pathfinder.hpp"
 #include "ballitemsprovider.hpp"
 #include "utils.hpp"
@@ -19,6 +18,21 @@ bool isRunningOnDesktop()
     return g_isRunOnDesktop;
 }
 
+//
+bool g_useBatchedRendering;
+
+//
+bool useBatchedRendering()
+{
+    return g_useBatchedRendering;
+}
+
+//
+int boardDimension()
+{
+    return 9;
+}
+
 //
 void atExit(void)
 {
@@ -37,6 +51,8 @@ int main(int argc, char *argv[])
 
     QApplication a(argc, argv);
 
+    g_useBatchedRendering = a.arguments().contains("-batched");
+
     MainWidget::instance()->show();
 
     return a.exec();
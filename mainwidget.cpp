@@ -29,12 +29,25 @@ MainWidget::MainWidget(QWidget *parent) :
     reset->setShortcut(QKeySequence(tr("CTRL+R")));
     connect(reset, SIGNAL(triggered()), m_board, SLOT(reset()));
 
+    QAction *hint = new QAction(tr("Hint"), this);
+    hint->setWhatsThis(tr("Suggest a move"));
+    hint->setShortcut(QKeySequence(tr("CTRL+H")));
+    connect(hint, SIGNAL(triggered()), m_board, SLOT(hint()));
+
+    QAction *turbo = new QAction(tr("Turbo"), this);
+    turbo->setWhatsThis(tr("Show the moves without animations"));
+    turbo->setShortcut(QKeySequence(tr("CTRL+T")));
+    turbo->setCheckable(true);
+    connect(turbo, SIGNAL(toggled(bool)), m_board, SLOT(setTurbo(bool)));
+
     QAction *exit = new QAction(tr("Exit"), this);
     exit->setWhatsThis(tr("Quit the game"));
     exit->setShortcut(QKeySequence(tr("ALT+X")));
     connect(exit, SIGNAL(triggered()), qApp, SLOT(quit()));
 
     game->addAction(reset);
+    game->addAction(hint);
+    game->addAction(turbo);
     game->addAction(exit);
 
     menuBar()->addMenu(game);
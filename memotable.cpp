@@ -0,0 +1,205 @@
+/*!
+  * @file memotable.cpp
+  * This file contains the definition of the class MemoTable.
+  */
+
+#include <string.h>
+#include "memotable.hpp"
+#include "random.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LINES_MEMO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//!
+MemoTable::MemoTable()
+    : m_slots(0),
+    m_capacity(0),
+    m_bytes(0),
+    m_size(0),
+    m_fd(-1)
+{
+}
+
+//!
+MemoTable::~MemoTable()
+{
+    close();
+}
+
+/*!
+  * The memory of the table is zero filled (anonymous mappings and the extended spill file both
+  * read as zeros), which is the state of an empty entry.
+  */
+bool MemoTable::open(size_t capacity, size_t memoryLimit, const std::string &spillPath)
+{
+    close();
+
+    size_t slots = 1;
+    while (slots < capacity) {
+        slots *= 2;
+    }
+
+    size_t bytes = slots * sizeof(Slot);
+
+#if defined(LINES_MEMO_MMAP)
+    void *memory = MAP_FAILED;
+
+    if ((bytes > memoryLimit) && !spillPath.empty()) {
+        m_fd = ::open(spillPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (m_fd < 0) {
+            return false;
+        }
+
+        if (0 == ftruncate(m_fd, off_t(bytes))) {
+            memory = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        }
+
+        if (MAP_FAILED == memory) {
+            ::close(m_fd);
+            m_fd = -1;
+            unlink(spillPath.c_str());
+            return false;
+        }
+
+        m_spillPath = spillPath;
+    } else {
+        memory = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == memory) {
+            return false;
+        }
+    }
+
+    m_slots = static_cast<Slot*>(memory);
+#else
+    (void)memoryLimit;
+    (void)spillPath;
+
+    m_slots = new (std::nothrow) Slot[slots];
+    if (!m_slots) {
+        return false;
+    }
+
+    for (size_t i = 0; i < slots; ++i) {
+        m_slots[i].m_key.store(0, std::memory_order_relaxed);
+        m_slots[i].m_value.store(0, std::memory_order_relaxed);
+    }
+#endif
+
+    m_capacity = slots;
+    m_bytes = bytes;
+    m_size = 0;
+
+    return true;
+}
+
+//!
+void MemoTable::close()
+{
+    if (!m_slots) {
+        return;
+    }
+
+#if defined(LINES_MEMO_MMAP)
+    munmap(m_slots, m_bytes);
+
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        unlink(m_spillPath.c_str());
+        m_fd = -1;
+        m_spillPath.clear();
+    }
+#else
+    delete [] m_slots;
+#endif
+
+    m_slots = 0;
+    m_capacity = 0;
+    m_bytes = 0;
+    m_size = 0;
+}
+
+//!
+bool MemoTable::find(uint64_t key, double &value) const
+{
+    if (!m_slots) {
+        return false;
+    }
+
+    key = slotKey(key);
+    size_t mask = m_capacity - 1;
+    size_t index = size_t(Random::mix(key)) & mask;
+
+    for (int probe = 0; probe < MaxProbes; ++probe, index = (index + 1) & mask) {
+        uint64_t current = m_slots[index].m_key.load(std::memory_order_acquire);
+        if (0 == current) {
+            return false;
+        }
+
+        if (current == key) {
+            uint64_t bits = m_slots[index].m_value.load(std::memory_order_acquire);
+            if (0 == bits) {
+                // claimed by another thread that did not publish its value yet
+                return false;
+            }
+
+            value = decode(bits);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//!
+bool MemoTable::insert(uint64_t key, double value)
+{
+    if (!m_slots) {
+        return false;
+    }
+
+    key = slotKey(key);
+    size_t mask = m_capacity - 1;
+    size_t index = size_t(Random::mix(key)) & mask;
+
+    for (int probe = 0; probe < MaxProbes; ++probe, index = (index + 1) & mask) {
+        uint64_t current = m_slots[index].m_key.load(std::memory_order_relaxed);
+        if (0 == current) {
+            if (m_slots[index].m_key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                m_slots[index].m_value.store(encode(value), std::memory_order_release);
+                m_size.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            // another key was claimed here meanwhile: 'current' holds it now
+        }
+
+        if (current == key) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//!
+uint64_t MemoTable::encode(double value)
+{
+    value += 0.0; // -0.0 becomes +0.0, whose flipped bits are not 0
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits ^ 0x8000000000000000ULL;
+}
+
+//!
+double MemoTable::decode(uint64_t bits)
+{
+    bits ^= 0x8000000000000000ULL;
+
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
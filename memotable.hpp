@@ -0,0 +1,118 @@
+/*!
+  * @file memotable.hpp
+  * This file contains the declaration of the class MemoTable.
+  */
+#ifndef MEMOTABLE_HPP
+#define MEMOTABLE_HPP
+
+#include <atomic>
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+/*! This class implements a lossless table of values keyed by 64 bits keys, shared without locks by
+  * several threads (open addressing with linear probing; a key is claimed by a compare-and-swap and
+  * its value is published afterwards).
+  *
+  * Unlike the TranspositionTable nothing is ever replaced, so the table is sized for the whole state
+  * space of a problem. When the table is larger than the allowed memory it is mapped onto a file
+  * (a memory-mapped spill file) and the operating system pages it in and out, so tables of billions
+  * of entries (16 bytes each) fit on a workstation. Without mmap support (not a POSIX system) the
+  * table always lives in memory.
+  */
+class MemoTable
+{
+public:
+    /*! The constructor; builds a closed table.
+      */
+    MemoTable();
+
+    /*! The destructor; closes the table.
+      */
+    ~MemoTable();
+
+    /*! Allocates an empty table.
+      *
+      * @param[in] capacity the number of the entries (rounded up to a power of 2)
+      * @param[in] memoryLimit the number of the bytes the table may take in memory
+      * @param[in] spillPath the file the table is mapped onto if it is larger than memoryLimit
+      * @return false if the memory or the file cannot be allocated
+      */
+    bool open(size_t capacity, size_t memoryLimit, const std::string &spillPath);
+
+    /*! Releases the table (and removes the spill file).
+      */
+    void close();
+
+    /*! Looks up a key.
+      *
+      * @param[in] key the key
+      * @param[out] value receives the value if the key was found
+      * @return true if the key was found
+      */
+    bool find(uint64_t key, double &value) const;
+
+    /*! Inserts a key; a key already in the table keeps its value.
+      *
+      * @return false if the table is full
+      */
+    bool insert(uint64_t key, double value);
+
+    /*!
+      * @return the number of the entries
+      */
+    inline size_t size() const
+    {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    /*!
+      * @return the maximum number of the entries
+      */
+    inline size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /*!
+      * @return true if the table is mapped onto the spill file
+      */
+    inline bool isSpilled() const
+    {
+        return m_fd >= 0;
+    }
+
+private:
+    enum
+    {
+        MaxProbes = 64 // the maximum length of a probe sequence
+    };
+
+    /*! \brief An entry; the key 0 marks an empty entry and the value 0 a value not published yet.
+      */
+    struct Slot
+    {
+        std::atomic<uint64_t> m_key;
+        std::atomic<uint64_t> m_value;
+    };
+
+    // the key 0 is reserved for the empty entries
+    static inline uint64_t slotKey(uint64_t key)
+    {
+        return (0 == key) ? 1 : key;
+    }
+
+    // a value is stored with its sign bit flipped, so the stored value of +0.0 is not 0
+    static uint64_t encode(double value);
+    static double decode(uint64_t bits);
+
+private:
+    Slot *m_slots; /*!< the entries */
+    size_t m_capacity; /*!< the number of the entries (a power of 2) */
+    size_t m_bytes; /*!< the size of the mapping */
+    std::atomic<size_t> m_size; /*!< the number of the used entries */
+    int m_fd; /*!< the descriptor of the spill file or -1 */
+    std::string m_spillPath; /*!< the path of the spill file */
+};
+
+#endif // MEMOTABLE_HPP
@@ -0,0 +1,327 @@
+/*!
+  * @file montecarlo.cpp
+  * This file contains the definition of the class MonteCarlo.
+  */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include "montecarlo.hpp"
+
+namespace
+{
+    inline long long now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+//!
+MonteCarlo::Tree::Tree(int capacity)
+    : m_nodes(new Node[capacity]),
+    m_capacity(capacity),
+    m_used(1)
+{
+}
+
+//!
+MonteCarlo::MonteCarlo()
+    : m_threads(0),
+    m_trees(0),
+    m_timeBudget(500),
+    m_playoutBudget(0),
+    m_policy(GreedyRollout),
+    m_rolloutDepth(3),
+    m_exploration(0.1),
+    m_expandThreshold(8),
+    m_nodeLimit(1 << 20),
+    m_seed(0x5EEDULL),
+    m_started(0),
+    m_stop(false),
+    m_deadline(0),
+    m_playouts(0),
+    m_elapsed(0),
+    m_value(0)
+{
+    setThreads(0);
+}
+
+//!
+MonteCarlo::~MonteCarlo()
+{
+}
+
+//!
+void MonteCarlo::setThreads(int threads)
+{
+    if (threads <= 0) {
+        threads = int(std::thread::hardware_concurrency());
+    }
+
+    m_threads = (threads > 0) ? threads : 1;
+}
+
+/*!
+  * Every tree gets the same root: its children are created here, in the order of
+  * Board::legalMoves(), so the statistics of the root moves can be summed tree by tree.
+  */
+bool MonteCarlo::bestMove(const Board &board, Board::Move &move)
+{
+    m_playouts = 0;
+    m_elapsed = 0;
+    m_value = 0;
+
+    std::vector<Board::Move> moves(Board::MaxMoves);
+    int count = board.legalMoves(&moves[0]);
+    if (0 == count) {
+        return false;
+    }
+
+    move = moves[0];
+    if ((1 == count) || board.isGameOver()) {
+        return true;
+    }
+
+    int trees = (m_trees > 0) ? std::min(m_trees, m_threads) : m_threads;
+    int capacity = std::max(m_nodeLimit / trees, count + 1);
+
+    m_forest.clear();
+    for (int t = 0; t < trees; ++t) {
+        m_forest.push_back(std::unique_ptr<Tree>(new Tree(capacity)));
+        expand(*m_forest.back(), m_forest.back()->m_nodes[0], board, &moves[0]);
+    }
+
+    long long start = now();
+    m_deadline = (m_timeBudget > 0) ? start + (long long)m_timeBudget * 1000000LL : 0;
+    if ((0 == m_timeBudget) && (0 == m_playoutBudget)) {
+        // no budget at all: falls back to the default time budget
+        m_deadline = start + 500 * 1000000LL;
+    }
+
+    m_started = 0;
+    m_stop = false;
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < m_threads; ++i) {
+        workers.push_back(std::thread(&MonteCarlo::work, this, i, std::ref(*m_forest[i % trees]), std::cref(board)));
+    }
+
+    work(0, *m_forest[0], board);
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+
+    m_elapsed = double(now() - start) * 1e-9;
+
+    // sums the statistics of the root moves over the trees
+    long long bestVisits = -1;
+    for (int i = 0; i < count; ++i) {
+        long long visits = 0;
+        long long value = 0;
+        for (int t = 0; t < trees; ++t) {
+            const Node &child = m_forest[t]->m_nodes[m_forest[t]->m_nodes[0].m_firstChild + i];
+            visits += child.m_visits;
+            value += child.m_value;
+        }
+
+        if (visits > bestVisits) {
+            bestVisits = visits;
+            move = moves[i];
+            m_value = (visits > 0) ? double(value) / double(visits) : 0;
+        }
+    }
+
+    for (int t = 0; t < trees; ++t) {
+        m_playouts += m_forest[t]->m_nodes[0].m_visits;
+    }
+
+    m_forest.clear();
+
+    return true;
+}
+
+//!
+void MonteCarlo::work(int thread, Tree &tree, const Board &board)
+{
+    Random rng(Random::mix(m_seed + uint64_t(thread)));
+    std::vector<Board::Move> moves(Board::MaxMoves);
+
+    while (!exhausted()) {
+        playout(tree, board, rng, &moves[0]);
+    }
+}
+
+/*!
+  * The cells met by the first visitor of a node are the same for every playout while the
+  * spawns are the known 'hint' balls of the root; after that the sampled positions differ and
+  * the moves of the tree are checked before they are played.
+  */
+void MonteCarlo::playout(Tree &tree, const Board &board, Random &rng, Board::Move *moves)
+{
+    Node *path[MaxPath];
+    int length = 0;
+
+    Board next(board);
+    bool exact = true;
+
+    Node *node = &tree.m_nodes[0];
+    node->m_virtual.fetch_add(1, std::memory_order_relaxed);
+    path[length++] = node;
+
+    while ((length < MaxPath) && !next.isGameOver()) {
+        if (node->m_firstChild.load(std::memory_order_acquire) == Unexpanded) {
+            if (node->m_visits.load(std::memory_order_relaxed) < m_expandThreshold) {
+                break;
+            }
+
+            expand(tree, *node, next, moves);
+        }
+
+        if ((node->m_firstChild.load(std::memory_order_acquire) < 0) || (0 == node->m_childCount)) {
+            break;
+        }
+
+        Node *child = select(tree, *node);
+        if (!exact && !next.canMove(child->m_move)) {
+            break;
+        }
+
+        bool enforceHints = next.isHintCell(child->m_move.m_to);
+        exact = exact && (1 == length) && (next.hintCount() > 0) && !enforceHints;
+
+        child->m_virtual.fetch_add(1, std::memory_order_relaxed);
+        path[length++] = child;
+
+        next.play(child->m_move, rng);
+        node = child;
+    }
+
+    rollout(next, rng, moves);
+
+    long long value = next.score() - board.score();
+    if (next.isGameOver()) {
+        value -= GameOverPenalty;
+    }
+
+    for (int i = 0; i < length; ++i) {
+        path[i]->m_value.fetch_add(value, std::memory_order_relaxed);
+        path[i]->m_visits.fetch_add(1, std::memory_order_relaxed);
+        path[i]->m_virtual.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+/*!
+  * The children are published with a release store of the index of the first child, after
+  * their moves and their count were written. A node whose children do not fit in the store
+  * becomes a Leaf: it is not tried again.
+  */
+bool MonteCarlo::expand(Tree &tree, Node &node, const Board &board, Board::Move *moves)
+{
+    int expected = Unexpanded;
+    if (!node.m_firstChild.compare_exchange_strong(expected, Expanding, std::memory_order_acquire)) {
+        return false;
+    }
+
+    int count = board.isGameOver() ? 0 : board.legalMoves(moves);
+
+    // the range of the children is reserved only if it fits in the store
+    int first = tree.m_used.load(std::memory_order_relaxed);
+    do {
+        if (first + count > tree.m_capacity) {
+            // the store is full: the node stays a leaf for good
+            node.m_firstChild.store(Leaf, std::memory_order_release);
+            return false;
+        }
+    } while (!tree.m_used.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+
+    for (int i = 0; i < count; ++i) {
+        tree.m_nodes[first + i].m_move = moves[i];
+    }
+
+    node.m_childCount = count;
+    node.m_firstChild.store(first, std::memory_order_release);
+
+    return true;
+}
+
+/*!
+  * A running playout counts as a visit of value 0, which is what most of the playouts that
+  * do not make a line are worth.
+  */
+MonteCarlo::Node *MonteCarlo::select(Tree &tree, Node &node)
+{
+    Node *children = &tree.m_nodes[node.m_firstChild.load(std::memory_order_acquire)];
+    int count = node.m_childCount;
+
+    int total = node.m_visits.load(std::memory_order_relaxed) + node.m_virtual.load(std::memory_order_relaxed);
+    double logTotal = std::log(double(total + 1));
+
+    Node *best = &children[0];
+    double bestScore = -1e300;
+
+    for (int i = 0; i < count; ++i) {
+        Node &child = children[i];
+        int visits = child.m_visits.load(std::memory_order_relaxed) + child.m_virtual.load(std::memory_order_relaxed);
+        if (0 == visits) {
+            return &child;
+        }
+
+        double mean = double(child.m_value.load(std::memory_order_relaxed)) / (double(visits) * GameOverPenalty);
+        double score = mean + m_exploration * std::sqrt(logTotal / visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = &child;
+        }
+    }
+
+    return best;
+}
+
+//!
+void MonteCarlo::rollout(Board &board, Random &rng, Board::Move *moves)
+{
+    for (int i = 0; (i < m_rolloutDepth) && !board.isGameOver(); ++i) {
+        int count = board.legalMoves(moves);
+        if (0 == count) {
+            break;
+        }
+
+        Board::Move move = moves[rng.below(count)];
+
+        if (GreedyRollout == m_policy) {
+            int best = board.lineLengths(move);
+            for (int k = 1; (k < RolloutSample) && (best < Board::LineLength); ++k) {
+                const Board::Move &candidate = moves[rng.below(count)];
+                int length = board.lineLengths(candidate);
+                if (length > best) {
+                    best = length;
+                    move = candidate;
+                }
+            }
+        }
+
+        board.play(move, rng);
+    }
+}
+
+/*!
+  * The clock is read after every playout: a playout lasts several microseconds, far longer than
+  * the reading of the clock.
+  */
+bool MonteCarlo::exhausted()
+{
+    if (m_stop.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    if (((m_playoutBudget > 0) && (m_started.fetch_add(1, std::memory_order_relaxed) >= m_playoutBudget)) ||
+        ((m_deadline > 0) && (now() >= m_deadline))) {
+        m_stop.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
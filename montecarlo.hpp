@@ -0,0 +1,266 @@
+/*!
+  * @file montecarlo.hpp
+  * This file contains the declaration of the class MonteCarlo.
+  */
+#ifndef MONTECARLO_HPP
+#define MONTECARLO_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "board.hpp"
+
+/*! This class implements a parallel Monte Carlo tree search over the moves of the player.
+  *
+  * The search runs on several threads at once. The threads are spread over one or more
+  * independent trees (root parallelism); the statistics of the moves of the root are summed over
+  * the trees at the end of the search and the most visited move is returned. The threads sharing
+  * a tree do not lock it: the nodes are allocated from a preallocated store by an atomic counter,
+  * a node is expanded by the single thread that wins a compare-and-swap on it and all the
+  * statistics are atomic counters. A thread passing through a node adds a 'virtual loss' to it,
+  * so the other threads of the tree are driven towards the other moves meanwhile.
+  *
+  * The spawned balls are not part of the tree (open loop search): every playout draws its own
+  * spawns and a move of the tree that is not legal any more in the sampled position ends
+  * the descent. Below the tree the game is continued by a fast rollout policy for a few moves;
+  * the value of a playout is the number of the points scored, minus a penalty if the board
+  * got full. Only the headless Board is touched, so the search never accesses the Qt objects.
+  */
+class MonteCarlo
+{
+public:
+    /*!
+      * The policies used to continue the game below the tree.
+      */
+    enum RolloutPolicy
+    {
+        RandomRollout, // a random legal move
+        GreedyRollout  // the move making the longest line among a few random legal moves
+    };
+
+    enum
+    {
+        GameOverPenalty = 1500 // the value lost by a playout that fills the board
+    };
+
+    /*! The constructor.
+      */
+    MonteCarlo();
+
+    /*! The destructor.
+      */
+    ~MonteCarlo();
+
+    /*!
+      * @return the number of the threads of a search
+      */
+    inline int threads() const
+    {
+        return m_threads;
+    }
+
+    /*! Sets the number of the threads of a search.
+      * @param[in] threads the number of the threads (0 means one thread per core)
+      */
+    void setThreads(int threads);
+
+    /*!
+      * @return the number of the independent trees (0 means one tree per thread)
+      */
+    inline int trees() const
+    {
+        return m_trees;
+    }
+
+    /*! Sets the number of the independent trees; the threads are spread evenly over the trees.
+      * @param[in] trees the number of the trees (0 means one tree per thread)
+      */
+    inline void setTrees(int trees)
+    {
+        m_trees = (trees > 0) ? trees : 0;
+    }
+
+    /*! Sets the time budget of a search.
+      * @param[in] ms the time budget in milliseconds (0 means no limit)
+      */
+    inline void setTimeBudget(int ms)
+    {
+        m_timeBudget = (ms > 0) ? ms : 0;
+    }
+
+    /*! Sets the playouts budget of a search; the search stops at the first exhausted budget.
+      * @param[in] playouts the number of the playouts (0 means no limit)
+      */
+    inline void setPlayoutBudget(long long playouts)
+    {
+        m_playoutBudget = (playouts > 0) ? playouts : 0;
+    }
+
+    /*! Sets the policy used to continue the game below the tree.
+      */
+    inline void setRolloutPolicy(RolloutPolicy policy)
+    {
+        m_policy = policy;
+    }
+
+    /*! Sets the number of the moves played by a rollout.
+      */
+    inline void setRolloutDepth(int depth)
+    {
+        m_rolloutDepth = (depth > 0) ? depth : 0;
+    }
+
+    /*! Sets the exploration constant of the UCT formula.
+      */
+    inline void setExploration(double exploration)
+    {
+        m_exploration = exploration;
+    }
+
+    /*! Sets the number of the visits a node needs before it is expanded (the root is always expanded).
+      */
+    inline void setExpandThreshold(int visits)
+    {
+        m_expandThreshold = (visits > 0) ? visits : 1;
+    }
+
+    /*! Sets the number of the nodes preallocated by a search (shared by all the trees).
+      */
+    inline void setNodeLimit(int nodes)
+    {
+        m_nodeLimit = (nodes > 0) ? nodes : 1;
+    }
+
+    /*! Sets the seed of the random numbers generators of the threads.
+      */
+    inline void setSeed(uint64_t seed)
+    {
+        m_seed = seed;
+    }
+
+    /*! Searches the best move.
+      *
+      * @param[in] board the position
+      * @param[out] move the most visited move
+      * @return false if there is no legal move
+      */
+    bool bestMove(const Board &board, Board::Move &move);
+
+    /*!
+      * @return the number of the playouts of the last search
+      */
+    inline long long playouts() const
+    {
+        return m_playouts;
+    }
+
+    /*!
+      * @return the duration of the last search in seconds
+      */
+    inline double elapsed() const
+    {
+        return m_elapsed;
+    }
+
+    /*!
+      * @return the number of the playouts per second of the last search
+      */
+    inline double playoutsPerSecond() const
+    {
+        return (m_elapsed > 0) ? double(m_playouts) / m_elapsed : 0;
+    }
+
+    /*!
+      * @return the mean value of the playouts through the best move of the last search
+      */
+    inline double value() const
+    {
+        return m_value;
+    }
+
+private:
+    enum
+    {
+        Unexpanded = -1, // the children of the node were not created yet
+        Expanding = -2,  // a thread is creating the children of the node
+        Leaf = -3,       // the children of the node do not fit in the store: it is never expanded
+        MaxPath = 64,    // the maximum depth of a descent in the tree
+        RolloutSample = 16 // the number of the moves compared by the greedy rollout
+    };
+
+    /*! \brief A node of the tree: a move and the statistics of the playouts through it.
+      */
+    struct Node
+    {
+        Node() : m_childCount(0), m_firstChild(Unexpanded), m_visits(0), m_virtual(0), m_value(0)
+        {
+        }
+
+        Board::Move m_move; /*!< the move leading to the node */
+        int m_childCount; /*!< the number of the children (valid once m_firstChild >= 0) */
+        std::atomic<int> m_firstChild; /*!< the index of the first child, Unexpanded, Expanding or Leaf */
+        std::atomic<int> m_visits; /*!< the number of the finished playouts through the node */
+        std::atomic<int> m_virtual; /*!< the number of the running playouts through the node */
+        std::atomic<long long> m_value; /*!< the sum of the values of the finished playouts */
+    };
+
+    /*! \brief A tree: a store of nodes; the root is the first node.
+      */
+    struct Tree
+    {
+        explicit Tree(int capacity);
+
+        std::unique_ptr<Node[]> m_nodes; /*!< the store of the nodes */
+        int m_capacity; /*!< the size of the store */
+        std::atomic<int> m_used; /*!< the number of the allocated nodes */
+    };
+
+    /*! The loop of a thread: runs playouts on a tree until a budget is exhausted.
+      */
+    void work(int thread, Tree &tree, const Board &board);
+
+    /*! Runs one playout: descends the tree, expands a node, plays a rollout and updates the statistics.
+      */
+    void playout(Tree &tree, const Board &board, Random &rng, Board::Move *moves);
+
+    /*! Creates the children of a node from the legal moves of the position.
+      * @return false if another thread is expanding the node or if the store is full
+      */
+    bool expand(Tree &tree, Node &node, const Board &board, Board::Move *moves);
+
+    /*! Selects the child to descend to by the UCT formula (counting the virtual losses).
+      */
+    Node *select(Tree &tree, Node &node);
+
+    /*! Plays the moves of a rollout.
+      */
+    void rollout(Board &board, Random &rng, Board::Move *moves);
+
+    /*! Checks the budgets after a playout.
+      * @return true if the search has to stop
+      */
+    bool exhausted();
+
+private:
+    int m_threads; /*!< the number of the threads */
+    int m_trees; /*!< the number of the trees (0: one per thread) */
+    int m_timeBudget; /*!< the time budget in milliseconds */
+    long long m_playoutBudget; /*!< the playouts budget */
+    RolloutPolicy m_policy; /*!< the rollout policy */
+    int m_rolloutDepth; /*!< the number of the moves of a rollout */
+    double m_exploration; /*!< the exploration constant */
+    int m_expandThreshold; /*!< the visits needed to expand a node */
+    int m_nodeLimit; /*!< the number of the preallocated nodes */
+    uint64_t m_seed; /*!< the seed of the threads */
+
+    std::vector<std::unique_ptr<Tree> > m_forest; /*!< the trees of the search */
+    std::atomic<long long> m_started; /*!< the number of the started playouts */
+    std::atomic<bool> m_stop; /*!< set when a budget is exhausted */
+    long long m_deadline; /*!< the end of the time budget (steady clock, in nanoseconds) */
+
+    long long m_playouts; /*!< the number of the playouts of the last search */
+    double m_elapsed; /*!< the duration of the last search */
+    double m_value; /*!< the mean value of the best move */
+};
+
+#endif // MONTECARLO_HPP
@@ -0,0 +1,107 @@
+/*!
+  * @file paintprofile.hpp
+  * This file contains the declaration and the implementation of the classes PaintProfile and PaintTimer.
+  */
+#ifndef PAINTPROFILE_HPP
+#define PAINTPROFILE_HPP
+
+#include <QtCore/QElapsedTimer>
+#include "singleton.hpp"
+
+/*! This class sums up the time spent in the paint() methods of the items of the board.
+  *
+  * The paint() methods time themselves only in the builds that define LINES_PAINT_PROFILE (the
+  * render benchmark, see tools/renderbench); the game does not pay for it.
+  */
+class PaintProfile : public Singleton<PaintProfile>
+{
+    friend class Singleton<PaintProfile>;
+
+public:
+    /*! \brief The timed methods.
+      */
+    enum Item
+    {
+        GridPaint = 0, /*!< GridItem::paint() */
+        BallPaint, /*!< BallItem::paint() */
+        ItemCount
+    };
+
+    /*! Adds a call of a method.
+      * @param[in] item the method
+      * @param[in] nsecs the time of the call (ns)
+      */
+    inline void add(Item item, qint64 nsecs)
+    {
+        m_nsecs[item] += nsecs;
+        ++m_calls[item];
+    }
+
+    /*! Clears the times and the calls.
+      */
+    inline void reset()
+    {
+        for (int i = 0; i < ItemCount; ++i) {
+            m_nsecs[i] = 0;
+            m_calls[i] = 0;
+        }
+    }
+
+    /*!
+      * @return the total time of the calls of a method (ns)
+      */
+    inline qint64 nsecs(Item item) const
+    {
+        return m_nsecs[item];
+    }
+
+    /*!
+      * @return the number of the calls of a method
+      */
+    inline int calls(Item item) const
+    {
+        return m_calls[item];
+    }
+
+protected:
+    PaintProfile()
+    {
+        reset();
+    }
+
+private:
+    qint64 m_nsecs[ItemCount]; /*!< the total times */
+    int m_calls[ItemCount]; /*!< the numbers of the calls */
+};
+
+/*! This class adds the time from its construction to its destruction to a PaintProfile entry.
+  */
+class PaintTimer
+{
+public:
+    /*! The constructor: the timer starts.
+      * @param[in] item the timed method
+      */
+    inline explicit PaintTimer(PaintProfile::Item item)
+        : m_item(item)
+    {
+        m_timer.start();
+    }
+
+    /*! The destructor: the time is added to the profile.
+      */
+    inline ~PaintTimer()
+    {
+        PaintProfile::instance()->add(m_item, m_timer.nsecsElapsed());
+    }
+
+private:
+    PaintTimer(const PaintTimer &);
+    PaintTimer &operator =(const PaintTimer &);
+
+private:
+    PaintProfile::Item m_item; /*!< the timed method */
+    QElapsedTimer m_timer; /*!< the timer */
+};
+
+#endif // PAINTPROFILE_HPP
@@ -7,19 +7,22 @@
 
 #include <QtCore/QVector>
 #include <QtCore/QPoint>
+#include <QtCore/QLine>
 #include "gridpos.hpp"
 
 /*! This class maintains two lists: a list (m_path) that stores the path between two squares of the grid
-  * and another list (m_points) that keeps the pairs of the centers of the squares that forms the path
-  * between two squares. The latter is used to draw the lines that connect the centers of the squares
-  * in order to have the path drawn onto the grid.
+  * and another list (m_lines) that keeps the segments that connect the centers of the squares that form
+  * the path between two squares. The latter is used to draw the path onto the grid.
+  *
+  * The segments are wiped from the front while a ball walks along the path: the wiped ones are skipped
+  * by an index (m_first) instead of being removed, so a wipe does not move the rest of the segments.
   */
 class PathTracker
 {
 public:
     /*! The constructor.
       */
-    inline PathTracker() : m_points(), m_path()
+    inline PathTracker() : m_lines(), m_first(0), m_path()
     {}
 
     /*! The destructor.
@@ -29,60 +32,80 @@ public:
         clear();
     }
 
-    /*! Adds a point to this tracker.
-      *
-      * @param pt the point to be added
-      *
-      * \sa addLine(const QPoint &, const QPoint &)
-      */
-    inline void addPoint(const QPoint &pt)
-    {
-        m_points.push_back(pt);
-    }
-
     /*! Adds a pair of points that form a line to this tracker.
       *
       * @param pt1
       * @param pt2
-      *
-      * \sa addPoint(const QPoint&)
       */
     inline void addLine(const QPoint &pt1, const QPoint &pt2)
     {
-        m_points.push_back(pt1);
-        m_points.push_back(pt2);
+        m_lines.push_back(QLine(pt1, pt2));
     }
 
-    /*! Removes the pair of points from the front of the tracker.
+    /*! Removes the line from the front of the tracker.
       *
-      * @return true if there was any pair of points in tracker, false otherwise
+      * @return true if there was any line in tracker, false otherwise
       */
     inline bool removeFrontLine()
     {
         bool retv = false;
-
-        if (m_points.count() >= 2) {
-            m_points.pop_front();
-            m_points.pop_front();
+        if (m_first < m_lines.count()) {
+            ++m_first;
             retv = true;
+
+            // the storage is reused once the last line is wiped
+            if (m_first == m_lines.count()) {
+                m_lines.clear();
+                m_first = 0;
+            }
         }
+
         return retv;
     }
 
+    /*! Keeps the first lines of the tracker and removes the others.
+      *
+      * @param count the number of the lines to be kept
+      */
+    inline void truncate(int count)
+    {
+        if (count < lineCount()) {
+            m_lines.resize(m_first + count);
+        }
+    }
+
     /*! Cleans up the internal structure of the tracker.
       */
     inline void clear()
     {
-        m_points.clear();
+        m_lines.clear();
+        m_first = 0;
         m_path.clear();
     }
 
     /*!
-      * @return all the points
+      * @return the number of the lines
+      */
+    inline int lineCount() const
+    {
+        return m_lines.count() - m_first;
+    }
+
+    /*!
+      * @return the lines, as an array of lineCount() items (see QPainter::drawLines())
+      */
+    inline const QLine *lines() const
+    {
+        return m_lines.constData() + m_first;
+    }
+
+    /*!
+      * @param index the index of the line, from the front of the tracker
+      * @return the line
       */
-    QVector<QPoint>& points()
+    inline const QLine &line(int index) const
     {
-        return m_points;
+        return m_lines.at(m_first + index);
     }
 
     /*!
@@ -94,7 +117,8 @@ public:
     }
 
 private:
-    QVector<QPoint> m_points; /*!< the points */
+    QVector<QLine> m_lines; /*!< the lines, the wiped ones included */
+    int m_first; /*!< the index of the first line that is not wiped */
     QVector<GridPos> m_path; /*!< the path between two positions in the grid */
 };
 
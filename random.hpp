@@ -0,0 +1,88 @@
+/*!
+  * @file random.hpp
+  * This file contains the declaration and the implementation of the class Random.
+  */
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <stdint.h>
+
+/*! A small and fast pseudo random numbers generator (xorshift64*).
+  *
+  * Unlike qrand() every instance owns its state, so the headless boards that are played
+  * on several threads at once do not share (nor lock) a global generator and a given seed
+  * always reproduces the same sequence of spawned balls.
+  */
+class Random
+{
+public:
+    /*! The constructor.
+      * @param[in] seed the seed of the generator
+      */
+    explicit Random(uint64_t seed = 0x9E3779B97F4A7C15ULL)
+    {
+        setSeed(seed);
+    }
+
+    /*! Reinitializes the state of the generator.
+      * @param[in] seed the seed of the generator
+      */
+    inline void setSeed(uint64_t seed)
+    {
+        // the state of a xorshift generator must never be zero
+        m_state = mix(seed) | 1;
+    }
+
+    /*!
+      * @return the state of the generator (two generators having the same state draw the same sequence)
+      */
+    inline uint64_t state() const
+    {
+        return m_state;
+    }
+
+    /*! Restores a state returned by state().
+      * @param[in] state the state
+      */
+    inline void setState(uint64_t state)
+    {
+        m_state = state ? state : 1;
+    }
+
+    /*!
+      * @return the next 64 bits random value
+      */
+    inline uint64_t next()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1DULL;
+    }
+
+    /*!
+      * @param[in] n the upper bound (exclusive); it has to be greater than 0
+      * @return a random value in the range [0, n)
+      */
+    inline int below(int n)
+    {
+        return int(((next() >> 32) * uint64_t(n)) >> 32);
+    }
+
+    /*! The splitmix64 finalizer; spreads the bits of a seed (or of any other 64 bits key).
+      * @param[in] x the value to be mixed
+      * @return the mixed value
+      */
+    static inline uint64_t mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+private:
+    uint64_t m_state; /*!< the state of the generator */
+};
+
+#endif // RANDOM_HPP
@@ -0,0 +1,95 @@
+/*!
+  * @file spscqueue.hpp
+  * This file contains the declaration and the definition of the class template SpscQueue.
+  */
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+/*! This class implements a bounded lock-free queue for exactly one producer thread and one
+  * consumer thread.
+  *
+  * The elements are stored in a ring of \a Capacity slots (a power of two). The producer only
+  * writes the tail and the consumer only writes the head, so a push or a pop costs one acquire
+  * load of the index of the other thread and one release store of its own index; the two indexes
+  * are kept on separate cache lines by padding.
+  */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+public:
+    /*! The constructor.
+      */
+    SpscQueue()
+        : m_head(0),
+        m_tail(0)
+    {
+        static_assert((Capacity >= 2) && (0 == (Capacity & (Capacity - 1))), "the capacity must be a power of two");
+    }
+
+    /*! Appends an element; called by the producer only.
+      * @param[in] value the element
+      * @return false if the queue is full
+      */
+    bool push(const T &value)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+
+        m_slots[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /*! Removes the first element; called by the consumer only.
+      * @param[out] value receives the element
+      * @return false if the queue is empty
+      */
+    bool pop(T &value)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = m_slots[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /*!
+      * @return true if the queue is empty (exact for the consumer, a hint for the producer)
+      */
+    inline bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    SpscQueue(const SpscQueue &);
+    SpscQueue &operator =(const SpscQueue &);
+
+private:
+    enum
+    {
+        CacheLine = 64 // the size of a cache line (bytes)
+    };
+
+    // the padding keeps the indexes a cache line apart from each other and from the neighbours of the
+    // queue without over-aligning it (a new of an over-aligned type is not aligned before C++17)
+    char m_padBefore[CacheLine]; /*!< keeps the head apart from what precedes the queue */
+    std::atomic<size_t> m_head; /*!< the index of the next element to be popped */
+    char m_padHead[CacheLine - sizeof(std::atomic<size_t>)]; /*!< keeps the head apart from the tail */
+    std::atomic<size_t> m_tail; /*!< the index of the next slot to be pushed */
+    char m_padTail[CacheLine - sizeof(std::atomic<size_t>)]; /*!< keeps the tail apart from the slots */
+    T m_slots[Capacity]; /*!< the ring of the elements */
+    char m_padAfter[CacheLine]; /*!< keeps the slots apart from what follows the queue */
+};
+
+#endif // SPSCQUEUE_HPP
@@ -0,0 +1,165 @@
+/*!
+  * @file batchbench.cpp
+  * Checks that the batch evaluation gives the scores of Evaluator::evaluate() and measures the
+  * time needed to evaluate the positions reached by all the legal moves of a position, one by
+  * one and by batches.
+  *
+  * usage: batchbench [positions] [iterations] [seed]
+  */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "batchevaluator.hpp"
+#include "board.hpp"
+#include "evaluator.hpp"
+
+namespace
+{
+    // Plays random games and collects the positions reached by the legal moves of the positions met along the way.
+    void collectSiblings(std::vector<std::vector<Board> > &siblings, int count, uint64_t seed)
+    {
+        static Board::Move moves[Board::MaxMoves];
+
+        Random rng(seed);
+        Board board;
+        board.spawn(rng, true);
+
+        while (int(siblings.size()) < count) {
+            int n = board.legalMoves(moves);
+            if ((0 == n) || board.isGameOver()) {
+                board.reset();
+                board.spawn(rng, true);
+                continue;
+            }
+
+            siblings.push_back(std::vector<Board>(n, board));
+            for (int i = 0; i < n; ++i) {
+                siblings.back()[i].applyMove(moves[i]);
+            }
+
+            board.play(moves[rng.below(n)], rng);
+        }
+    }
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // Returns the mean time (in nanoseconds) of one evaluation by Evaluator::evaluate().
+    double timeSingle(Evaluator::Kernel kernel, const std::vector<std::vector<Board> > &siblings, int iterations, long long &checksum, long long &boards)
+    {
+        Evaluator evaluator(kernel);
+
+        boards = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            for (size_t i = 0; i < siblings.size(); ++i) {
+                for (size_t j = 0; j < siblings[i].size(); ++j) {
+                    checksum += evaluator.evaluate(siblings[i][j]);
+                }
+                boards += (long long)siblings[i].size();
+            }
+        }
+
+        return elapsedNs(start) / double(boards);
+    }
+
+    // Returns the mean time (in nanoseconds) of one evaluation by BatchEvaluator::evaluate().
+    double timeBatch(Evaluator::Kernel kernel, const std::vector<std::vector<Board> > &siblings, int iterations, long long &checksum, long long &boards)
+    {
+        BatchEvaluator evaluator(kernel);
+        std::vector<int> scores(Board::MaxMoves);
+
+        boards = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            for (size_t i = 0; i < siblings.size(); ++i) {
+                int n = int(siblings[i].size());
+                evaluator.evaluate(&siblings[i][0], n, &scores[0]);
+                for (int j = 0; j < n; ++j) {
+                    checksum += scores[j];
+                }
+                boards += n;
+            }
+        }
+
+        return elapsedNs(start) / double(boards);
+    }
+
+    // Returns the number of the boards whose batch score differs from Evaluator::evaluate().
+    int checkBatch(Evaluator::Kernel kernel, const std::vector<std::vector<Board> > &siblings)
+    {
+        Evaluator evaluator(Evaluator::ScalarKernel);
+        BatchEvaluator batch(kernel);
+        std::vector<int> scores(Board::MaxMoves);
+
+        int mismatches = 0;
+        for (size_t i = 0; i < siblings.size(); ++i) {
+            int n = int(siblings[i].size());
+            batch.evaluate(&siblings[i][0], n, &scores[0]);
+            for (int j = 0; j < n; ++j) {
+                if (scores[j] != evaluator.evaluate(siblings[i][j])) {
+                    ++mismatches;
+                }
+            }
+        }
+
+        return mismatches;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int count = (argc > 1) ? atoi(argv[1]) : 500;
+    int iterations = (argc > 2) ? atoi(argv[2]) : 5;
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], 0, 10) : 1;
+
+    std::vector<std::vector<Board> > siblings;
+    siblings.reserve(count);
+    collectSiblings(siblings, count, seed);
+
+    const Evaluator::Kernel kernels[] = { Evaluator::ScalarKernel, Evaluator::Sse2Kernel, Evaluator::Avx2Kernel };
+
+    int failures = 0;
+    for (int k = 1; k < 3; ++k) {
+        if (!Evaluator::isSupported(kernels[k])) {
+            printf("%-6s : not supported\n", Evaluator::kernelName(kernels[k]));
+            continue;
+        }
+
+        int mismatches = checkBatch(kernels[k], siblings);
+        printf("%-6s : %d boards differ from Evaluator::evaluate()\n", Evaluator::kernelName(kernels[k]), mismatches);
+        failures += mismatches;
+    }
+
+    double scalarNs = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (!Evaluator::isSupported(kernels[k])) {
+            continue;
+        }
+
+        long long checksum = 0;
+        long long boards = 0;
+        double singleNs = timeSingle(kernels[k], siblings, iterations, checksum, boards);
+        if (0 == k) {
+            scalarNs = singleNs;
+        }
+
+        printf("%-6s : one by one %8.1f ns/board  (x%.2f, checksum %lld)\n",
+               Evaluator::kernelName(kernels[k]), singleNs, scalarNs / singleNs, checksum);
+
+        if (0 == k) {
+            continue;
+        }
+
+        checksum = 0;
+        double batchNs = timeBatch(kernels[k], siblings, iterations, checksum, boards);
+        printf("%-6s : by batches %8.1f ns/board  (x%.2f, x%.2f over one by one, checksum %lld)\n",
+               Evaluator::kernelName(kernels[k]), batchNs, scalarNs / batchNs, singleNs / batchNs, checksum);
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
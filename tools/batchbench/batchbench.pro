@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Speedup of the evaluation of the boards by batches.
+# -------------------------------------------------
+TARGET = batchbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += batchbench.cpp
@@ -0,0 +1,151 @@
+/*!
+  * @file beamsolve.cpp
+  * Searches the best sequence of moves of a seeded run with the beam solver and writes it
+  * as a record that can be replayed; replays and checks a record.
+  *
+  * usage: beamsolve solve <seed> <record> [width] [branching] [turns] [threads] [dimension]
+  *        beamsolve replay <record>
+  *
+  * A seeded run starts from an empty board on which the first balls are spawned by the
+  * generator initialized with the seed; the same generator spawns all the following balls.
+  * The record is a text file:
+  *
+  *     lines-record 1
+  *     seed <seed>
+  *     dimension <dimension>
+  *     score <score>
+  *     moves <count>
+  *     <from row> <from column> <to row> <to column>   (one line per move)
+  */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "board.hpp"
+#include "beamsolver.hpp"
+
+namespace
+{
+    // Builds the starting position of a seeded run.
+    void startRun(uint64_t seed, int dimension, Board &board, Random &rng)
+    {
+        board = Board(dimension);
+        rng.setSeed(seed);
+        board.spawn(rng, true);
+    }
+
+    bool writeRecord(const char *path, uint64_t seed, int dimension, int score, const std::vector<Board::Move> &moves)
+    {
+        FILE *file = fopen(path, "w");
+        if (!file) {
+            return false;
+        }
+
+        fprintf(file, "lines-record 1\nseed %llu\ndimension %d\nscore %d\nmoves %d\n",
+                (unsigned long long)seed, dimension, score, int(moves.size()));
+        for (size_t i = 0; i < moves.size(); ++i) {
+            fprintf(file, "%d %d %d %d\n", Board::row(moves[i].m_from), Board::column(moves[i].m_from),
+                    Board::row(moves[i].m_to), Board::column(moves[i].m_to));
+        }
+
+        return 0 == fclose(file);
+    }
+
+    bool readRecord(const char *path, uint64_t &seed, int &dimension, int &score, std::vector<Board::Move> &moves)
+    {
+        FILE *file = fopen(path, "r");
+        if (!file) {
+            return false;
+        }
+
+        int version = 0;
+        unsigned long long s = 0;
+        int count = 0;
+        bool ok = (5 == fscanf(file, "lines-record %d seed %llu dimension %d score %d moves %d",
+                               &version, &s, &dimension, &score, &count)) && (1 == version) && (count >= 0);
+
+        moves.clear();
+        for (int i = 0; ok && (i < count); ++i) {
+            int r0, c0, r1, c1;
+            ok = (4 == fscanf(file, "%d %d %d %d", &r0, &c0, &r1, &c1));
+            moves.push_back(Board::Move(Board::index(r0, c0), Board::index(r1, c1)));
+        }
+
+        fclose(file);
+        seed = s;
+
+        return ok;
+    }
+
+    int replay(const char *path)
+    {
+        uint64_t seed;
+        int dimension;
+        int score;
+        std::vector<Board::Move> moves;
+        if (!readRecord(path, seed, dimension, score, moves)) {
+            fprintf(stderr, "cannot read the record %s\n", path);
+            return 2;
+        }
+
+        Board board;
+        Random rng;
+        startRun(seed, dimension, board, rng);
+
+        for (size_t i = 0; i < moves.size(); ++i) {
+            if (board.isGameOver() || !board.canMove(moves[i])) {
+                fprintf(stderr, "move %d is not legal\n", int(i) + 1);
+                return 1;
+            }
+
+            board.play(moves[i], rng);
+        }
+
+        printf("replayed %d moves: score %d (recorded %d)\n", int(moves.size()), board.score(), score);
+
+        return (board.score() == score) ? 0 : 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc == 3) && (0 == strcmp(argv[1], "replay"))) {
+        return replay(argv[2]);
+    }
+
+    if ((argc < 4) || (0 != strcmp(argv[1], "solve"))) {
+        fprintf(stderr, "usage: beamsolve solve <seed> <record> [width] [branching] [turns] [threads] [dimension]\n"
+                        "       beamsolve replay <record>\n");
+        return 2;
+    }
+
+    uint64_t seed = strtoull(argv[2], 0, 10);
+    const char *path = argv[3];
+    int dimension = (argc > 8) ? atoi(argv[8]) : 9;
+
+    BeamSolver solver;
+    solver.setWidth((argc > 4) ? atoi(argv[4]) : 1000);
+    solver.setBranching((argc > 5) ? atoi(argv[5]) : 4);
+    solver.setMaxTurns((argc > 6) ? atoi(argv[6]) : 1000);
+    solver.setThreads((argc > 7) ? atoi(argv[7]) : 0);
+
+    Board board;
+    Random rng;
+    startRun(seed, dimension, board, rng);
+
+    if (!solver.solve(board, rng)) {
+        fprintf(stderr, "there is no legal move\n");
+        return 1;
+    }
+
+    printf("score %d in %d moves, %lld positions played in %.1f s\n",
+           solver.score(), int(solver.moves().size()), solver.expanded(), solver.elapsed());
+
+    if (!writeRecord(path, seed, board.dim(), solver.score(), solver.moves())) {
+        fprintf(stderr, "cannot write the record %s\n", path);
+        return 2;
+    }
+
+    return 0;
+}
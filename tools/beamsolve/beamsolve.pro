@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Offline beam search of the best score of a seeded run.
+# -------------------------------------------------
+TARGET = beamsolve
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += beamsolve.cpp
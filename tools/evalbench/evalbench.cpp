@@ -0,0 +1,167 @@
+/*!
+  * @file evalbench.cpp
+  * Checks that the scalar and the SIMD evaluation kernels agree exactly and measures
+  * the time needed to evaluate one position with every kernel, split into its two steps:
+  * the prepare step (the reachable cells) and the window kernel.
+  *
+  * usage: evalbench [positions] [iterations] [seed]
+  */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "board.hpp"
+#include "evaluator.hpp"
+
+namespace
+{
+    // Plays random games and collects the positions met along the way.
+    void collectPositions(std::vector<Board> &positions, int count, uint64_t seed)
+    {
+        static Board::Move moves[Board::MaxMoves];
+
+        Random rng(seed);
+        Board board;
+        board.spawn(rng, true);
+
+        while (int(positions.size()) < count) {
+            int n = board.legalMoves(moves);
+            if ((0 == n) || board.isGameOver()) {
+                board.reset();
+                board.spawn(rng, true);
+                continue;
+            }
+
+            board.play(moves[rng.below(n)], rng);
+            positions.push_back(board);
+        }
+    }
+
+    // Returns the number of the positions where the kernel disagrees with the scalar kernel.
+    int checkKernel(Evaluator &evaluator, Evaluator::Kernel kernel, const std::vector<Board> &positions)
+    {
+        int mismatches = 0;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            int expected[Board::Colors + 1];
+            expected[Board::Colors] = evaluator.evaluate(positions[i], Evaluator::ScalarKernel);
+            for (int c = 1; c <= Board::Colors; ++c) {
+                expected[c - 1] = evaluator.colorScore(c);
+            }
+
+            bool same = (evaluator.evaluate(positions[i], kernel) == expected[Board::Colors]);
+            for (int c = 1; c <= Board::Colors; ++c) {
+                same = same && (evaluator.colorScore(c) == expected[c - 1]);
+            }
+
+            if (!same) {
+                ++mismatches;
+            }
+        }
+
+        return mismatches;
+    }
+
+    double nsPerPosition(std::chrono::steady_clock::time_point start, int iterations, size_t positions)
+    {
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        return ns / (double(iterations) * double(positions));
+    }
+
+    // Returns the mean time (in nanoseconds) of one evaluation.
+    double timeKernel(Evaluator &evaluator, Evaluator::Kernel kernel, const std::vector<Board> &positions, int iterations, long long &checksum)
+    {
+        evaluator.setKernel(kernel);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            for (size_t i = 0; i < positions.size(); ++i) {
+                checksum += evaluator.evaluate(positions[i]);
+            }
+        }
+
+        return nsPerPosition(start, iterations, positions.size());
+    }
+
+    // Returns the mean time (in nanoseconds) of the prepare step of one evaluation.
+    double timePrepare(Evaluator &evaluator, const std::vector<Board> &positions, int iterations)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            for (size_t i = 0; i < positions.size(); ++i) {
+                evaluator.prepare(positions[i]);
+            }
+        }
+
+        return nsPerPosition(start, iterations, positions.size());
+    }
+
+    // Returns the mean time (in nanoseconds) of the window kernel alone, on a prepared position.
+    double timeWindows(Evaluator &evaluator, Evaluator::Kernel kernel, const std::vector<Board> &positions, int iterations, long long &checksum)
+    {
+        double ns = 0;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            evaluator.prepare(positions[i]);
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int it = 0; it < iterations; ++it) {
+                checksum += evaluator.evaluatePrepared(positions[i], kernel);
+            }
+            ns += nsPerPosition(start, iterations, 1);
+        }
+
+        return ns / double(positions.size());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int count = (argc > 1) ? atoi(argv[1]) : 10000;
+    int iterations = (argc > 2) ? atoi(argv[2]) : 20;
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], 0, 10) : 1;
+
+    std::vector<Board> positions;
+    positions.reserve(count);
+    collectPositions(positions, count, seed);
+
+    Evaluator evaluator;
+    const Evaluator::Kernel kernels[] = { Evaluator::ScalarKernel, Evaluator::Sse2Kernel, Evaluator::Avx2Kernel };
+
+    int failures = 0;
+    for (int k = 1; k < 3; ++k) {
+        if (!Evaluator::isSupported(kernels[k])) {
+            printf("%-6s : not supported\n", Evaluator::kernelName(kernels[k]));
+            continue;
+        }
+
+        int mismatches = checkKernel(evaluator, kernels[k], positions);
+        printf("%-6s : %d/%d positions differ from the scalar kernel\n",
+               Evaluator::kernelName(kernels[k]), mismatches, count);
+        failures += mismatches;
+    }
+
+    double prepareNs = timePrepare(evaluator, positions, iterations);
+    printf("prepare: %8.1f ns/position\n", prepareNs);
+
+    double scalarNs = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (!Evaluator::isSupported(kernels[k])) {
+            continue;
+        }
+
+        long long checksum = 0;
+        double ns = timeKernel(evaluator, kernels[k], positions, iterations, checksum);
+        if (0 == k) {
+            scalarNs = ns;
+        }
+
+        long long windowsChecksum = 0;
+        double windowsNs = timeWindows(evaluator, kernels[k], positions, iterations, windowsChecksum);
+
+        printf("%-6s : %8.1f ns/position, windows %8.1f ns  (x%.2f, checksum %lld)\n",
+               Evaluator::kernelName(kernels[k]), ns, windowsNs, scalarNs / ns, checksum);
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
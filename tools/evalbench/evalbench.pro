@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Microbenchmark of the evaluation kernels.
+# -------------------------------------------------
+TARGET = evalbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += evalbench.cpp
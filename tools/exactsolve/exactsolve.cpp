@@ -0,0 +1,114 @@
+/*!
+  * @file exactsolve.cpp
+  * Solves random positions of a small board exactly and measures the regret of the bots (the
+  * exact value of the best move minus the exact value of the move chosen by the bot): the greedy
+  * bot of Evaluator::suggestMove() and the line bot of Board::moveRank().
+  *
+  * usage: exactsolve [dimension] [colors] [horizon] [positions] [balls] [entries (millions)] [memory (MB)] [spill file] [seed]
+  */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "board.hpp"
+#include "evaluator.hpp"
+#include "exactsolver.hpp"
+
+namespace
+{
+    // Builds a random position: 'balls' balls and three 'hint' balls of the first 'colors' colors.
+    Board randomPosition(int dimension, int colors, int balls, Random &rng)
+    {
+        Board board(dimension);
+        for (int i = 0; (i < balls) && (board.freeCount() > 1); ++i) {
+            board.setCell(board.randomFreeCell(rng), Board::Cell(1 + rng.below(colors)));
+        }
+
+        for (int i = 0; i < Board::HintCount; ++i) {
+            board.addHint(board.randomFreeCell(rng), Board::Cell(1 + rng.below(colors)));
+        }
+
+        return board;
+    }
+
+    // The move of the line bot: the longest line.
+    Board::Move lineMove(const Board &board)
+    {
+        std::vector<Board::Move> moves(Board::MaxMoves);
+        int count = board.legalMoves(&moves[0]);
+
+        int best = 0;
+        for (int i = 1; i < count; ++i) {
+            if (board.moveRank(moves[i]) > board.moveRank(moves[best])) {
+                best = i;
+            }
+        }
+
+        return moves[best];
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int dimension = (argc > 1) ? atoi(argv[1]) : 5;
+    int colors = (argc > 2) ? atoi(argv[2]) : 2;
+    int horizon = (argc > 3) ? atoi(argv[3]) : 2;
+    int count = (argc > 4) ? atoi(argv[4]) : 3;
+    int balls = (argc > 5) ? atoi(argv[5]) : 22;
+    size_t entries = size_t((argc > 6) ? atoi(argv[6]) : 16) << 20;
+    size_t megabytes = (argc > 7) ? size_t(atoi(argv[7])) : 1024;
+    std::string spillPath = (argc > 8) ? argv[8] : "exactsolve.memo";
+    uint64_t seed = (argc > 9) ? strtoull(argv[9], 0, 10) : 1;
+
+    ExactSolver solver;
+    solver.setColors(colors);
+    solver.setHorizon(horizon);
+
+    if (!solver.openTable(entries, megabytes << 20, spillPath)) {
+        fprintf(stderr, "cannot allocate a table of %zu entries\n", entries);
+        return 1;
+    }
+
+    printf("%dx%d, %d colors, %d turns, table of %zu entries%s\n", dimension, dimension, solver.colors(),
+           solver.horizon(), solver.table().capacity(), solver.table().isSpilled() ? " (spilled)" : "");
+
+    Random rng(seed);
+    Evaluator evaluator;
+    double regrets[2] = { 0, 0 };
+    int solved = 0;
+
+    for (int i = 0; i < count; ++i) {
+        Board board = randomPosition(dimension, solver.colors(), balls, rng);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        Board::Move best;
+        double value = solver.solve(board, best);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        long long nodes = solver.nodes();
+        long long hits = solver.hits();
+
+        Board::Move greedy;
+        if (!evaluator.suggestMove(board, greedy)) {
+            continue;
+        }
+
+        double greedyValue = solver.moveValue(board, greedy);
+        double lineValue = solver.moveValue(board, lineMove(board));
+
+        regrets[0] += value - greedyValue;
+        regrets[1] += value - lineValue;
+        ++solved;
+
+        printf("%3d: value %8.2f, greedy %8.2f, line %8.2f, %lld positions, %lld hits, %.2f s\n",
+               i, value, greedyValue, lineValue, nodes, hits, seconds);
+    }
+
+    if (solved > 0) {
+        printf("mean regret: greedy %.2f, line %.2f; table %zu entries\n",
+               regrets[0] / solved, regrets[1] / solved, solver.table().size());
+    }
+
+    return 0;
+}
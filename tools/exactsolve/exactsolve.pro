@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Exact values of small boards and the regret of the bots.
+# -------------------------------------------------
+TARGET = exactsolve
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += exactsolve.cpp
@@ -0,0 +1,254 @@
+/*!
+  * @file gendata.cpp
+  * Plays seeded games with a bot and writes every position (with its legal moves, the move played
+  * and the points scored until the end of the game) into a dataset file, then reads the file back
+  * (measuring the decoding of the samples) and checks it against the rules. The game i uses the
+  * seed + i whatever the number of the threads.
+  *
+  * usage: gendata <file> [games] [threads] [random|line|greedy] [dimension] [seed] [chunk samples]
+  */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "dataset.hpp"
+#include "evaluator.hpp"
+
+namespace
+{
+    enum Policy
+    {
+        RandomPolicy,
+        LinePolicy,
+        GreedyPolicy
+    };
+
+    // The settings shared by the threads.
+    struct Job
+    {
+        DatasetWriter *m_writer;
+        Policy m_policy;
+        int m_games;
+        int m_dimension;
+        int m_chunk;
+        uint64_t m_seed;
+        std::atomic<int> m_next; // the next game to play
+        std::atomic<bool> m_failed;
+    };
+
+    Board::Move chooseMove(Policy policy, const Board &board, const Board::Move *moves, int count, Evaluator &evaluator, Random &rng)
+    {
+        Board::Move move = moves[rng.below(count)];
+
+        if (LinePolicy == policy) {
+            for (int i = 0; i < count; ++i) {
+                if (board.moveRank(moves[i]) > board.moveRank(move)) {
+                    move = moves[i];
+                }
+            }
+        } else if (GreedyPolicy == policy) {
+            // the fast bot of the self-play games of the tuner
+            evaluator.suggestMove(board, move, 8);
+        }
+
+        return move;
+    }
+
+    // Plays the next games until all of them are played; every thread fills its own chunks.
+    void generate(Job &job)
+    {
+        DatasetChunk chunk(job.m_dimension, job.m_chunk);
+        Evaluator evaluator;
+        std::vector<Board::Move> moves(Board::MaxMoves);
+
+        std::vector<Board> positions;
+        std::vector<Board::Move> played;
+        std::vector<int> scores;
+
+        for (int game = job.m_next++; game < job.m_games; game = job.m_next++) {
+            Random rng(job.m_seed + uint64_t(game));
+            Board board(job.m_dimension);
+            board.spawn(rng, true);
+
+            positions.clear();
+            played.clear();
+            scores.clear();
+
+            while (!board.isGameOver()) {
+                int count = board.legalMoves(&moves[0]);
+                if (0 == count) {
+                    break;
+                }
+
+                Board::Move move = chooseMove(job.m_policy, board, &moves[0], count, evaluator, rng);
+
+                positions.push_back(board);
+                played.push_back(move);
+                scores.push_back(board.score());
+
+                board.play(move, rng);
+            }
+
+            for (size_t i = 0; i < positions.size(); ++i) {
+                chunk.add(positions[i], played[i], board.score() - scores[i]);
+
+                if (chunk.isFull()) {
+                    if (!job.m_writer->append(chunk)) {
+                        job.m_failed = true;
+                    }
+                    chunk.clear();
+                }
+            }
+        }
+
+        if (!job.m_writer->append(chunk)) {
+            job.m_failed = true;
+        }
+    }
+
+    // Decodes all the samples as a training pipeline does; returns a checksum.
+    long long decode(const DatasetReader &reader)
+    {
+        std::vector<unsigned char> mask(Board::MaxCells * Board::MaxCells);
+        long long checksum = 0;
+
+        for (int c = 0; c < reader.chunks(); ++c) {
+            for (int i = 0; i < reader.chunkRecords(c); ++i) {
+                Board board;
+                reader.board(c, i, board);
+                reader.legalMask(c, i, &mask[0]);
+
+                Board::Move move = reader.move(c, i);
+                int cells = board.dim() * board.dim();
+                int from = Board::row(move.m_from) * board.dim() + Board::column(move.m_from);
+                int to = Board::row(move.m_to) * board.dim() + Board::column(move.m_to);
+
+                checksum += board.freeCount() + mask[from * cells + to] + reader.outcome(c, i);
+            }
+        }
+
+        return checksum;
+    }
+
+    // Reads all the samples back and checks them against the rules; returns the number of the bad samples.
+    long long verify(const DatasetReader &reader, long long &outcomes)
+    {
+        std::vector<Board::Move> moves(Board::MaxMoves);
+        std::vector<Board::Move> expected(Board::MaxMoves);
+        long long bad = 0;
+
+        for (int c = 0; c < reader.chunks(); ++c) {
+            for (int i = 0; i < reader.chunkRecords(c); ++i) {
+                Board board;
+                reader.board(c, i, board);
+
+                int count = reader.legalMoves(c, i, &moves[0]);
+                int expectedCount = board.legalMoves(&expected[0]);
+
+                Board::Move move = reader.move(c, i);
+                bool played = false;
+                for (int k = 0; k < count; ++k) {
+                    played = played || (moves[k] == move);
+                }
+
+                if ((count != expectedCount) || !played || (reader.outcome(c, i) < 0)) {
+                    ++bad;
+                }
+
+                outcomes += reader.outcome(c, i);
+            }
+        }
+
+        return bad;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start)
+    {
+        return double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()) * 1e-6;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: gendata <file> [games] [threads] [random|line|greedy] [dimension] [seed] [chunk samples]\n");
+        return 2;
+    }
+
+    const char *path = argv[1];
+    int threads = (argc > 3) ? atoi(argv[3]) : 0;
+    if (threads <= 0) {
+        threads = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+
+    Policy policy = GreedyPolicy;
+    if (argc > 4) {
+        policy = (0 == strcmp(argv[4], "random")) ? RandomPolicy : (0 == strcmp(argv[4], "line")) ? LinePolicy : GreedyPolicy;
+    }
+
+    DatasetWriter writer;
+    if (!writer.open(path)) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return 2;
+    }
+
+    Job job;
+    job.m_writer = &writer;
+    job.m_policy = policy;
+    job.m_games = (argc > 2) ? atoi(argv[2]) : 200;
+    job.m_dimension = (argc > 5) ? atoi(argv[5]) : 9;
+    job.m_seed = (argc > 6) ? strtoull(argv[6], 0, 10) : 1;
+    job.m_chunk = (argc > 7) ? atoi(argv[7]) : 65536;
+    job.m_next = 0;
+    job.m_failed = false;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(generate, std::ref(job)));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+
+    bool closed = writer.close();
+    double generation = seconds(start);
+
+    if (job.m_failed || !closed) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 2;
+    }
+
+    uint64_t samples = writer.records();
+    double megabytes = double(writer.bytes()) / (1024.0 * 1024.0);
+    printf("%d games, %llu samples, %.1f MB (%.1f bytes per sample) in %.2f s: %.0f samples/s, %.1f MB/s\n",
+           job.m_games, (unsigned long long)samples, megabytes, double(writer.bytes()) / double(samples ? samples : 1),
+           generation, double(samples) / generation, megabytes / generation);
+
+    start = std::chrono::steady_clock::now();
+
+    DatasetReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 2;
+    }
+
+    long long checksum = decode(reader);
+    double reading = seconds(start);
+
+    printf("read %llu samples in %d chunks in %.2f s: %.0f samples/s, %.1f MB/s (checksum %lld)\n",
+           (unsigned long long)reader.records(), reader.chunks(), reading, double(reader.records()) / reading,
+           megabytes / reading, checksum);
+
+    long long outcomes = 0;
+    long long bad = verify(reader, outcomes);
+
+    printf("%lld bad samples, mean outcome %.1f\n", bad, double(outcomes) / double(reader.records() ? reader.records() : 1));
+
+    return (0 == bad) && (reader.records() == samples) ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Generator of the training datasets.
+# -------------------------------------------------
+TARGET = gendata
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += gendata.cpp
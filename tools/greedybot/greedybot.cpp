@@ -0,0 +1,67 @@
+/*!
+  * @file greedybot.cpp
+  * A bot plugin playing the move of Evaluator::suggestMove() among the best ranked moves.
+  */
+
+#include <new>
+#include "botplugin.h"
+#include "evaluator.hpp"
+
+namespace
+{
+    enum
+    {
+        Candidates = 8 // the moves evaluated per turn (as the bot of the tuner)
+    };
+}
+
+extern "C" {
+
+LINES_BOT_EXPORT int lines_bot_abi_version(void)
+{
+    return LINES_BOT_ABI_VERSION;
+}
+
+LINES_BOT_EXPORT const char *lines_bot_name(void)
+{
+    return "greedy";
+}
+
+LINES_BOT_EXPORT void *lines_bot_create(unsigned long long)
+{
+    return new (std::nothrow) Evaluator();
+}
+
+LINES_BOT_EXPORT int lines_bot_choose(void *bot, const LinesBoardView *view, LinesMove *move)
+{
+    Board board(view->dimension);
+    for (int r = 0; r < view->dimension; ++r) {
+        for (int c = 0; c < view->dimension; ++c) {
+            Board::Cell color = view->cells[r * view->stride + c];
+            if (color != Board::Empty) {
+                board.setCell(Board::index(r, c), color);
+            }
+        }
+    }
+
+    for (int i = 0; i < view->hintCount; ++i) {
+        int cell = view->hintCells[i];
+        board.addHint(Board::index(cell / view->stride, cell % view->stride), view->hintColors[i]);
+    }
+
+    Board::Move best;
+    if (!static_cast<Evaluator*>(bot)->suggestMove(board, best, Candidates)) {
+        return 0;
+    }
+
+    move->from = Board::row(best.m_from) * view->stride + Board::column(best.m_from);
+    move->to = Board::row(best.m_to) * view->stride + Board::column(best.m_to);
+    return 1;
+}
+
+LINES_BOT_EXPORT void lines_bot_destroy(void *bot)
+{
+    delete static_cast<Evaluator*>(bot);
+}
+
+}
@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Bot plugin playing the greedy move of the evaluator.
+# -------------------------------------------------
+TARGET = greedybot
+TEMPLATE = lib
+CONFIG += plugin c++11
+CONFIG -= qt
+
+include(../../engine.pri)
+
+SOURCES += greedybot.cpp
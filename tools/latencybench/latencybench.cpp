@@ -0,0 +1,536 @@
+/*!
+  * @file latencybench.cpp
+  * Measures the latency the player feels: input events are replayed into the game (a real MainWidget
+  * on the offscreen platform, unless QT_QPA_PLATFORM is set) and the time from the delivery of each
+  * event to the frames that show its result is reported, as percentiles per type of interaction:
+  * - handled: the time the event handlers take (the event is sent synchronously);
+  * - first frame: the time to the first frame painted after the event;
+  * - settled: the time to the last frame painted before the board goes idle (the animations and the
+  *   turn played by the game engine are over).
+  *
+  * usage: latencybench [-batched] [-turbo] [-n moves] [-seed n] [script...]
+  *
+  * A script holds one interaction per line ('#' starts a comment):
+  *   press <row> <column>     the left button is pressed over a square
+  *   move <row> <column>      the pointer moves over a square (the button is held if it is pressed)
+  *   release <row> <column>   the left button is released over a square
+  *   hint                     the Hint action
+  *   restart                  the Restart action
+  *   wait <ms>                the events are processed for a while, nothing is measured
+  * An interaction is replayed once the board is idle after the previous one. Without a script, a session
+  * of moves (-n, 50 by default) is played: a random ball is dragged along the squares of its path to a
+  * random reachable square, with a hint every 10 moves. The ball selected by a hint is deselected (a press
+  * and a release over it, not measured) before the next move is drawn. The games and the moves are drawn
+  * from -seed, so the moves of a session are reproduced exactly; the hinted ball depends on how far the
+  * background analysis got. The prompt at the end of a game is answered with a new game.
+  */
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtGui/QMouseEvent>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QMessageBox>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "mainwidget.hpp"
+#include "boardview.hpp"
+#include "griditem.hpp"
+#include "pathfinder.hpp"
+#include "random.hpp"
+#include "utils.hpp"
+
+namespace
+{
+    enum
+    {
+        QuietTime = 50, // the time the board stays idle for an interaction to be over (ms)
+        Timeout = 10000, // an interaction that is not over after this time is cut off (ms)
+        HintPeriod = 10 // a hint is asked for every HintPeriod moves of a session
+    };
+
+    bool s_batched = false;
+
+    /*! \brief The types of the interactions.
+      */
+    enum Type
+    {
+        Press = 0,
+        Move,
+        Release,
+        Hint,
+        Restart,
+        Wait,
+        TypeCount
+    };
+
+    const char *s_typeNames[TypeCount] = {"press", "move", "release", "hint", "restart", "wait"};
+
+    /*! \brief An interaction of a script.
+      */
+    struct Step
+    {
+        Type m_type;
+        int m_row;
+        int m_col;
+        int m_wait;
+    };
+
+    /*! \brief The latencies of the interactions of a type (ms).
+      */
+    struct Samples
+    {
+        std::vector<double> m_handled;
+        std::vector<double> m_firstFrame;
+        std::vector<double> m_settled;
+    };
+
+    /*! This class counts the frames painted by the board view and answers the prompt at the end of a game.
+      */
+    class FrameWatcher : public QObject
+    {
+    public:
+        FrameWatcher() : m_frames(0), m_games(0)
+        {
+            startTimer(10);
+        }
+
+        inline int frames() const
+        {
+            return m_frames;
+        }
+
+        inline int games() const
+        {
+            return m_games;
+        }
+
+        //! the paint events of the viewport of the board view are counted
+        bool eventFilter(QObject *, QEvent *event)
+        {
+            if (event->type() == QEvent::Paint) {
+                ++m_frames;
+            }
+            return false;
+        }
+
+    protected:
+        //! the prompt runs a modal loop: the timer still fires and a new game is chosen
+        void timerEvent(QTimerEvent *)
+        {
+            QMessageBox *box = qobject_cast<QMessageBox*>(QApplication::activeModalWidget());
+            if (box) {
+                ++m_games;
+                box->done(QMessageBox::Yes);
+            }
+        }
+
+    private:
+        int m_frames; /*!< the frames painted so far */
+        int m_games; /*!< the games that came to an end */
+    };
+
+    // Reads a script; returns false if the file cannot be read or holds a bad line.
+    bool readScript(const char *path, std::vector<Step> &steps)
+    {
+        QFile file(QString::fromLocal8Bit(path));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            fprintf(stderr, "cannot read %s\n", path);
+            return false;
+        }
+
+        QTextStream in(&file);
+        for (int number = 1; !in.atEnd(); ++number) {
+            QString line = in.readLine();
+            line = line.left(line.indexOf('#')).simplified();
+            if (line.isEmpty()) {
+                continue;
+            }
+
+            QStringList words = line.split(' ');
+
+            Step step;
+            step.m_type = TypeCount;
+            step.m_row = step.m_col = step.m_wait = 0;
+
+            for (int t = 0; t < TypeCount; ++t) {
+                if (words[0] == s_typeNames[t]) {
+                    step.m_type = Type(t);
+                }
+            }
+
+            bool ok = true;
+            switch (step.m_type) {
+            case Press:
+            case Move:
+            case Release:
+                ok = (words.count() == 3);
+                if (ok) {
+                    step.m_row = words[1].toInt(&ok);
+                }
+                if (ok) {
+                    step.m_col = words[2].toInt(&ok);
+                }
+                break;
+            case Hint:
+            case Restart:
+                ok = (words.count() == 1);
+                break;
+            case Wait:
+                ok = (words.count() == 2);
+                if (ok) {
+                    step.m_wait = words[1].toInt(&ok);
+                }
+                break;
+            default:
+                ok = false;
+                break;
+            }
+
+            if (!ok) {
+                fprintf(stderr, "%s:%d: bad interaction '%s'\n", path, number, qPrintable(line));
+                return false;
+            }
+
+            steps.push_back(step);
+        }
+
+        return true;
+    }
+
+    Step makeStep(Type type, int row = 0, int col = 0)
+    {
+        Step step;
+        step.m_type = type;
+        step.m_row = row;
+        step.m_col = col;
+        step.m_wait = 0;
+        return step;
+    }
+
+    // Appends the interactions of a random move: a ball is dragged along its path to a free square.
+    bool generateMove(GridItem *grid, Random &rng, std::vector<Step> &steps)
+    {
+        std::vector<GridPos> balls;
+        for (int row = 0; row < grid->dim(); ++row) {
+            for (int col = 0; col < grid->dim(); ++col) {
+                if (!grid->isFreePos(row, col)) {
+                    balls.push_back(GridPos(row, col));
+                }
+            }
+        }
+
+        // a few balls are tried: a ball may be walled in
+        for (int attempt = 0; (attempt < 20) && !balls.empty(); ++attempt) {
+            GridPos from = balls[rng.below(int(balls.size()))];
+
+            std::vector<QVector<GridPos> > paths;
+            for (int i = 0; i < grid->size(); ++i) {
+                GridPos to(i / grid->dim(), i % grid->dim());
+                QVector<GridPos> path;
+                if (grid->isFreePos(to) && PathFinder::instance()->execute(grid, from, to, path) && (path.count() >= 2)) {
+                    paths.push_back(path);
+                }
+            }
+
+            if (paths.empty()) {
+                continue;
+            }
+
+            const QVector<GridPos> &path = paths[rng.below(int(paths.size()))];
+
+            steps.push_back(makeStep(Press, from.row(), from.column()));
+            for (int i = 1; i < path.count(); ++i) {
+                steps.push_back(makeStep(Move, path[i].row(), path[i].column()));
+            }
+            steps.push_back(makeStep(Release, path.back().row(), path.back().column()));
+            return true;
+        }
+
+        return false;
+    }
+
+    /*! This class replays the interactions into the board view and measures them.
+      */
+    class Player
+    {
+    public:
+        Player(QApplication &app, BoardView *view, FrameWatcher &watcher)
+            : m_app(app),
+            m_view(view),
+            m_grid(view->grid()),
+            m_watcher(watcher),
+            m_buttons(Qt::NoButton)
+        {
+        }
+
+        // Replays an interaction and waits until the board is idle; the latencies are recorded if measured.
+        void play(const Step &step, bool measured = true)
+        {
+            if (step.m_type == Wait) {
+                run(step.m_wait);
+                return;
+            }
+
+            int frames = m_watcher.frames();
+
+            QElapsedTimer clock;
+            clock.start();
+
+            deliver(step);
+            double handled = clock.nsecsElapsed() * 1e-6;
+
+            double firstFrame = -1;
+            double lastFrame = -1;
+            qint64 idleSince = -1;
+
+            while (clock.elapsed() < Timeout) {
+                m_app.processEvents();
+
+                if (m_watcher.frames() != frames) {
+                    frames = m_watcher.frames();
+                    lastFrame = clock.nsecsElapsed() * 1e-6;
+                    if (firstFrame < 0) {
+                        firstFrame = lastFrame;
+                    }
+                    idleSince = -1;
+                }
+
+                if (!m_grid->isIdle()) {
+                    idleSince = -1;
+                } else if (idleSince < 0) {
+                    idleSince = clock.elapsed();
+                } else if (clock.elapsed() - idleSince >= QuietTime) {
+                    break;
+                }
+
+                QThread::usleep(100);
+            }
+
+            if (!measured) {
+                return;
+            }
+
+            Samples &samples = m_samples[step.m_type];
+            samples.m_handled.push_back(handled);
+            if (firstFrame >= 0) {
+                samples.m_firstFrame.push_back(firstFrame);
+                samples.m_settled.push_back(lastFrame);
+            }
+        }
+
+        // Processes the events until the board has been idle for a while.
+        void settle()
+        {
+            QElapsedTimer clock;
+            clock.start();
+
+            qint64 idleSince = -1;
+            while (clock.elapsed() < Timeout) {
+                m_app.processEvents();
+
+                if (!m_grid->isIdle()) {
+                    idleSince = -1;
+                } else if (idleSince < 0) {
+                    idleSince = clock.elapsed();
+                } else if (clock.elapsed() - idleSince >= QuietTime) {
+                    break;
+                }
+
+                QThread::usleep(100);
+            }
+        }
+
+        // Processes the events for a while.
+        void run(int msecs)
+        {
+            QElapsedTimer clock;
+            clock.start();
+            while (clock.elapsed() < msecs) {
+                m_app.processEvents();
+                QThread::usleep(100);
+            }
+        }
+
+        const Samples &samples(Type type) const
+        {
+            return m_samples[type];
+        }
+
+    private:
+        void deliver(const Step &step)
+        {
+            switch (step.m_type) {
+            case Hint:
+                m_view->hint();
+                return;
+            case Restart:
+                m_view->reset();
+                return;
+            default:
+                break;
+            }
+
+            QPoint pos = m_view->mapFromScene(m_grid->mapToScene(QPointF(m_grid->squareCenter(step.m_row, step.m_col))));
+
+            QEvent::Type type = QEvent::MouseMove;
+            Qt::MouseButton button = Qt::NoButton;
+            if (step.m_type == Press) {
+                type = QEvent::MouseButtonPress;
+                button = Qt::LeftButton;
+                m_buttons = Qt::LeftButton;
+            } else if (step.m_type == Release) {
+                type = QEvent::MouseButtonRelease;
+                button = Qt::LeftButton;
+                m_buttons = Qt::NoButton;
+            }
+
+            QMouseEvent event(type, pos, m_view->viewport()->mapToGlobal(pos), button, m_buttons, Qt::NoModifier);
+            QCoreApplication::sendEvent(m_view->viewport(), &event);
+        }
+
+    private:
+        QApplication &m_app;
+        BoardView *m_view;
+        GridItem *m_grid;
+        FrameWatcher &m_watcher;
+        Qt::MouseButtons m_buttons; /*!< the buttons held */
+        Samples m_samples[TypeCount];
+    };
+
+    // Prints the percentiles of a list of latencies.
+    void printPercentiles(std::vector<double> values)
+    {
+        if (values.empty()) {
+            printf(" %26s", "-");
+            return;
+        }
+
+        std::sort(values.begin(), values.end());
+        size_t n = values.size();
+        double p50 = values[(n - 1) / 2];
+        double p99 = values[std::min(n - 1, size_t(n * 0.99))];
+
+        printf(" %8.2f %8.2f %8.2f", p50, p99, values.back());
+    }
+}
+
+//
+bool isRunningOnDesktop()
+{
+    return true;
+}
+
+//
+bool useBatchedRendering()
+{
+    return s_batched;
+}
+
+//
+int boardDimension()
+{
+    return 9;
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    bool turbo = false;
+    int moves = 50;
+    unsigned int seed = 1;
+    std::vector<Step> script;
+    bool scripted = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-batched")) {
+            s_batched = true;
+        } else if (0 == strcmp(argv[i], "-turbo")) {
+            turbo = true;
+        } else if ((0 == strcmp(argv[i], "-n")) && (i + 1 < argc)) {
+            moves = atoi(argv[++i]);
+        } else if ((0 == strcmp(argv[i], "-seed")) && (i + 1 < argc)) {
+            seed = (unsigned int)strtoul(argv[++i], 0, 10);
+        } else {
+            if (!readScript(argv[i], script)) {
+                return 1;
+            }
+            scripted = true;
+        }
+    }
+
+    // the games drawn by the game engine are seeded as in main.cpp
+    qsrand(seed);
+
+    QApplication app(argc, argv);
+
+    MainWidget *window = MainWidget::instance();
+    window->show();
+
+    BoardView *view = window->boardView();
+    view->setTurbo(turbo);
+
+    FrameWatcher watcher;
+    view->viewport()->installEventFilter(&watcher);
+
+    Player player(app, view, watcher);
+
+    // the first game is started by the view: its spawns are played out
+    player.settle();
+
+    if (scripted) {
+        for (size_t i = 0; i < script.size(); ++i) {
+            player.play(script[i]);
+        }
+    } else {
+        Random rng(seed);
+        for (int move = 0; move < moves; ++move) {
+            if ((move % HintPeriod) == HintPeriod - 1) {
+                player.play(makeStep(Hint));
+
+                // a press on another ball would be ignored while the hinted one is selected
+                GridPos hinted;
+                if (view->grid()->selectedBall(hinted)) {
+                    player.play(makeStep(Press, hinted.row(), hinted.column()), false);
+                    player.play(makeStep(Release, hinted.row(), hinted.column()), false);
+                }
+            }
+
+            std::vector<Step> steps;
+            if (!generateMove(view->grid(), rng, steps)) {
+                steps.push_back(makeStep(Restart));
+            }
+
+            for (size_t i = 0; i < steps.size(); ++i) {
+                player.play(steps[i]);
+            }
+        }
+    }
+
+    printf("%s rendering%s, %d frames, %d games over (latencies in ms)\n", s_batched ? "batched" : "item",
+           turbo ? ", turbo" : "", watcher.frames(), watcher.games());
+    printf("%-8s %6s %26s %26s %26s\n", "", "count", "handled p50/p99/max", "first frame p50/p99/max", "settled p50/p99/max");
+
+    for (int t = 0; t < Wait; ++t) {
+        const Samples &samples = player.samples(Type(t));
+        if (samples.m_handled.empty()) {
+            continue;
+        }
+
+        printf("%-8s %6d", s_typeNames[t], int(samples.m_handled.size()));
+        printPercentiles(samples.m_handled);
+        printPercentiles(samples.m_firstFrame);
+        printPercentiles(samples.m_settled);
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Latency from the input to the frames that show its result, replayed into the game offscreen.
+# -------------------------------------------------
+TARGET = latencybench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+include(../../gui.pri)
+
+SOURCES += latencybench.cpp
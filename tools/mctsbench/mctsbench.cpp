@@ -0,0 +1,88 @@
+/*!
+  * @file mctsbench.cpp
+  * Measures the playouts per second of the Monte Carlo tree search for 1, 2, 4 ... threads
+  * and the speedup over a single thread, on a position reached by a seeded random game.
+  *
+  * usage: mctsbench [milliseconds] [max threads] [seed] [random|greedy]
+  */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "board.hpp"
+#include "montecarlo.hpp"
+
+namespace
+{
+    // Plays a few random moves so the benchmark does not start from an almost empty board.
+    Board openingPosition(uint64_t seed, int turns)
+    {
+        std::vector<Board::Move> moves(Board::MaxMoves);
+
+        Random rng(seed);
+        Board board;
+        board.spawn(rng, true);
+
+        for (int i = 0; i < turns; ++i) {
+            int n = board.legalMoves(&moves[0]);
+            if ((0 == n) || board.isGameOver()) {
+                break;
+            }
+
+            board.play(moves[rng.below(n)], rng);
+        }
+
+        return board;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int ms = (argc > 1) ? atoi(argv[1]) : 1000;
+    int maxThreads = (argc > 2) ? atoi(argv[2]) : int(std::thread::hardware_concurrency());
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], 0, 10) : 1;
+    bool greedy = !((argc > 4) && (0 == strcmp(argv[4], "random")));
+
+    if (maxThreads <= 0) {
+        maxThreads = 1;
+    }
+
+    Board board = openingPosition(seed, 10);
+
+    MonteCarlo search;
+    search.setTimeBudget(ms);
+    search.setSeed(seed);
+    search.setRolloutPolicy(greedy ? MonteCarlo::GreedyRollout : MonteCarlo::RandomRollout);
+
+    printf("%s rollouts, %d ms per search\n", greedy ? "greedy" : "random", ms);
+
+    // the powers of two below the maximum, then the maximum itself
+    std::vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);
+
+    double single = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        int threads = counts[i];
+        search.setThreads(threads);
+
+        Board::Move move;
+        search.bestMove(board, move);
+
+        double rate = search.playoutsPerSecond();
+        if (1 == threads) {
+            single = rate;
+        }
+
+        printf("%3d threads : %10.0f playouts/s  (x%.2f)  best %d,%d -> %d,%d  value %.1f\n",
+               threads, rate, (single > 0) ? rate / single : 0,
+               Board::row(move.m_from), Board::column(move.m_from),
+               Board::row(move.m_to), Board::column(move.m_to), search.value());
+    }
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Throughput and scaling of the Monte Carlo tree search.
+# -------------------------------------------------
+TARGET = mctsbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += mctsbench.cpp
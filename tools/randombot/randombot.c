@@ -0,0 +1,114 @@
+/*!
+  * @file randombot.c
+  * A bot plugin written in plain C: moves a random ball that can move onto a random cell it can reach.
+  */
+
+#include <stdlib.h>
+#include <string.h>
+#include "botplugin.h"
+
+#define MAX_CELLS 1024
+
+/* the state of an instance: a xorshift generator */
+typedef struct RandomBot
+{
+    unsigned long long state;
+} RandomBot;
+
+static unsigned int nextRandom(RandomBot *bot, unsigned int n)
+{
+    bot->state ^= bot->state << 13;
+    bot->state ^= bot->state >> 7;
+    bot->state ^= bot->state << 17;
+    return (unsigned int)((bot->state >> 32) % n);
+}
+
+/* the empty cells next to a cell */
+static int emptyNeighbours(const LinesBoardView *view, int cell, int *neighbours)
+{
+    int r = cell / view->stride;
+    int c = cell % view->stride;
+    int count = 0;
+
+    if ((c > 0) && (0 == view->cells[cell - 1])) neighbours[count++] = cell - 1;
+    if ((c < view->dimension - 1) && (0 == view->cells[cell + 1])) neighbours[count++] = cell + 1;
+    if ((r > 0) && (0 == view->cells[cell - view->stride])) neighbours[count++] = cell - view->stride;
+    if ((r < view->dimension - 1) && (0 == view->cells[cell + view->stride])) neighbours[count++] = cell + view->stride;
+
+    return count;
+}
+
+LINES_BOT_EXPORT int lines_bot_abi_version(void)
+{
+    return LINES_BOT_ABI_VERSION;
+}
+
+LINES_BOT_EXPORT const char *lines_bot_name(void)
+{
+    return "random";
+}
+
+LINES_BOT_EXPORT void *lines_bot_create(unsigned long long seed)
+{
+    RandomBot *bot = (RandomBot*)malloc(sizeof(RandomBot));
+    if (bot) {
+        bot->state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    }
+    return bot;
+}
+
+LINES_BOT_EXPORT int lines_bot_choose(void *instance, const LinesBoardView *view, LinesMove *move)
+{
+    RandomBot *bot = (RandomBot*)instance;
+    int balls[MAX_CELLS];
+    int queue[MAX_CELLS];
+    unsigned char seen[MAX_CELLS];
+    int neighbours[4];
+    int count = 0;
+    int head = 0;
+    int tail = 0;
+    int r, c, i;
+
+    if (view->dimension * view->stride > MAX_CELLS) {
+        return 0;
+    }
+
+    for (r = 0; r < view->dimension; ++r) {
+        for (c = 0; c < view->dimension; ++c) {
+            int cell = r * view->stride + c;
+            if (view->cells[cell] && (emptyNeighbours(view, cell, neighbours) > 0)) {
+                balls[count++] = cell;
+            }
+        }
+    }
+
+    if (0 == count) {
+        return 0;
+    }
+
+    move->from = balls[nextRandom(bot, (unsigned int)count)];
+
+    /* the cells reachable by the ball (breadth-first search) */
+    memset(seen, 0, sizeof(seen));
+    seen[move->from] = 1;
+    queue[tail++] = move->from;
+
+    while (head < tail) {
+        int n = emptyNeighbours(view, queue[head++], neighbours);
+        for (i = 0; i < n; ++i) {
+            if (!seen[neighbours[i]]) {
+                seen[neighbours[i]] = 1;
+                queue[tail++] = neighbours[i];
+            }
+        }
+    }
+
+    /* queue[0] is the ball itself */
+    move->to = queue[1 + nextRandom(bot, (unsigned int)(tail - 1))];
+    return 1;
+}
+
+LINES_BOT_EXPORT void lines_bot_destroy(void *bot)
+{
+    free(bot);
+}
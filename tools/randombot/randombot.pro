@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Bot plugin playing random legal moves (plain C).
+# -------------------------------------------------
+TARGET = randombot
+TEMPLATE = lib
+CONFIG += plugin
+CONFIG -= qt
+
+INCLUDEPATH += ../..
+
+SOURCES += randombot.c
@@ -0,0 +1,424 @@
+/*!
+  * @file renderbench.cpp
+  * Measures the time of the frames of the board view rendered offscreen: still frames of scripted
+  * boards and the frames of an animation (the longest walk of a ball on the board followed by the
+  * blink of a line), replayed at fixed times 16 ms apart. The view is rendered into an image, so it
+  * runs without a display: the offscreen platform is used unless QT_QPA_PLATFORM is set. The time
+  * spent in GridItem::paint() and in BallItem::paint() is reported apart (see PaintProfile).
+  *
+  * usage: renderbench [-batched] [-d dimension] [-z zoom] [-f frames] [-s directory] [board-file...]
+  *
+  * -batched renders the balls as the game does with the same option, -d sets the dimension of the grid
+  * (9 by default, up to 128), -z scales the view (by default a grid larger than the view is fitted into
+  * it, so the tiles and the levels of detail of the large grids are exercised), -f sets the number of
+  * the still frames per board (100 by default) and -s saves every frame as a PNG image into a directory.
+  *
+  * A board file holds boards of N lines of N characters, N being the dimension: '.' for an empty square,
+  * '1' to '5' for a ball of a color and 'a' to 'e' for a 'hint' ball of a color; the boards are separated
+  * by empty lines. Without a board file, four boards filled at 0%, 25%, 50% and 90% are generated from
+  * a fixed seed. A grid larger than Board::MaxDimension is only rendered: the game is not played on it.
+  */
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtGui/QImage>
+#include <QtGui/QTransform>
+#include <QtWidgets/QApplication>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "mainwidget.hpp"
+#include "boardview.hpp"
+#include "griditem.hpp"
+#include "paintprofile.hpp"
+#include "random.hpp"
+#include "utils.hpp"
+
+namespace
+{
+    enum
+    {
+        DefaultDimension = 9, // the dimension of the grid of the game
+        MaxDimension = 128, // a ball item is pooled per square and the path finder indexes the squares on 16 bits
+        SampledBalls = 64, // the walks of a grid of more than 256 squares start from as many balls
+        FrameInterval = 16, // the time between two frames of an animation (ms)
+        MaxAnimationFrames = 1000 // the frames of an animation that does not end are cut off
+    };
+
+    bool s_batched = false;
+    int s_dimension = DefaultDimension;
+
+    /*! \brief A scripted board.
+      */
+    struct Script
+    {
+        QString m_name;
+        QVector<unsigned char> m_balls; // the colors of the balls, row by row (see GridItem::loadSquares())
+        QVector<unsigned char> m_hints; // the colors of the 'hint' balls, row by row
+    };
+
+    /*! \brief The sums of the times of the frames.
+      */
+    struct FrameStats
+    {
+        FrameStats() : m_frames(0), m_total(0), m_grid(0), m_balls(0), m_ballCalls(0) {}
+
+        int m_frames;
+        qint64 m_total; // ns
+        qint64 m_grid; // ns
+        qint64 m_balls; // ns
+        qint64 m_ballCalls;
+    };
+
+    // Reads the boards of a file; returns false if the file cannot be read or holds a bad board.
+    bool readBoards(const char *path, std::vector<Script> &scripts)
+    {
+        QFile file(QString::fromLocal8Bit(path));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            fprintf(stderr, "cannot read %s\n", path);
+            return false;
+        }
+
+        QTextStream in(&file);
+        QStringList rows;
+        int count = 0;
+
+        while (true) {
+            QString line = in.readLine();
+            bool end = line.isNull();
+            line = line.trimmed();
+
+            if (!line.isEmpty()) {
+                rows.append(line);
+            }
+            if ((rows.count() < s_dimension) && !end) {
+                continue;
+            }
+            if (rows.isEmpty()) {
+                break;
+            }
+
+            Script script;
+            script.m_name = QString("%1:%2").arg(QFileInfo(file).baseName()).arg(++count);
+            script.m_balls.fill(0, s_dimension * s_dimension);
+            script.m_hints.fill(0, s_dimension * s_dimension);
+
+            for (int row = 0; row < s_dimension; ++row) {
+                if ((row >= rows.count()) || (rows[row].length() != s_dimension)) {
+                    fprintf(stderr, "%s: board %d: a row is not %d squares long\n", path, count, s_dimension);
+                    return false;
+                }
+
+                for (int col = 0; col < s_dimension; ++col) {
+                    char c = rows[row][col].toLatin1();
+                    if ((c >= '1') && (c <= '5')) {
+                        script.m_balls[row * s_dimension + col] = c - '0';
+                    } else if ((c >= 'a') && (c <= 'e')) {
+                        script.m_hints[row * s_dimension + col] = c - 'a' + 1;
+                    } else if (c != '.') {
+                        fprintf(stderr, "%s: board %d: bad square '%c'\n", path, count, c);
+                        return false;
+                    }
+                }
+            }
+
+            scripts.push_back(script);
+            rows.clear();
+
+            if (end) {
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    // Generates boards of a growing share of balls (in percents of the squares), with three 'hint'
+    // balls on free squares.
+    void generateBoards(std::vector<Script> &scripts)
+    {
+        const int fills[] = {0, 25, 50, 90};
+        int size = s_dimension * s_dimension;
+
+        for (size_t i = 0; i < sizeof(fills) / sizeof(fills[0]); ++i) {
+            Random rng(i + 1);
+            Script script;
+            script.m_name = QString("fill%1").arg(fills[i]);
+            script.m_balls.fill(0, size);
+            script.m_hints.fill(0, size);
+
+            int balls = size * fills[i] / 100;
+            for (int n = 0; n < qMin(balls + 3, size); ++n) {
+                int index;
+                do {
+                    index = rng.below(size);
+                } while (script.m_balls[index] || script.m_hints[index]);
+
+                unsigned char color = 1 + rng.below(5);
+                if (n < balls) {
+                    script.m_balls[index] = color;
+                } else {
+                    script.m_hints[index] = color;
+                }
+            }
+
+            scripts.push_back(script);
+        }
+    }
+
+    // Renders the view into the image and adds the times of the frame.
+    void renderFrame(BoardView *view, QImage &image, FrameStats &stats)
+    {
+        PaintProfile *profile = PaintProfile::instance();
+        profile->reset();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        image.fill(Qt::black);
+        view->render(&image);
+
+        stats.m_total += timer.nsecsElapsed();
+        stats.m_grid += profile->nsecs(PaintProfile::GridPaint);
+        stats.m_balls += profile->nsecs(PaintProfile::BallPaint);
+        stats.m_ballCalls += profile->calls(PaintProfile::BallPaint);
+        ++stats.m_frames;
+    }
+
+    void saveFrame(const QString &directory, const QString &name, const QImage &image)
+    {
+        if (!directory.isEmpty()) {
+            image.save(QDir(directory).filePath(name + ".png"));
+        }
+    }
+
+    // Plays the events of the game engine and the animations until the grid is idle.
+    void settle(QApplication &app, GridItem *grid)
+    {
+        grid->setTurbo(true);
+
+        QElapsedTimer timer;
+        timer.start();
+        while (!grid->isIdle() && (timer.elapsed() < 5000)) {
+            app.processEvents();
+            grid->processEngineEvents();
+            grid->flushDirtyRegion();
+            QThread::msleep(1);
+        }
+
+        grid->setTurbo(false);
+    }
+
+    // Searches the longest of the shortest paths from a ball of the grid to a free square: the free
+    // squares are visited breadth first from every ball (from a sample of the balls on a large grid).
+    bool longestWalk(GridItem *grid, QVector<GridPos> &walk)
+    {
+        const int steps[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+        int n = grid->dim();
+
+        QVector<int> balls;
+        for (int i = 0; i < grid->size(); ++i) {
+            if (!grid->isFreePos(i / n, i % n)) {
+                balls.append(i);
+            }
+        }
+
+        if ((grid->size() > 256) && (balls.count() > SampledBalls)) {
+            Random rng(1);
+            for (int i = 0; i < SampledBalls; ++i) {
+                qSwap(balls[i], balls[i + rng.below(balls.count() - i)]);
+            }
+            balls.resize(SampledBalls);
+        }
+
+        QVector<int> cameFrom(grid->size());
+        QVector<int> depth(grid->size());
+        QVector<int> queue;
+        queue.reserve(grid->size());
+
+        walk.clear();
+        foreach (int ball, balls) {
+            cameFrom.fill(-1);
+            depth[ball] = 0;
+            cameFrom[ball] = ball;
+            queue.clear();
+            queue.append(ball);
+
+            // the last square visited is one of the farthest
+            for (int head = 0; head < queue.count(); ++head) {
+                int square = queue[head];
+                for (int k = 0; k < 4; ++k) {
+                    int row = square / n + steps[k][0];
+                    int col = square % n + steps[k][1];
+                    int next = row * n + col;
+                    if (grid->isValidPosition(row, col) && (cameFrom[next] < 0) && grid->isFreePos(row, col)) {
+                        cameFrom[next] = square;
+                        depth[next] = depth[square] + 1;
+                        queue.append(next);
+                    }
+                }
+            }
+
+            int last = queue.back();
+            if (depth[last] + 1 <= walk.count()) {
+                continue;
+            }
+
+            walk.resize(depth[last] + 1);
+            for (int i = depth[last]; i >= 0; --i) {
+                walk[i] = GridPos(last / n, last % n);
+                last = cameFrom[last];
+            }
+        }
+
+        return walk.count() >= 2;
+    }
+
+    double perFrame(qint64 nsecs, int frames)
+    {
+        return frames ? double(nsecs) * 1e-6 / frames : 0.0;
+    }
+}
+
+//
+bool isRunningOnDesktop()
+{
+    return true;
+}
+
+//
+bool useBatchedRendering()
+{
+    return s_batched;
+}
+
+//
+int boardDimension()
+{
+    return s_dimension;
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    int frames = 100;
+    double zoom = 0;
+    QString directory;
+    std::vector<const char*> files;
+
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "-batched")) {
+            s_batched = true;
+        } else if ((0 == strcmp(argv[i], "-d")) && (i + 1 < argc)) {
+            s_dimension = qBound(2, atoi(argv[++i]), int(MaxDimension));
+        } else if ((0 == strcmp(argv[i], "-z")) && (i + 1 < argc)) {
+            zoom = atof(argv[++i]);
+        } else if ((0 == strcmp(argv[i], "-f")) && (i + 1 < argc)) {
+            frames = atoi(argv[++i]);
+        } else if ((0 == strcmp(argv[i], "-s")) && (i + 1 < argc)) {
+            directory = QString::fromLocal8Bit(argv[++i]);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    std::vector<Script> scripts;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!readBoards(files[i], scripts)) {
+            return 1;
+        }
+    }
+    if (files.empty()) {
+        generateBoards(scripts);
+    }
+
+    if (!directory.isEmpty() && !QDir().mkpath(directory)) {
+        fprintf(stderr, "cannot create %s\n", qPrintable(directory));
+        return 1;
+    }
+
+    QApplication app(argc, argv);
+
+    MainWidget *window = MainWidget::instance();
+    window->show();
+
+    BoardView *view = window->boardView();
+    GridItem *grid = view->grid();
+
+    // the first game is started by the view: its spawns are played out
+    settle(app, grid);
+
+    if (zoom > 0) {
+        view->setTransform(QTransform::fromScale(zoom, zoom));
+    } else if (!view->viewport()->rect().contains(view->mapFromScene(view->sceneRect()).boundingRect())) {
+        view->fitInView(view->sceneRect(), Qt::KeepAspectRatio);
+    }
+
+    QImage image(view->size(), QImage::Format_ARGB32_Premultiplied);
+
+    printf("%s rendering, %dx%d squares, %dx%d pixels, scale %.3f\n", s_batched ? "batched" : "item",
+           grid->dim(), grid->dim(), image.width(), image.height(), view->transform().m11());
+
+    for (size_t s = 0; s < scripts.size(); ++s) {
+        const Script &script = scripts[s];
+
+        grid->loadSquares(script.m_balls, script.m_hints);
+        grid->flushDirtyRegion();
+
+        FrameStats still;
+        for (int i = 0; i < frames; ++i) {
+            renderFrame(view, image, still);
+        }
+        saveFrame(directory, script.m_name, image);
+
+        printf("%-12s still: %8.3f ms/frame (grid %8.3f, balls %8.3f in %lld calls)\n",
+               qPrintable(script.m_name), perFrame(still.m_total, still.m_frames),
+               perFrame(still.m_grid, still.m_frames), perFrame(still.m_balls, still.m_frames),
+               still.m_frames ? still.m_ballCalls / still.m_frames : 0);
+
+        // the ball walks as far as it can, then the balls of a row blink
+        QVector<GridPos> walk;
+        if (!longestWalk(grid, walk)) {
+            continue;
+        }
+
+        grid->moveBall(grid->ballAt(walk.front()), walk);
+
+        QList<GridPos> blinking;
+        for (int col = 0; col < grid->dim(); ++col) {
+            if (!grid->isFreePos(walk.back().row(), col)) {
+                blinking.append(GridPos(walk.back().row(), col));
+            }
+        }
+        grid->animateBalls(blinking);
+
+        FrameStats animation;
+        for (long long now = 0; animation.m_frames < MaxAnimationFrames; now += FrameInterval) {
+            grid->processEngineEvents(now);
+            grid->flushDirtyRegion();
+
+            renderFrame(view, image, animation);
+            saveFrame(directory, QString("%1_%2").arg(script.m_name).arg(animation.m_frames, 3, 10, QChar('0')), image);
+
+            if (grid->isIdle()) {
+                break;
+            }
+        }
+
+        printf("%-12s walk of %d squares and blink: %d frames, %8.3f ms/frame (grid %8.3f, balls %8.3f)\n",
+               qPrintable(script.m_name), walk.count() - 1, animation.m_frames,
+               perFrame(animation.m_total, animation.m_frames), perFrame(animation.m_grid, animation.m_frames),
+               perFrame(animation.m_balls, animation.m_frames));
+    }
+
+    return 0;
+}
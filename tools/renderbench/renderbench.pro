@@ -0,0 +1,12 @@
+# -------------------------------------------------
+# Frame time of the board view rendered offscreen, with the time of the paint() methods of the items.
+# -------------------------------------------------
+TARGET = renderbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+DEFINES += LINES_PAINT_PROFILE
+
+include(../../gui.pri)
+
+SOURCES += renderbench.cpp
@@ -0,0 +1,154 @@
+/*!
+  * @file spritebench.cpp
+  * Measures the time of a frame of a full board painted as the balls used to be painted (a geometry
+  * change, a gradient update and an antialiased gradient fill per ball) and as blits from the sprite
+  * cache. Every frame is painted offscreen into an image of the size of the board, so it runs
+  * without a display (e.g. with -platform offscreen).
+  *
+  * usage: spritebench [-f frames] [-r dpr] [dimension...]   (the dimensions default to 9 and 100)
+  */
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QVector>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+#include <QtGui/QRadialGradient>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "ballspritecache.hpp"
+
+namespace
+{
+    enum
+    {
+        SquareSize = 50 // the size of a square on the desktop (see GridItem)
+    };
+
+    const qreal BallRadius = 16.0;
+
+    // The look of the ball of a square: a pseudo-random color, a few selected and 'hint' balls.
+    void look(int square, int &color, BallSpriteCache::State &state)
+    {
+        unsigned h = unsigned(square) * 2654435761u;
+        color = int((h >> 8) % 5);
+        state = ((h >> 16) % 16 == 0) ? BallSpriteCache::Hint :
+                (((h >> 20) % 64 == 0) ? BallSpriteCache::Selected : BallSpriteCache::Normal);
+    }
+
+    // Paints a frame as BallItem::paint() used to: the gradient is resized and the ellipse filled.
+    void paintGradients(QPainter &painter, int dimension, const QVector<QColor> &colors)
+    {
+        QVector<QRadialGradient> gradients;
+        for (int i = 0; i < colors.count(); ++i) {
+            QRadialGradient gradient(QPointF(0, 0), 0);
+            gradient.setColorAt(0.02, colors[i].lighter());
+            gradient.setColorAt(0.98, colors[i]);
+            gradients.push_back(gradient);
+        }
+
+        painter.setPen(Qt::NoPen);
+        for (int square = 0; square < dimension * dimension; ++square) {
+            int color;
+            BallSpriteCache::State state;
+            look(square, color, state);
+
+            qreal radius = BallRadius * BallSpriteCache::scale(state);
+            gradients[color].setRadius(radius);
+
+            painter.save();
+            painter.translate((square % dimension) * SquareSize + SquareSize / 2,
+                              (square / dimension) * SquareSize + SquareSize / 2);
+            painter.setBrush(gradients[color]);
+            painter.drawEllipse(QRectF(-radius, -radius, 2 * radius, 2 * radius));
+            painter.restore();
+        }
+    }
+
+    // Paints a frame as BallItem::paint() does: a blit per ball.
+    void paintSprites(QPainter &painter, int dimension, BallSpriteCache &sprites, qreal dpr)
+    {
+        for (int square = 0; square < dimension * dimension; ++square) {
+            int color;
+            BallSpriteCache::State state;
+            look(square, color, state);
+
+            const QPixmap &sprite = sprites.sprite(color, state, dpr);
+            qreal half = sprite.width() / sprite.devicePixelRatio() / 2;
+            painter.drawPixmap(QPointF((square % dimension) * SquareSize + SquareSize / 2 - half,
+                                       (square / dimension) * SquareSize + SquareSize / 2 - half), sprite);
+        }
+    }
+
+    // Paints frames until a second has passed (and at least 'frames' of them); returns the ms per frame.
+    template <typename Paint>
+    double measure(QImage &image, int frames, Paint paint)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        int n = 0;
+        while ((n < frames) || (timer.elapsed() < 1000)) {
+            image.fill(Qt::transparent);
+
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::Antialiasing);
+            paint(painter);
+            ++n;
+        }
+
+        return double(timer.nsecsElapsed()) * 1e-6 / n;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    int frames = 10;
+    qreal dpr = 1.0;
+    QVector<int> dimensions;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-f")) && (i + 1 < argc)) {
+            frames = atoi(argv[++i]);
+        } else if ((0 == strcmp(argv[i], "-r")) && (i + 1 < argc)) {
+            dpr = atof(argv[++i]);
+        } else if (atoi(argv[i]) > 0) {
+            dimensions.push_back(atoi(argv[i]));
+        }
+    }
+
+    if (dimensions.isEmpty()) {
+        dimensions << 9 << 100;
+    }
+
+    QVector<QColor> colors;
+    colors << QColor(Qt::red) << QColor(Qt::blue) << QColor(Qt::green) << QColor(Qt::yellow) << QColor(Qt::magenta);
+
+    BallSpriteCache sprites;
+    sprites.init(colors, BallRadius);
+
+    for (int d = 0; d < dimensions.count(); ++d) {
+        int dimension = dimensions[d];
+        int size = qRound(dimension * SquareSize * dpr);
+
+        QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(dpr);
+
+        double gradientTime = measure(image, frames, [&](QPainter &painter) {
+            paintGradients(painter, dimension, colors);
+        });
+        double spriteTime = measure(image, frames, [&](QPainter &painter) {
+            paintSprites(painter, dimension, sprites, dpr);
+        });
+
+        printf("%3dx%-3d (%5d balls, dpr %.2f): gradients %9.3f ms/frame, sprites %9.3f ms/frame (x%.1f)\n",
+               dimension, dimension, dimension * dimension, dpr, gradientTime, spriteTime, gradientTime / spriteTime);
+    }
+
+    printf("%d sprites cached\n", sprites.count());
+
+    return 0;
+}
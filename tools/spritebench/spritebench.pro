@@ -0,0 +1,14 @@
+# -------------------------------------------------
+# Frame time of the balls painted with their gradient or blitted from the sprite cache.
+# -------------------------------------------------
+TARGET = spritebench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+QT += gui
+
+INCLUDEPATH += ../..
+
+SOURCES += spritebench.cpp \
+    ../../ballspritecache.cpp
+HEADERS += ../../ballspritecache.hpp
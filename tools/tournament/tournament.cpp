@@ -0,0 +1,194 @@
+/*!
+  * @file tournament.cpp
+  * Plays every bot plugin on the same seeded games on all the cores and reports the mean scores
+  * with their 95% confidence intervals. The game i is played with the seed + i by every bot, so
+  * the bots draw their spawns from the same sequence of random numbers and the differences with
+  * the first bot are compared game by game (paired). Every game gets a new instance of the bot
+  * created with its seed, so the results do not depend on the number of the threads.
+  *
+  * usage: tournament [-g games] [-t threads] [-s seed] [-d dimension] <plugin> [plugin...]
+  */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "botlibrary.hpp"
+
+namespace
+{
+    // The settings and the results shared by the threads.
+    struct Tournament
+    {
+        std::vector<BotLibrary*> m_bots;
+        int m_games;
+        int m_dimension;
+        uint64_t m_seed;
+        std::atomic<long long> m_next; // the next (game, bot) pair to play
+        std::vector<std::vector<int> > m_scores; // the scores by bot and by game
+        std::atomic<long long> m_resigned; // the games ended by a resignation or an illegal move
+        std::atomic<long long> m_moves;
+    };
+
+    // Plays a game to its end with a new instance of the bot; returns its score.
+    int playGame(const BotLibrary &bot, int dimension, uint64_t seed, long long &moves, bool &resigned)
+    {
+        void *instance = bot.create(seed);
+        if (!instance) {
+            resigned = true;
+            return 0;
+        }
+
+        Random rng(seed);
+        Board board(dimension);
+        board.spawn(rng, true);
+
+        while (!board.isGameOver()) {
+            Board::Move move;
+            if (!bot.chooseMove(instance, board, move)) {
+                resigned = true;
+                break;
+            }
+
+            board.play(move, rng);
+            ++moves;
+        }
+
+        bot.destroy(instance);
+
+        return board.score();
+    }
+
+    // Plays the next pairs (game, bot) until all of them are played.
+    void run(Tournament &tournament)
+    {
+        int bots = int(tournament.m_bots.size());
+        long long moves = 0;
+        long long total = (long long)tournament.m_games * bots;
+
+        for (long long next = tournament.m_next++; next < total; next = tournament.m_next++) {
+            int game = int(next / bots);
+            int b = int(next % bots);
+
+            bool resigned = false;
+            tournament.m_scores[b][game] = playGame(*tournament.m_bots[b], tournament.m_dimension,
+                                                    tournament.m_seed + uint64_t(game), moves, resigned);
+            if (resigned) {
+                ++tournament.m_resigned;
+            }
+        }
+
+        tournament.m_moves += moves;
+    }
+
+    // Computes the mean of values and the half width of its 95% confidence interval.
+    void meanInterval(const std::vector<double> &values, double &mean, double &interval)
+    {
+        double n = double(values.size());
+        double sum = 0;
+        for (size_t i = 0; i < values.size(); ++i) {
+            sum += values[i];
+        }
+        mean = sum / n;
+
+        double squares = 0;
+        for (size_t i = 0; i < values.size(); ++i) {
+            squares += (values[i] - mean) * (values[i] - mean);
+        }
+
+        interval = (n > 1) ? 1.96 * std::sqrt(squares / (n - 1) / n) : 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int games = 1000;
+    int threads = 0;
+    int dimension = 9;
+    uint64_t seed = 1;
+    std::vector<const char*> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-g")) && (i + 1 < argc)) {
+            games = atoi(argv[++i]);
+        } else if ((0 == strcmp(argv[i], "-t")) && (i + 1 < argc)) {
+            threads = atoi(argv[++i]);
+        } else if ((0 == strcmp(argv[i], "-s")) && (i + 1 < argc)) {
+            seed = strtoull(argv[++i], 0, 10);
+        } else if ((0 == strcmp(argv[i], "-d")) && (i + 1 < argc)) {
+            dimension = atoi(argv[++i]);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty() || (games < 1)) {
+        fprintf(stderr, "usage: tournament [-g games] [-t threads] [-s seed] [-d dimension] <plugin> [plugin...]\n");
+        return 2;
+    }
+
+    if (threads <= 0) {
+        threads = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+
+    // the libraries are never copied (the vector is not resized)
+    std::vector<BotLibrary> libraries(paths.size());
+    Tournament tournament;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!libraries[i].load(paths[i])) {
+            fprintf(stderr, "%s\n", libraries[i].error().c_str());
+            return 2;
+        }
+        tournament.m_bots.push_back(&libraries[i]);
+    }
+
+    tournament.m_games = games;
+    tournament.m_dimension = dimension;
+    tournament.m_seed = seed;
+    tournament.m_next = 0;
+    tournament.m_scores.assign(paths.size(), std::vector<int>(games, 0));
+    tournament.m_resigned = 0;
+    tournament.m_moves = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(run, std::ref(tournament)));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+
+    double seconds = double(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()) * 1e-3;
+    double played = double(games) * double(paths.size());
+
+    printf("%.0f games in %.1f s on %d threads: %.0f games/hour, %.0f moves/s; %lld resigned\n",
+           played, seconds, threads, played / seconds * 3600.0, double(tournament.m_moves.load()) / seconds,
+           tournament.m_resigned.load());
+
+    for (size_t b = 0; b < paths.size(); ++b) {
+        std::vector<double> scores(games);
+        std::vector<double> differences(games);
+        for (int g = 0; g < games; ++g) {
+            scores[g] = tournament.m_scores[b][g];
+            differences[g] = tournament.m_scores[b][g] - tournament.m_scores[0][g];
+        }
+
+        double mean, interval;
+        meanInterval(scores, mean, interval);
+        printf("%-20s : %10.1f +- %8.1f", libraries[b].name().c_str(), mean, interval);
+
+        if (b > 0) {
+            meanInterval(differences, mean, interval);
+            printf("   vs %s: %+10.1f +- %8.1f", libraries[0].name().c_str(), mean, interval);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
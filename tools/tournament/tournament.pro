@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Tournament of the bot plugins.
+# -------------------------------------------------
+TARGET = tournament
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += tournament.cpp
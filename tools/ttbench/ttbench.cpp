@@ -0,0 +1,132 @@
+/*!
+  * @file ttbench.cpp
+  * Measures the transposition table in two ways: the expectimax search of a few positions
+  * with and without the table (time, evaluated positions, hit and collision rates) and
+  * a stress of the table alone by several threads (probes per second and probe latency).
+  *
+  * usage: ttbench [positions] [depth] [threads] [megabytes] [seed]
+  */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "board.hpp"
+#include "expectimax.hpp"
+#include "transpositiontable.hpp"
+
+namespace
+{
+    // Plays random games and collects a position every few moves.
+    void collectPositions(std::vector<Board> &positions, int count, uint64_t seed)
+    {
+        std::vector<Board::Move> moves(Board::MaxMoves);
+
+        Random rng(seed);
+        Board board;
+        board.spawn(rng, true);
+
+        int turn = 0;
+        while (int(positions.size()) < count) {
+            int n = board.legalMoves(&moves[0]);
+            if ((0 == n) || board.isGameOver()) {
+                board.reset();
+                board.spawn(rng, true);
+                continue;
+            }
+
+            board.play(moves[rng.below(n)], rng);
+            if (0 == (++turn % 5)) {
+                positions.push_back(board);
+            }
+        }
+    }
+
+    // Searches all the positions; returns the elapsed time in seconds.
+    double searchAll(const std::vector<Board> &positions, int depth, TranspositionTable *table, long long &nodes)
+    {
+        Expectimax search;
+        search.setTimeBudget(0);
+        search.setMaxDepth(depth);
+        search.setTable(table);
+
+        nodes = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            Board::Move move;
+            search.bestMove(positions[i], move);
+            nodes += search.nodes();
+        }
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // The threads probe and store random keys of a working set twice as large as the table.
+    void stress(TranspositionTable &table, int thread, long long operations)
+    {
+        Random rng(Random::mix(uint64_t(thread) + 1));
+        uint64_t keys = table.capacity() * 2;
+
+        for (long long i = 0; i < operations; ++i) {
+            uint64_t key = Random::mix(rng.next() % keys);
+            TranspositionTable::Entry entry;
+            if (!table.probe(key, entry)) {
+                table.store(key, float(i), int(i & 7));
+            }
+        }
+    }
+
+    void printStats(const TranspositionTable &table)
+    {
+        TranspositionTable::Stats stats = table.stats();
+        printf("    probes %lld, hits %.1f%%, collisions %.1f%%, stores %lld, replacements %lld, probe %.1f ns\n",
+               stats.m_probes, 100 * stats.hitRate(), 100 * stats.collisionRate(),
+               stats.m_stores, stats.m_replacements, stats.m_probeNs);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int count = (argc > 1) ? atoi(argv[1]) : 20;
+    int depth = (argc > 2) ? atoi(argv[2]) : 2;
+    int threads = (argc > 3) ? atoi(argv[3]) : int(std::thread::hardware_concurrency());
+    size_t megabytes = (argc > 4) ? size_t(atoi(argv[4])) : 64;
+    uint64_t seed = (argc > 5) ? strtoull(argv[5], 0, 10) : 1;
+
+    if (threads <= 0) {
+        threads = 1;
+    }
+
+    std::vector<Board> positions;
+    collectPositions(positions, count, seed);
+
+    TranspositionTable table(megabytes);
+    printf("table: %zu entries\n", table.capacity());
+
+    long long nodes = 0;
+    double plain = searchAll(positions, depth, 0, nodes);
+    printf("expectimax depth %d, no table : %7.2f s, %lld evaluations\n", depth, plain, nodes);
+
+    double cached = searchAll(positions, depth, &table, nodes);
+    printf("expectimax depth %d, table    : %7.2f s, %lld evaluations (x%.2f)\n", depth, cached, nodes, plain / cached);
+    printStats(table);
+
+    table.clear();
+    long long operations = 4000000;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(stress, std::ref(table), i, operations / threads));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("stress, %d threads : %.1f M probes/s\n", threads, double(operations) / seconds * 1e-6);
+    printStats(table);
+
+    return 0;
+}
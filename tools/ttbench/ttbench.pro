@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Hit rate and latency of the transposition table.
+# -------------------------------------------------
+TARGET = ttbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += ttbench.cpp
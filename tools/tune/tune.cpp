@@ -0,0 +1,68 @@
+/*!
+  * @file tune.cpp
+  * Tunes the weights of the evaluation heuristic by self-play; the state is saved to the
+  * checkpoint file after every iteration and the tuning resumes from it when it exists.
+  * At the end the tuned weights and the default ones play the same validation games.
+  *
+  * usage: tune <checkpoint> [iterations] [games] [threads] [seed]
+  */
+
+#include <cstdio>
+#include <cstdlib>
+#include "tuner.hpp"
+
+namespace
+{
+    void printWeights(const EvalWeights &weights)
+    {
+        printf("line");
+        for (int i = 0; i < Board::LineLength; ++i) {
+            printf(" %d", weights.m_line[i]);
+        }
+        printf(", reach %d, free %d", weights.m_reach, weights.m_free);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: tune <checkpoint> [iterations] [games] [threads] [seed]\n");
+        return 2;
+    }
+
+    const char *checkpoint = argv[1];
+    int iterations = (argc > 2) ? atoi(argv[2]) : 50;
+    int games = (argc > 3) ? atoi(argv[3]) : 200;
+
+    Tuner tuner;
+    tuner.setGames(games);
+    tuner.setThreads((argc > 4) ? atoi(argv[4]) : 0);
+    tuner.setSeed((argc > 5) ? strtoull(argv[5], 0, 10) : 1);
+
+    if (tuner.load(checkpoint)) {
+        printf("resuming from %s at iteration %d\n", checkpoint, tuner.iteration());
+    }
+
+    while (tuner.iteration() < iterations) {
+        tuner.step();
+
+        printf("%4d: %8.1f / %8.1f  ", tuner.iteration(), tuner.lastScore(0), tuner.lastScore(1));
+        printWeights(tuner.weights());
+        printf("  (%.2f M turns/min)\n", tuner.turnsPerMinute() * 1e-6);
+        fflush(stdout);
+
+        if (!tuner.save(checkpoint)) {
+            fprintf(stderr, "cannot write the checkpoint %s\n", checkpoint);
+            return 2;
+        }
+    }
+
+    // the validation games are not among the tuning games
+    const uint64_t validation = 1000000007ULL;
+    double tuned = tuner.play(tuner.weights(), validation, games);
+    double defaults = tuner.play(EvalWeights(), validation, games);
+
+    printf("validation over %d games: tuned %.1f, default %.1f\n", games, tuned, defaults);
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Self-play tuning of the weights of the evaluation heuristic.
+# -------------------------------------------------
+TARGET = tune
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += tune.cpp
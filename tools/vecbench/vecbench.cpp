@@ -0,0 +1,86 @@
+/*!
+  * @file vecbench.cpp
+  * Measures the throughput of VecEnv: steps a batch of games with random actions (a random
+  * movable ball onto a random reachable cell, so that some of them are illegal) and reports the
+  * environment steps per second. Only the time of VecEnv::step() is counted.
+  *
+  * usage: vecbench [envs] [steps] [threads] [dimension] [seed]
+  */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "vecenv.hpp"
+
+namespace
+{
+    // Picks a random cell whose value is set in a plane (-1 if there is none).
+    int randomCell(const unsigned char *plane, int cells, Random &rng)
+    {
+        int start = rng.below(cells);
+        for (int i = 0; i < cells; ++i) {
+            int cell = (start + i) % cells;
+            if (plane[cell]) {
+                return cell;
+            }
+        }
+
+        return -1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int envs = (argc > 1) ? atoi(argv[1]) : 4096;
+    int steps = (argc > 2) ? atoi(argv[2]) : 200;
+    int threads = (argc > 3) ? atoi(argv[3]) : 0;
+    int dimension = (argc > 4) ? atoi(argv[4]) : 9;
+    uint64_t seed = (argc > 5) ? strtoull(argv[5], 0, 10) : 1;
+
+    VecEnv env(envs, dimension, seed);
+    env.setThreads(threads);
+
+    int cells = env.cells();
+    int size = env.observationSize();
+
+    std::vector<unsigned char> observations(size_t(envs) * size);
+    std::vector<float> rewards(envs);
+    std::vector<unsigned char> flags(envs);
+    std::vector<int> actions(envs);
+
+    env.reset(&observations[0]);
+
+    Random rng(seed);
+    double seconds = 0;
+    long long illegal = 0;
+    long long games = 0;
+    double points = 0;
+
+    for (int s = 0; s < steps; ++s) {
+        for (int i = 0; i < envs; ++i) {
+            const unsigned char *observation = &observations[size_t(i) * size];
+            int from = randomCell(observation + VecEnv::MovablePlane * cells, cells, rng);
+            int to = randomCell(observation + VecEnv::ReachablePlane * cells, cells, rng);
+            actions[i] = (from < 0 || to < 0) ? 0 : from * cells + to;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        env.step(&actions[0], &observations[0], &rewards[0], &flags[0]);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (int i = 0; i < envs; ++i) {
+            illegal += (flags[i] & VecEnv::Illegal) ? 1 : 0;
+            games += (flags[i] & VecEnv::Done) ? 1 : 0;
+            points += rewards[i];
+        }
+    }
+
+    double total = double(envs) * steps;
+    printf("%d envs, %d steps, %dx%d: %.2f M env-steps/s (%.0f ns per step)\n",
+           envs, steps, env.dim(), env.dim(), total / seconds * 1e-6, seconds / total * 1e9);
+    printf("illegal actions %.1f%%, finished games %lld, mean reward %.2f\n",
+           100.0 * illegal / total, games, points / total);
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+# -------------------------------------------------
+# Throughput of the batched environments.
+# -------------------------------------------------
+TARGET = vecbench
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle qt
+
+include(../../engine.pri)
+
+SOURCES += vecbench.cpp
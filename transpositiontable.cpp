@@ -0,0 +1,243 @@
+/*!
+  * @file transpositiontable.cpp
+  * This file contains the definition of the class TranspositionTable.
+  */
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <string.h>
+#include "transpositiontable.hpp"
+
+namespace
+{
+    // the layout of the data of an entry
+    const int s_moveShift = 32;
+    const int s_depthShift = 48;
+    const int s_generationShift = 56;
+
+    // the stripe of the counters of the calling thread
+    thread_local int t_stripe = -1;
+    std::atomic<int> s_nextStripe(0);
+
+    // the number of the probes of the calling thread (one out of SamplePeriod is timed)
+    thread_local unsigned t_probes = 0;
+}
+
+//!
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : m_buckets(0),
+    m_bucketCount(0),
+    m_mask(0),
+    m_generation(0),
+    m_clockNs(0)
+{
+    // the cost of reading the clock is subtracted from the timed probes
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 64; ++i) {
+        std::chrono::steady_clock::now();
+    }
+    m_clockNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / 65;
+
+    resize(megabytes);
+}
+
+/*!
+  * The number of the buckets is rounded down to a power of 2, so a bucket is picked
+  * by masking the key.
+  */
+void TranspositionTable::resize(size_t megabytes)
+{
+    size_t buckets = 1;
+    while (buckets * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) {
+        buckets *= 2;
+    }
+
+    m_memory.reset(new char[buckets * sizeof(Bucket) + CacheLine]);
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(m_memory.get());
+    address = (address + CacheLine - 1) & ~uintptr_t(CacheLine - 1);
+
+    m_buckets = reinterpret_cast<Bucket*>(address);
+    m_bucketCount = buckets;
+    m_mask = buckets - 1;
+
+    for (size_t i = 0; i < buckets; ++i) {
+        new (&m_buckets[i]) Bucket();
+    }
+
+    clear();
+}
+
+//!
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < m_bucketCount; ++i) {
+        for (int k = 0; k < BucketSize; ++k) {
+            m_buckets[i].m_slots[k].m_check.store(0, std::memory_order_relaxed);
+            m_buckets[i].m_slots[k].m_data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    m_generation = 0;
+    resetStats();
+}
+
+//!
+bool TranspositionTable::probe(uint64_t key, Entry &entry)
+{
+    Counters &c = counters();
+    bool timed = (0 == (++t_probes % SamplePeriod));
+    std::chrono::steady_clock::time_point start;
+    if (timed) {
+        start = std::chrono::steady_clock::now();
+    }
+
+    Bucket &bucket = m_buckets[key & m_mask];
+    bool found = false;
+    bool occupied = false;
+
+    for (int k = 0; k < BucketSize; ++k) {
+        uint64_t data = bucket.m_slots[k].m_data.load(std::memory_order_relaxed);
+        uint64_t check = bucket.m_slots[k].m_check.load(std::memory_order_relaxed);
+
+        if (0 == data) {
+            continue;
+        }
+
+        if ((check ^ data) != key) {
+            occupied = true;
+            continue;
+        }
+
+        uint32_t bits = uint32_t(data);
+        memcpy(&entry.m_value, &bits, sizeof(float));
+        entry.m_move = Board::Move(int((data >> (s_moveShift + 8)) & 0xFF), int((data >> s_moveShift) & 0xFF));
+        entry.m_depth = int((data >> s_depthShift) & 0xFF) - 1;
+        found = true;
+        break;
+    }
+
+    c.m_probes.fetch_add(1, std::memory_order_relaxed);
+    if (found) {
+        c.m_hits.fetch_add(1, std::memory_order_relaxed);
+    } else if (occupied) {
+        c.m_collisions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (timed) {
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        c.m_sampledNs.fetch_add(ns, std::memory_order_relaxed);
+        c.m_samples.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return found;
+}
+
+/*!
+  * The entry of the same key is overwritten, otherwise an empty entry is taken, otherwise the
+  * entry having the lowest depth (minus a penalty for every search it is older than the
+  * current one) is replaced.
+  */
+void TranspositionTable::store(uint64_t key, float value, int depth, const Board::Move &move)
+{
+    Counters &c = counters();
+    c.m_stores.fetch_add(1, std::memory_order_relaxed);
+
+    Bucket &bucket = m_buckets[key & m_mask];
+    int victim = 0;
+    int victimScore = 0x7FFFFFFF;
+
+    for (int k = 0; k < BucketSize; ++k) {
+        uint64_t data = bucket.m_slots[k].m_data.load(std::memory_order_relaxed);
+        uint64_t check = bucket.m_slots[k].m_check.load(std::memory_order_relaxed);
+
+        if ((0 == data) || ((check ^ data) == key)) {
+            victim = k;
+            victimScore = -1;
+            break;
+        }
+
+        int age = int((m_generation - unsigned(data >> s_generationShift)) & 0xFF);
+        int score = int((data >> s_depthShift) & 0xFF) - 8 * age;
+        if (score < victimScore) {
+            victim = k;
+            victimScore = score;
+        }
+    }
+
+    if (victimScore >= 0) {
+        c.m_replacements.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t data = pack(value, depth, move, m_generation);
+    bucket.m_slots[victim].m_data.store(data, std::memory_order_relaxed);
+    bucket.m_slots[victim].m_check.store(key ^ data, std::memory_order_relaxed);
+}
+
+//!
+TranspositionTable::Stats TranspositionTable::stats() const
+{
+    Stats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    long long sampledNs = 0;
+    long long samples = 0;
+    for (int i = 0; i < Stripes; ++i) {
+        stats.m_probes += m_counters[i].m_probes.load(std::memory_order_relaxed);
+        stats.m_hits += m_counters[i].m_hits.load(std::memory_order_relaxed);
+        stats.m_collisions += m_counters[i].m_collisions.load(std::memory_order_relaxed);
+        stats.m_stores += m_counters[i].m_stores.load(std::memory_order_relaxed);
+        stats.m_replacements += m_counters[i].m_replacements.load(std::memory_order_relaxed);
+        sampledNs += m_counters[i].m_sampledNs.load(std::memory_order_relaxed);
+        samples += m_counters[i].m_samples.load(std::memory_order_relaxed);
+    }
+
+    stats.m_probeNs = (samples > 0) ? std::max(0.0, double(sampledNs) / double(samples) - m_clockNs) : 0;
+
+    return stats;
+}
+
+//!
+void TranspositionTable::resetStats()
+{
+    for (int i = 0; i < Stripes; ++i) {
+        m_counters[i].m_probes = 0;
+        m_counters[i].m_hits = 0;
+        m_counters[i].m_collisions = 0;
+        m_counters[i].m_stores = 0;
+        m_counters[i].m_replacements = 0;
+        m_counters[i].m_sampledNs = 0;
+        m_counters[i].m_samples = 0;
+    }
+}
+
+/*!
+  * The depth is stored + 1, so the data of a used entry is never 0.
+  */
+uint64_t TranspositionTable::pack(float value, int depth, const Board::Move &move, unsigned generation)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+
+    if (depth < 0) {
+        depth = 0;
+    } else if (depth > 254) {
+        depth = 254;
+    }
+
+    return uint64_t(bits) |
+           (uint64_t((move.m_from << 8) | move.m_to) << s_moveShift) |
+           (uint64_t(depth + 1) << s_depthShift) |
+           (uint64_t(generation & 0xFF) << s_generationShift);
+}
+
+//!
+TranspositionTable::Counters &TranspositionTable::counters()
+{
+    if (t_stripe < 0) {
+        t_stripe = s_nextStripe.fetch_add(1, std::memory_order_relaxed) % Stripes;
+    }
+
+    return m_counters[t_stripe];
+}
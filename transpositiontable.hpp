@@ -0,0 +1,183 @@
+/*!
+  * @file transpositiontable.hpp
+  * This file contains the declaration of the class TranspositionTable.
+  */
+#ifndef TRANSPOSITIONTABLE_HPP
+#define TRANSPOSITIONTABLE_HPP
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include "board.hpp"
+
+/*! This class implements a fixed size hash table of the values of the positions, shared without
+  * locks by the threads of a search.
+  *
+  * The table is keyed by a 64 bits hash of the position (see Board::hash()). The entries are grouped
+  * by four in buckets of one cache line. An entry is made of two 64 bits words: the data (the value,
+  * the depth it was computed at, the best move and the generation of the search) and the key
+  * xor-ed with the data. A reader checks the key against the two words, so an entry torn by two
+  * concurrent writers is seen as a miss instead of a wrong value; no lock is ever taken.
+  *
+  * When a bucket is full the entry to be replaced is the shallowest one, entries of the previous
+  * searches (see newSearch()) being replaced first. The table counts its probes, hits, collisions
+  * (probes missing a key while the bucket holds other keys) and replacements and samples the
+  * latency of the probes; the counters are striped over several cache lines, so the threads do
+  * not contend on them.
+  */
+class TranspositionTable
+{
+public:
+    /*! \brief The content of an entry.
+      */
+    struct Entry
+    {
+        float m_value; /*!< the value of the position */
+        int m_depth; /*!< the depth the value was computed at */
+        Board::Move m_move; /*!< the best move (if any) */
+    };
+
+    /*! \brief The statistics of a table.
+      */
+    struct Stats
+    {
+        long long m_probes; /*!< the number of the probes */
+        long long m_hits; /*!< the number of the probes that found their key */
+        long long m_collisions; /*!< the number of the missed probes whose bucket held other keys */
+        long long m_stores; /*!< the number of the stores */
+        long long m_replacements; /*!< the number of the stores that evicted another key */
+        double m_probeNs; /*!< the mean latency of a probe in nanoseconds (sampled, without the reading of the clock) */
+
+        inline double hitRate() const
+        {
+            return (m_probes > 0) ? double(m_hits) / double(m_probes) : 0;
+        }
+
+        inline double collisionRate() const
+        {
+            return (m_probes > 0) ? double(m_collisions) / double(m_probes) : 0;
+        }
+    };
+
+    /*! The constructor.
+      * @param[in] megabytes the size of the table
+      */
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    /*! Reallocates the table; all the entries are lost.
+      * @param[in] megabytes the size of the table
+      */
+    void resize(size_t megabytes);
+
+    /*! Removes all the entries and resets the statistics; not to be called during a search.
+      */
+    void clear();
+
+    /*!
+      * @return the number of the entries of the table
+      */
+    inline size_t capacity() const
+    {
+        return m_bucketCount * BucketSize;
+    }
+
+    /*! Starts a new search: the entries stored so far are replaced first.
+      */
+    inline void newSearch()
+    {
+        m_generation = (m_generation + 1) & 0xFF;
+    }
+
+    /*! Loads the bucket of a key into the cache ahead of probe() or store().
+      */
+    inline void prefetch(uint64_t key) const
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(&m_buckets[key & m_mask]);
+#else
+        (void)key;
+#endif
+    }
+
+    /*! Looks up a position.
+      *
+      * @param[in] key the hash of the position
+      * @param[out] entry receives the entry if the key was found
+      * @return true if the key was found
+      */
+    bool probe(uint64_t key, Entry &entry);
+
+    /*! Stores the value of a position.
+      *
+      * @param[in] key the hash of the position
+      * @param[in] value the value
+      * @param[in] depth the depth the value was computed at (0 to 254)
+      * @param[in] move the best move (or a default move)
+      */
+    void store(uint64_t key, float value, int depth, const Board::Move &move = Board::Move());
+
+    /*!
+      * @return the statistics gathered since the last clear() or resetStats()
+      */
+    Stats stats() const;
+
+    /*! Resets the statistics.
+      */
+    void resetStats();
+
+private:
+    enum
+    {
+        BucketSize = 4,     // the number of the entries of a bucket
+        CacheLine = 64,
+        Stripes = 16,       // the number of the stripes of the counters
+        SamplePeriod = 256  // one probe out of SamplePeriod is timed
+    };
+
+    /*! \brief An entry: the data and the key xor-ed with the data (both 0 if the entry is empty).
+      */
+    struct Slot
+    {
+        std::atomic<uint64_t> m_check;
+        std::atomic<uint64_t> m_data;
+    };
+
+    /*! \brief A bucket: the entries sharing a cache line.
+      */
+    struct alignas(64) Bucket
+    {
+        Slot m_slots[BucketSize];
+    };
+
+    /*! \brief The counters of the statistics of the threads of one stripe.
+      */
+    struct alignas(64) Counters
+    {
+        std::atomic<long long> m_probes;
+        std::atomic<long long> m_hits;
+        std::atomic<long long> m_collisions;
+        std::atomic<long long> m_stores;
+        std::atomic<long long> m_replacements;
+        std::atomic<long long> m_sampledNs;
+        std::atomic<long long> m_samples;
+    };
+
+    static uint64_t pack(float value, int depth, const Board::Move &move, unsigned generation);
+
+    /*!
+      * @return the counters of the calling thread
+      */
+    Counters &counters();
+
+private:
+    std::unique_ptr<char[]> m_memory; /*!< the memory of the buckets (not aligned) */
+    Bucket *m_buckets; /*!< the buckets, aligned on a cache line */
+    size_t m_bucketCount; /*!< the number of the buckets (a power of 2) */
+    uint64_t m_mask; /*!< m_bucketCount - 1 */
+    unsigned m_generation; /*!< the generation of the current search */
+    double m_clockNs; /*!< the time needed to read the clock, in nanoseconds */
+
+    Counters m_counters[Stripes]; /*!< the striped counters of the statistics */
+};
+
+#endif // TRANSPOSITIONTABLE_HPP
@@ -0,0 +1,279 @@
+/*!
+  * @file tuner.cpp
+  * This file contains the definition of the class Tuner.
+  */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include "tuner.hpp"
+
+namespace
+{
+    // the usual SPSA decay of the gains and the stability constant of the steps
+    const double s_stepDecay = 0.602;
+    const double s_perturbationDecay = 0.101;
+    const double s_stability = 10;
+
+    // the range of a parameter: log(1 + weight) for a weight in [0, MaxWeight]
+    const double s_maxParameter = std::log(1.0 + EvalWeights::MaxWeight);
+}
+
+//!
+Tuner::Tuner()
+    : m_games(200),
+    m_threads(1),
+    m_candidates(8),
+    m_maxTurns(2000),
+    m_seed(1),
+    m_stepSize(0.1),
+    m_perturbation(0.2),
+    m_gain(0),
+    m_iteration(0),
+    m_nextGame(0),
+    m_turns(0),
+    m_turnsPerMinute(0)
+{
+    EvalWeights defaults;
+    for (int i = 0; i < Board::LineLength; ++i) {
+        m_parameters[i] = std::log(1.0 + std::max<int>(0, defaults.m_line[i]));
+    }
+
+    m_parameters[Board::LineLength] = std::log(1.0 + std::max<int>(0, defaults.m_reach));
+    m_parameters[Board::LineLength + 1] = std::log(1.0 + std::max<int>(0, defaults.m_free));
+
+    m_lastScores[0] = m_lastScores[1] = 0;
+
+    setThreads(0);
+}
+
+//!
+void Tuner::setThreads(int threads)
+{
+    if (threads <= 0) {
+        threads = int(std::thread::hardware_concurrency());
+    }
+
+    m_threads = (threads > 0) ? threads : 1;
+}
+
+/*!
+  * The first iteration calibrates the gain, so that its step moves the parameters by
+  * \a m_stepSize on average.
+  */
+void Tuner::step()
+{
+    int k = m_iteration;
+    double perturbation = m_perturbation / std::pow(k + 1.0, s_perturbationDecay);
+
+    Random rng(Random::mix(m_seed ^ (uint64_t(k) << 32)));
+    double delta[Parameters];
+    double plus[Parameters];
+    double minus[Parameters];
+    for (int i = 0; i < Parameters; ++i) {
+        delta[i] = (rng.next() & 1) ? 1.0 : -1.0;
+        plus[i] = std::min(s_maxParameter, std::max(0.0, m_parameters[i] + perturbation * delta[i]));
+        minus[i] = std::min(s_maxParameter, std::max(0.0, m_parameters[i] - perturbation * delta[i]));
+    }
+
+    // both candidates play the same games
+    EvalWeights candidates[2] = { toWeights(plus), toWeights(minus) };
+    uint64_t seed = m_seed + uint64_t(k) * uint64_t(m_games);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    m_scores.assign(size_t(2) * m_games, 0);
+    m_nextGame = 0;
+    m_turns = 0;
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < m_threads; ++i) {
+        workers.push_back(std::thread(&Tuner::work, this, candidates, 2, seed, m_games));
+    }
+
+    work(candidates, 2, seed, m_games);
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+
+    double minutes = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 60;
+    m_turnsPerMinute = (minutes > 0) ? double(m_turns) / minutes : 0;
+
+    for (int c = 0; c < 2; ++c) {
+        long long sum = 0;
+        for (int g = 0; g < m_games; ++g) {
+            sum += m_scores[size_t(c) * m_games + g];
+        }
+        m_lastScores[c] = double(sum) / m_games;
+    }
+
+    double gradient[Parameters];
+    double magnitude = 0;
+    for (int i = 0; i < Parameters; ++i) {
+        gradient[i] = (m_lastScores[0] - m_lastScores[1]) / (2 * perturbation * delta[i]);
+        magnitude += std::fabs(gradient[i]) / Parameters;
+    }
+
+    if ((0 == m_gain) && (magnitude > 0)) {
+        m_gain = m_stepSize * std::pow(s_stability + 1, s_stepDecay) / magnitude;
+    }
+
+    double gain = m_gain / std::pow(k + 1 + s_stability, s_stepDecay);
+    for (int i = 0; i < Parameters; ++i) {
+        m_parameters[i] = std::min(s_maxParameter, std::max(0.0, m_parameters[i] + gain * gradient[i]));
+    }
+
+    ++m_iteration;
+}
+
+//!
+double Tuner::play(const EvalWeights &weights, uint64_t seed, int games)
+{
+    m_scores.assign(games, 0);
+    m_nextGame = 0;
+    m_turns = 0;
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < m_threads; ++i) {
+        workers.push_back(std::thread(&Tuner::work, this, &weights, 1, seed, games));
+    }
+
+    work(&weights, 1, seed, games);
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+
+    long long sum = 0;
+    for (int g = 0; g < games; ++g) {
+        sum += m_scores[g];
+    }
+
+    return double(sum) / games;
+}
+
+//!
+EvalWeights Tuner::weights() const
+{
+    return toWeights(m_parameters);
+}
+
+//!
+bool Tuner::save(const std::string &path) const
+{
+    std::string temporary = path + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+
+    fprintf(file, "lines-tuner 1\niteration %d\nseed %llu\ngain %.17g\nparameters",
+            m_iteration, (unsigned long long)m_seed, m_gain);
+    for (int i = 0; i < Parameters; ++i) {
+        fprintf(file, " %.17g", m_parameters[i]);
+    }
+    fprintf(file, "\n");
+
+    if (0 != fclose(file)) {
+        return false;
+    }
+
+    return 0 == std::rename(temporary.c_str(), path.c_str());
+}
+
+//!
+bool Tuner::load(const std::string &path)
+{
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+
+    int version = 0;
+    int iteration = 0;
+    unsigned long long seed = 0;
+    double gain = 0;
+    double parameters[Parameters];
+
+    bool ok = (4 == fscanf(file, "lines-tuner %d iteration %d seed %llu gain %lg parameters",
+                           &version, &iteration, &seed, &gain)) && (1 == version);
+    for (int i = 0; ok && (i < Parameters); ++i) {
+        ok = (1 == fscanf(file, "%lg", &parameters[i]));
+    }
+
+    fclose(file);
+
+    if (ok) {
+        m_iteration = iteration;
+        m_seed = seed;
+        m_gain = gain;
+        std::copy(parameters, parameters + Parameters, m_parameters);
+    }
+
+    return ok;
+}
+
+//!
+EvalWeights Tuner::toWeights(const double *parameters)
+{
+    EvalWeights weights;
+    for (int i = 0; i < Board::LineLength; ++i) {
+        weights.m_line[i] = short(std::floor(std::exp(parameters[i]) - 1 + 0.5));
+    }
+
+    weights.m_reach = short(std::floor(std::exp(parameters[Board::LineLength]) - 1 + 0.5));
+    weights.m_free = short(std::floor(std::exp(parameters[Board::LineLength + 1]) - 1 + 0.5));
+
+    return weights;
+}
+
+/*!
+  * The games are numbered candidate by candidate; the game g of every candidate is played
+  * with the seed 'seed + g'.
+  */
+void Tuner::work(const EvalWeights *candidates, int count, uint64_t seed, int games)
+{
+    Evaluator evaluator;
+    int current = -1;
+    long long turns = 0;
+
+    while (true) {
+        int game = m_nextGame.fetch_add(1, std::memory_order_relaxed);
+        if (game >= count * games) {
+            break;
+        }
+
+        int candidate = game / games;
+        if (candidate != current) {
+            evaluator.setWeights(candidates[candidate]);
+            current = candidate;
+        }
+
+        m_scores[game] = playGame(evaluator, seed + uint64_t(game % games), turns);
+    }
+
+    m_turns += turns;
+}
+
+//!
+int Tuner::playGame(Evaluator &evaluator, uint64_t seed, long long &turns)
+{
+    Random rng(seed);
+    Board board;
+    board.spawn(rng, true);
+
+    for (int turn = 0; (turn < m_maxTurns) && !board.isGameOver(); ++turn) {
+        Board::Move move;
+        if (!evaluator.suggestMove(board, move, m_candidates)) {
+            break;
+        }
+
+        board.play(move, rng);
+        ++turns;
+    }
+
+    return board.score();
+}
@@ -0,0 +1,172 @@
+/*!
+  * @file tuner.hpp
+  * This file contains the declaration of the class Tuner.
+  */
+#ifndef TUNER_HPP
+#define TUNER_HPP
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "board.hpp"
+#include "evaluator.hpp"
+
+/*! This class tunes the weights of the evaluation heuristic by self-play (SPSA: simultaneous
+  * perturbation stochastic approximation).
+  *
+  * Every iteration perturbs all the weights at once by a random +/- step, plays a batch of headless
+  * games with the two perturbed weight vectors and moves the weights along the estimated gradient
+  * of the mean score. Both candidates play the same seeded games (common random numbers), so the
+  * difference of their scores does not depend on the luck of the spawns. The games are played by the
+  * greedy bot of Evaluator::suggestMove() on all the cores. The weights are tuned in a logarithmic
+  * scale (the line weights span several orders of magnitude).
+  *
+  * The state of the tuner can be saved to a checkpoint file after every iteration and loaded again
+  * to resume the tuning.
+  */
+class Tuner
+{
+public:
+    enum
+    {
+        Parameters = Board::LineLength + 2 // the line weights (0 to 4 balls), the reach and the free weights
+    };
+
+    /*! The constructor; starts from the default weights.
+      */
+    Tuner();
+
+    /*! Sets the number of the games played by each candidate per iteration.
+      */
+    inline void setGames(int games)
+    {
+        m_games = (games > 0) ? games : 1;
+    }
+
+    /*! Sets the number of the threads playing the games (0 means one thread per core).
+      */
+    void setThreads(int threads);
+
+    /*! Sets the number of the moves evaluated by the bot per turn (see Evaluator::suggestMove()).
+      */
+    inline void setCandidates(int candidates)
+    {
+        m_candidates = (candidates > 0) ? candidates : 0;
+    }
+
+    /*! Sets the maximum number of the turns of a game.
+      */
+    inline void setMaxTurns(int turns)
+    {
+        m_maxTurns = (turns > 0) ? turns : 1;
+    }
+
+    /*! Sets the seed of the first game; the games of the iteration k start at seed + k * games.
+      */
+    inline void setSeed(uint64_t seed)
+    {
+        m_seed = seed;
+    }
+
+    /*! Sets the size of the first step of the weights (in the logarithmic scale).
+      */
+    inline void setStepSize(double step)
+    {
+        m_stepSize = step;
+    }
+
+    /*! Sets the size of the first perturbation of the weights (in the logarithmic scale).
+      */
+    inline void setPerturbation(double perturbation)
+    {
+        m_perturbation = perturbation;
+    }
+
+    /*! Runs one iteration: plays the games of the two perturbed candidates and updates the weights.
+      */
+    void step();
+
+    /*! Plays a batch of seeded games with the given weights.
+      *
+      * @param[in] weights the weights of the bot
+      * @param[in] seed the seed of the first game
+      * @param[in] games the number of the games
+      * @return the mean score
+      */
+    double play(const EvalWeights &weights, uint64_t seed, int games);
+
+    /*!
+      * @return the number of the completed iterations
+      */
+    inline int iteration() const
+    {
+        return m_iteration;
+    }
+
+    /*!
+      * @return the current weights
+      */
+    EvalWeights weights() const;
+
+    /*!
+      * @return the mean scores of the two candidates of the last iteration
+      */
+    inline double lastScore(int candidate) const
+    {
+        return m_lastScores[candidate];
+    }
+
+    /*!
+      * @return the number of the turns played per minute during the last iteration
+      */
+    inline double turnsPerMinute() const
+    {
+        return m_turnsPerMinute;
+    }
+
+    /*! Saves the state of the tuner (written to a temporary file first, then renamed).
+      * @return false if the file cannot be written
+      */
+    bool save(const std::string &path) const;
+
+    /*! Loads the state of the tuner.
+      * @return false if the file cannot be read
+      */
+    bool load(const std::string &path);
+
+private:
+    /*! Converts the parameters (logarithmic scale) into weights.
+      */
+    static EvalWeights toWeights(const double *parameters);
+
+    /*! The loop of a thread: plays the games of the batch until all of them were played.
+      */
+    void work(const EvalWeights *candidates, int count, uint64_t seed, int games);
+
+    /*! Plays one game.
+      * @return the final score
+      */
+    int playGame(Evaluator &evaluator, uint64_t seed, long long &turns);
+
+private:
+    int m_games; /*!< the number of the games per candidate and iteration */
+    int m_threads; /*!< the number of the threads */
+    int m_candidates; /*!< the moves evaluated by the bot per turn */
+    int m_maxTurns; /*!< the maximum number of turns of a game */
+    uint64_t m_seed; /*!< the seed of the first game */
+    double m_stepSize; /*!< the size of the first step */
+    double m_perturbation; /*!< the size of the first perturbation */
+
+    double m_parameters[Parameters]; /*!< the current weights, in the logarithmic scale */
+    double m_gain; /*!< the gain of the steps (calibrated by the first iteration) */
+    int m_iteration; /*!< the number of the completed iterations */
+
+    std::vector<long long> m_scores; /*!< the scores of the games of a batch */
+    std::atomic<int> m_nextGame; /*!< the next game of a batch (shared by the threads) */
+    std::atomic<long long> m_turns; /*!< the turns played by the batch */
+
+    double m_lastScores[2]; /*!< the mean scores of the candidates of the last iteration */
+    double m_turnsPerMinute; /*!< the speed of the last iteration */
+};
+
+#endif // TUNER_HPP
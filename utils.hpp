@@ -4,4 +4,10 @@
 //!
 bool isRunningOnDesktop();
 
+//! the balls are painted by the grid item (see GridItem::BatchedRendering); set by the -batched option
+bool useBatchedRendering();
+
+//! the dimension of the grid: 9 in the game; the render benchmark sets larger ones
+int boardDimension();
+
 #endif // UTILS_HPP
@@ -0,0 +1,346 @@
+/*!
+  * @file vecenv.cpp
+  * This file contains the definition of the class VecEnv.
+  */
+
+#include <algorithm>
+#include <string.h>
+#include "vecenv.hpp"
+#include "bitrows.hpp"
+
+namespace
+{
+    // writes the bits of the rows into a plane of bytes
+    void writePlane(const uint16_t *set, int n, unsigned char *plane)
+    {
+        for (int r = 0; r < n; ++r) {
+            for (uint16_t bits = set[r]; bits; bits = uint16_t(bits & (bits - 1))) {
+                plane[r * n + __builtin_ctz(bits)] = 1;
+            }
+        }
+    }
+}
+
+//!
+VecEnv::VecEnv(int envs, int dimension, uint64_t seed)
+    : m_envs((envs > 0) ? envs : 1),
+    m_dimension(Board(dimension).dim()),
+    m_cells(m_dimension * m_dimension),
+    m_autoReset(true),
+    m_boardCells(size_t(m_envs) * m_cells, Board::Empty),
+    m_hintCells(size_t(m_envs) * Board::HintCount, 0),
+    m_hintColors(size_t(m_envs) * Board::HintCount, Board::Empty),
+    m_hintCounts(m_envs, 0),
+    m_scores(m_envs, 0),
+    m_rngStates(m_envs, 1),
+    m_seeds(m_envs, 0),
+    m_threads(1),
+    m_generation(0),
+    m_pending(0),
+    m_quit(false)
+{
+    for (int i = 0; i < m_envs; ++i) {
+        m_seeds[i] = seed + uint64_t(i);
+    }
+
+    m_batch.m_actions = 0;
+    m_batch.m_observations = 0;
+    m_batch.m_rewards = 0;
+    m_batch.m_flags = 0;
+
+    setThreads(0);
+}
+
+//!
+VecEnv::~VecEnv()
+{
+    stopWorkers();
+}
+
+//!
+void VecEnv::setThreads(int threads)
+{
+    stopWorkers();
+
+    if (threads <= 0) {
+        threads = int(std::thread::hardware_concurrency());
+    }
+
+    m_threads = std::max(1, std::min(threads, m_envs));
+}
+
+//!
+void VecEnv::reset(unsigned char *observations)
+{
+    Batch batch = { 0, observations, 0, 0 };
+    run(batch);
+}
+
+//!
+void VecEnv::step(const int *actions, unsigned char *observations, float *rewards, unsigned char *flags)
+{
+    Batch batch = { actions, observations, rewards, flags };
+    run(batch);
+}
+
+//!
+void VecEnv::toBoard(int env, Board &board) const
+{
+    board = Board(m_dimension);
+
+    const Board::Cell *cells = &m_boardCells[size_t(env) * m_cells];
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            Board::Cell color = cells[r * m_dimension + c];
+            if (color != Board::Empty) {
+                board.setCell(Board::index(r, c), color);
+            }
+        }
+    }
+
+    for (int i = 0; i < m_hintCounts[env]; ++i) {
+        int cell = m_hintCells[size_t(env) * Board::HintCount + i];
+        board.addHint(Board::index(cell / m_dimension, cell % m_dimension),
+                      m_hintColors[size_t(env) * Board::HintCount + i]);
+    }
+
+    board.setScore(m_scores[env]);
+}
+
+/*!
+  * The calling thread steps the first slice of the games while the workers step the others.
+  * The workers are started by the first batch and wait for the next ones on a condition variable.
+  */
+void VecEnv::run(const Batch &batch)
+{
+    if (1 == m_threads) {
+        stepRange(0, m_envs, batch);
+        return;
+    }
+
+    if (m_workers.empty()) {
+        m_quit = false;
+        for (int i = 1; i < m_threads; ++i) {
+            m_workers.push_back(std::thread(&VecEnv::work, this, i));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_batch = batch;
+        m_pending = int(m_workers.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    stepRange(0, m_envs / m_threads, batch);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] { return 0 == m_pending; });
+}
+
+//!
+void VecEnv::work(int thread)
+{
+    unsigned long long generation = 0;
+
+    while (true) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, generation] { return m_quit || (m_generation != generation); });
+            if (m_quit) {
+                return;
+            }
+
+            generation = m_generation;
+            batch = m_batch;
+        }
+
+        stepRange(int(int64_t(m_envs) * thread / m_threads), int(int64_t(m_envs) * (thread + 1) / m_threads), batch);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (0 == --m_pending) {
+            m_finished.notify_one();
+        }
+    }
+}
+
+//!
+void VecEnv::stopWorkers()
+{
+    if (m_workers.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i].join();
+    }
+
+    m_workers.clear();
+}
+
+//!
+void VecEnv::stepRange(int first, int last, const Batch &batch)
+{
+    Board board(m_dimension);
+    size_t size = size_t(observationSize());
+
+    for (int env = first; env < last; ++env) {
+        unsigned char *observation = batch.m_observations + size * env;
+
+        if (!batch.m_actions) {
+            resetEnv(env, board);
+            observe(board, observation);
+            fromBoard(env, board);
+            continue;
+        }
+
+        toBoard(env, board);
+
+        int action = batch.m_actions[env];
+        int from = action / m_cells;
+        int to = action % m_cells;
+
+        unsigned char flags = 0;
+        float reward = 0;
+
+        if ((action >= 0) && (action < m_cells * m_cells) && isLegal(board, from, to)) {
+            Random rng;
+            rng.setState(m_rngStates[env]);
+
+            Board::Move move(Board::index(from / m_dimension, from % m_dimension),
+                             Board::index(to / m_dimension, to % m_dimension));
+            reward = float(board.play(move, rng));
+
+            m_rngStates[env] = rng.state();
+        } else {
+            flags |= Illegal;
+        }
+
+        if (!observe(board, observation)) {
+            flags |= Done;
+
+            if (m_autoReset) {
+                resetEnv(env, board);
+                observe(board, observation);
+            }
+        }
+
+        fromBoard(env, board);
+
+        batch.m_rewards[env] = reward;
+        batch.m_flags[env] = flags;
+    }
+}
+
+/*!
+  * The games draw their seeds in turn: the next game of the game i uses the seed of its last
+  * game plus envs().
+  */
+void VecEnv::resetEnv(int env, Board &board)
+{
+    Random rng(m_seeds[env]);
+    m_seeds[env] += uint64_t(m_envs);
+
+    board = Board(m_dimension);
+    board.spawn(rng, true);
+
+    m_rngStates[env] = rng.state();
+}
+
+//!
+void VecEnv::fromBoard(int env, const Board &board)
+{
+    Board::Cell *cells = &m_boardCells[size_t(env) * m_cells];
+    for (int r = 0; r < m_dimension; ++r) {
+        for (int c = 0; c < m_dimension; ++c) {
+            cells[r * m_dimension + c] = board.cell(r, c);
+        }
+    }
+
+    m_hintCounts[env] = (unsigned char)board.hintCount();
+    for (int i = 0; i < board.hintCount(); ++i) {
+        int p = board.hintCell(i);
+        m_hintCells[size_t(env) * Board::HintCount + i] = (unsigned char)(Board::row(p) * m_dimension + Board::column(p));
+        m_hintColors[size_t(env) * Board::HintCount + i] = board.hintColor(i);
+    }
+
+    m_scores[env] = board.score();
+}
+
+/*!
+  * An empty cell is reachable if its region touches a ball; a ball is movable if it touches
+  * an empty cell. The regions are grown as bit rows from the empty cells next to the balls.
+  */
+bool VecEnv::observe(const Board &board, unsigned char *observation) const
+{
+    memset(observation, 0, size_t(observationSize()));
+
+    for (int r = 0; r < m_dimension; ++r) {
+        const Board::Cell *row = board.cells() + Board::index(r, 0);
+        for (int c = 0; c < m_dimension; ++c) {
+            if (row[c] != Board::Empty) {
+                observation[(row[c] - 1) * m_cells + r * m_dimension + c] = 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < board.hintCount(); ++i) {
+        int p = board.hintCell(i);
+        int cell = Board::row(p) * m_dimension + Board::column(p);
+        observation[(Board::Colors + board.hintColor(i) - 1) * m_cells + cell] = 1;
+    }
+
+    BitRows rows(board);
+
+    uint16_t reachable[Board::MaxDimension];
+    uint16_t movable[Board::MaxDimension];
+    uint16_t any = 0;
+
+    for (int r = 0; r < m_dimension; ++r) {
+        reachable[r] = uint16_t(rows.m_empty[r] & BitRows::neighbours(rows.m_balls, r, m_dimension));
+        movable[r] = uint16_t(rows.m_balls[r] & BitRows::neighbours(rows.m_empty, r, m_dimension));
+        any |= movable[r];
+    }
+
+    rows.flood(reachable);
+
+    writePlane(reachable, m_dimension, observation + ReachablePlane * m_cells);
+    writePlane(movable, m_dimension, observation + MovablePlane * m_cells);
+
+    return 0 != any;
+}
+
+//!
+bool VecEnv::isLegal(const Board &board, int from, int to) const
+{
+    int r = from / m_dimension;
+    int c = from % m_dimension;
+
+    if ((board.cell(r, c) == Board::Empty) || (board.cell(to / m_dimension, to % m_dimension) != Board::Empty)) {
+        return false;
+    }
+
+    BitRows rows(board);
+
+    // the regions touching the ball
+    uint16_t set[Board::MaxDimension];
+    memset(set, 0, sizeof(set));
+    set[r] = uint16_t(1u << c);
+
+    uint16_t seed[Board::MaxDimension];
+    for (int i = 0; i < m_dimension; ++i) {
+        seed[i] = uint16_t(rows.m_empty[i] & BitRows::neighbours(set, i, m_dimension));
+    }
+
+    rows.flood(seed);
+
+    return 0 != (seed[to / m_dimension] & (1u << (to % m_dimension)));
+}
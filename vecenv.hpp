@@ -0,0 +1,200 @@
+/*!
+  * @file vecenv.hpp
+  * This file contains the declaration of the class VecEnv.
+  */
+#ifndef VECENV_HPP
+#define VECENV_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "board.hpp"
+
+/*! This class steps a batch of independent games at once, for the training of agents.
+  *
+  * The state of the N games is held in a structure of arrays (the cells of all the boards, the
+  * 'hint' balls, the scores, the generators...) rather than in N Board objects; a step gathers the
+  * state of a game into a Board on the stack, plays the turn with the rules of Board and scatters
+  * it back. The steps are split among persistent worker threads, so that a step allocates no memory.
+  *
+  * An action is a move given as from * cells() + to, where a cell is numbered row * dim() + column.
+  * The observation of a game is written into the caller's buffer as observationSize() bytes: Planes
+  * planes of cells() bytes (0 or 1), row by row:
+  * - the planes 0 to Colors - 1: the balls of every color,
+  * - the planes Colors to 2 * Colors - 1: the 'hint' balls of every color,
+  * - the plane ReachablePlane: the empty cells some ball can be moved onto,
+  * - the plane MovablePlane: the balls that can be moved.
+  *
+  * An illegal action leaves the game unchanged (the flag Illegal is raised). A game is over when
+  * there is no legal move left; with the automatic reset the game then starts again at once and
+  * the observation is the one of the new game (the flag Done tells the end of the previous one).
+  */
+class VecEnv
+{
+public:
+    enum
+    {
+        ReachablePlane = 2 * Board::Colors,     // the plane of the targets of the moves
+        MovablePlane = 2 * Board::Colors + 1,   // the plane of the balls that can be moved
+        Planes = 2 * Board::Colors + 2          // the number of the planes of an observation
+    };
+
+    /*! \brief The flags of a step.
+      */
+    enum Flags
+    {
+        Done = 1,   // the game is over
+        Illegal = 2 // the action was illegal and ignored
+    };
+
+    /*! The constructor.
+      *
+      * @param[in] envs the number of the games
+      * @param[in] dimension the dimension of the boards
+      * @param[in] seed the seed of the first game (the game i uses the seed + i)
+      */
+    VecEnv(int envs, int dimension = 9, uint64_t seed = 1);
+
+    /*! The destructor; stops the worker threads.
+      */
+    ~VecEnv();
+
+    /*!
+      * @return the number of the games
+      */
+    inline int envs() const
+    {
+        return m_envs;
+    }
+
+    /*!
+      * @return the dimension of the boards
+      */
+    inline int dim() const
+    {
+        return m_dimension;
+    }
+
+    /*!
+      * @return the number of the cells of a board
+      */
+    inline int cells() const
+    {
+        return m_cells;
+    }
+
+    /*!
+      * @return the number of the bytes of the observation of a game
+      */
+    inline int observationSize() const
+    {
+        return Planes * m_cells;
+    }
+
+    /*! Sets the number of the threads stepping the games (0 means one thread per core).
+      */
+    void setThreads(int threads);
+
+    /*! Enables or disables the automatic reset of the games that are over (enabled by default).
+      */
+    inline void setAutoReset(bool enabled)
+    {
+        m_autoReset = enabled;
+    }
+
+    /*! Starts all the games again.
+      * @param[out] observations receives envs() * observationSize() bytes
+      */
+    void reset(unsigned char *observations);
+
+    /*! Plays one turn of every game.
+      *
+      * @param[in] actions the moves of the games (envs() values)
+      * @param[out] observations receives envs() * observationSize() bytes
+      * @param[out] rewards receives the points scored by the turns (envs() values)
+      * @param[out] flags receives the Flags of the steps (envs() values)
+      */
+    void step(const int *actions, unsigned char *observations, float *rewards, unsigned char *flags);
+
+    /*!
+      * @return the score of a game
+      */
+    inline int score(int env) const
+    {
+        return m_scores[env];
+    }
+
+    /*! Copies the state of a game into a board.
+      */
+    void toBoard(int env, Board &board) const;
+
+private:
+    /*! \brief The arguments of the batch being stepped.
+      */
+    struct Batch
+    {
+        const int *m_actions; /*!< the actions or null for a reset */
+        unsigned char *m_observations;
+        float *m_rewards;
+        unsigned char *m_flags;
+    };
+
+    /*! Starts the threads (if they are not running) and steps the batch on all of them.
+      */
+    void run(const Batch &batch);
+
+    /*! The loop of a worker thread.
+      */
+    void work(int thread);
+
+    /*! Steps the games of a slice of the batch.
+      */
+    void stepRange(int first, int last, const Batch &batch);
+
+    /*! Starts a game again.
+      */
+    void resetEnv(int env, Board &board);
+
+    /*! Copies a board back into the state of a game.
+      */
+    void fromBoard(int env, const Board &board);
+
+    /*! Writes the observation of a game.
+      * @return false if there is no legal move
+      */
+    bool observe(const Board &board, unsigned char *observation) const;
+
+    /*! Checks whether a move (given by the cells numbered row by row) is legal.
+      */
+    bool isLegal(const Board &board, int from, int to) const;
+
+    void stopWorkers();
+
+private:
+    int m_envs; /*!< the number of the games */
+    int m_dimension; /*!< the dimension of the boards */
+    int m_cells; /*!< the number of the cells of a board */
+    bool m_autoReset; /*!< are the games over started again ? */
+
+    // the state of the games, one array per field
+    std::vector<Board::Cell> m_boardCells; /*!< the cells of the games, row by row (envs * cells) */
+    std::vector<unsigned char> m_hintCells; /*!< the cells of the 'hint' balls, row by row (envs * HintCount) */
+    std::vector<Board::Cell> m_hintColors; /*!< the colors of the 'hint' balls (envs * HintCount) */
+    std::vector<unsigned char> m_hintCounts; /*!< the numbers of the 'hint' balls */
+    std::vector<int> m_scores; /*!< the scores */
+    std::vector<uint64_t> m_rngStates; /*!< the states of the generators */
+    std::vector<uint64_t> m_seeds; /*!< the seeds of the next games */
+
+    int m_threads; /*!< the number of the threads (the calling one included) */
+    std::vector<std::thread> m_workers; /*!< the worker threads */
+    std::mutex m_mutex;
+    std::condition_variable m_wake; /*!< wakes the workers up for a new batch */
+    std::condition_variable m_finished; /*!< tells the caller that the workers are done */
+    Batch m_batch; /*!< the current batch */
+    unsigned long long m_generation; /*!< the number of the batches started */
+    int m_pending; /*!< the number of the workers still stepping the batch */
+    bool m_quit; /*!< are the workers stopped ? */
+};
+
+#endif // VECENV_HPP